@@ -12,6 +12,9 @@ struct Configuration
     // The name of the keypad, used to distinguish it from others.
     char name[128] = "minipad";
 
+    // The rate at which the keys are scanned, in scans per second.
+    uint16_t scanRate = SCAN_RATE;
+
     // A list of all hall effect key configurations. (rapid trigger, hysteresis, calibration, ...)
     HEKeyConfig heKeys[HE_KEYS];
 
@@ -22,7 +25,7 @@ struct Configuration
     static uint32_t getVersion()
     {
         // Version of the configuration in the format YYMMDDhhmm (e.g. 2301030040 for 12:44am on the 3rd january 2023)
-        int64_t version = 2308161815;
+        int64_t version = 2610171600;
 
         return version;
     }
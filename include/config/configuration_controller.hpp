@@ -2,6 +2,7 @@
 #pragma GCC diagnostic ignored "-Wtype-limits"
 
 #include "config/configuration.hpp"
+#include "config/configuration_journal.hpp"
 #include "definitions.hpp"
 
 inline class ConfigurationController
@@ -11,16 +12,31 @@ public:
     {
         defaultConfig = getDefaultConfig();
         config = defaultConfig;
+        persistedConfig = defaultConfig;
     }
 
     void loadConfig();
     void saveConfig();
+    void update(bool idle);
+    void storeCalibration(uint8_t index, uint16_t restPosition, uint16_t downPosition);
+    bool validateConfig(const Configuration &config) const;
 
     Configuration config;
 
 private:
     Configuration defaultConfig;
 
+    // The configuration last requested to be saved. Calibration updates are saved into this copy, so they
+    // can be persisted without also persisting changes to the configuration that have not been saved yet.
+    Configuration persistedConfig;
+
+    // The journal the configuration is persisted in.
+    ConfigurationJournal journal;
+
+    // Bool whether a save has been requested but not committed to the flash yet, and the time of the last request in milliseconds.
+    bool savePending = false;
+    unsigned long saveRequestedAt = 0;
+
     // Default configuration loaded into the EEPROM if no configuration was saved yet. Also used to reset the keypad and calibration
     // structs that might get modified on a firmware update and have to be reset back to their default values then later on.
     Configuration getDefaultConfig()
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "config/configuration.hpp"
+
+// A log-structured journal storing the configuration in the flash region reserved for the filesystem. Every write appends the
+// whole configuration as a new record with a sequence number and checksum, instead of rewriting the same flash sector every time.
+// A sector is only erased once the journal wraps around into it, spreading the wear across all sectors of the region. Since the
+// newest valid record is never erased or overwritten, a power loss while writing can never lose the previously saved configuration.
+class ConfigurationJournal
+{
+public:
+    bool load(Configuration &config);
+    bool append(const Configuration &config);
+
+private:
+    // The header in front of every record in the journal.
+    struct RecordHeader
+    {
+        // The magic number identifying a record, always recordMagic.
+        uint32_t magic;
+
+        // The sequence number of the record, incremented with every record. The record with the highest one is the newest.
+        uint32_t sequence;
+
+        // The length of the configuration following the header.
+        uint16_t length;
+
+        // The CRC-16/CCITT-FALSE checksum over the sequence number, the length and the configuration.
+        uint16_t checksum;
+    };
+
+    const RecordHeader *getRecord(uint32_t slot) const;
+    uint32_t getSlotCount() const;
+    bool isValid(const RecordHeader *record) const;
+    bool isErased(uint32_t slot) const;
+
+    // The magic number identifying a record. ("MPCJ")
+    static constexpr uint32_t recordMagic = 0x4A43504D;
+
+    // The sizes of the flash pages and sectors of the RP2040, being the smallest units that can be programmed and erased respectively.
+    static constexpr size_t pageSize = 256;
+    static constexpr size_t sectorSize = 4096;
+
+    // The size of a slot containing a single record, rounded up to whole pages. Records never span across sectors.
+    static constexpr size_t slotSize = (sizeof(RecordHeader) + sizeof(Configuration) + pageSize - 1) / pageSize * pageSize;
+    static constexpr uint32_t slotsPerSector = sectorSize / slotSize;
+    static_assert(slotsPerSector > 0, "The configuration has to fit into a single flash sector.");
+
+    // The slot the next record is written to and its sequence number.
+    uint32_t nextSlot = 0;
+    uint32_t nextSequence = 0;
+};
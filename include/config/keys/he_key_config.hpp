@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include "config/keys/key_config.hpp"
+#include "helpers/key_filter.hpp"
+#include "helpers/analog_curve.hpp"
 #include "definitions.hpp"
 
 // Configuration for the Hall Effect keys of the keypad, containing the actuation points, calibration, sensitivities etc. of the key.
@@ -19,6 +21,10 @@ struct HEKeyConfig : KeyConfig
     // Bool whether continuous rapid trigger is enabled or not.
     bool continuousRapidTrigger = false;
 
+    // Bool whether predictive actuation is enabled or not, pressing or releasing the key in rapid trigger mode one scan early
+    // if it is moving fast enough to be committed to travelling the sensitivity.
+    bool predictiveActuation = false;
+
     // The sensitivity of the rapid trigger algorithm when pressing up.
     uint16_t rapidTriggerUpSensitivity = TRAVEL_DISTANCE_IN_0_01MM / 10;
 
@@ -30,4 +36,15 @@ struct HEKeyConfig : KeyConfig
 
     // The value below which the key is no longer pressed and rapid trigger is no longer active in rapid trigger mode.
     uint16_t upperHysteresis = (uint16_t)(TRAVEL_DISTANCE_IN_0_01MM * 0.675);
+
+    // The type of filter used for stabilizing the analog values of the key.
+    FilterType filter = FilterType::SMA;
+
+    // The type of curve used for mapping the distance of the key to its axis value on the analog HID interface.
+    AnalogCurveType analogCurve = AnalogCurveType::Linear;
+
+    // The rest and down position learned by the calibration, restored at bootup so the key is usable right away.
+    // Both values are 0 if the key has not been calibrated yet.
+    uint16_t restPosition = 0;
+    uint16_t downPosition = 0;
 };
@@ -26,6 +26,15 @@
 // This value is important to reset the rapid trigger state properly with continuous rapid trigger.
 #define CONTINUOUS_RAPID_TRIGGER_THRESHOLD 10
 
+// The minimum velocity of a key for predictive actuation, in 0.01mm per scan (e.g. 2 equals 160mm/s at 8000 scans per second). With
+// predictive actuation, rapid trigger presses or releases the key one scan early if it moves at least this fast towards the threshold
+// without slowing down. The key also has to have travelled at least half of the sensitivity, so the noise of the sensors cannot trigger it.
+#define PREDICTIVE_ACTUATION_MIN_VELOCITY 2
+
+// The exponent for the smoothing factor of the velocity and acceleration tracking of the keys, where the smoothing factor is 1 / 2^exponent.
+// A higher value suppresses more noise, but reacts slower to changes of the movement and therefore predicts fewer actuations.
+#define PREDICTIVE_ACTUATION_SMOOTHING_EXPONENT 2
+
 // This number will be added to the down position and substracted from the rest position on bounary update
 // to introduce a deadzone at the boundaries. This might be desired since values might fluctuate.
 // e.g. if the value fluctuates around 1970 in rest position but peaks at 1975, this would counteract it.
@@ -55,13 +64,116 @@
 // The resolution for the ADCs on the RP2040. The theoretical maximum value on it is 16 bit (uint16_t).
 #define ANALOG_RESOLUTION 12
 
+// Flag for enabling DMA-driven sampling of the Hall Effect sensors. If enabled, the ADC samples the inputs of all keys
+// in a free-running round-robin while DMA writes the samples into a double-buffered ring, meaning reading the sensors never
+// has to wait for a conversion. Comment this line out to read the sensors one after another using analogRead instead.
+// This is disabled automatically if analog multiplexers are used.
+#define USE_DMA_ADC_SAMPLING
+
+// The total amount of samples per second taken by the ADC in DMA sampling mode, shared across all Hall Effect keys.
+// The ADC of the RP2040 is capable of up to 500000 samples per second.
+#define DMA_ADC_SAMPLE_RATE 192000
+
+// The amount of frames (one sample for every Hall Effect key) in each of the two buffers in DMA sampling mode. A lower value
+// results in fresher frames being available to the key pipeline but causes more interrupts for swapping the buffers.
+#define DMA_ADC_FRAMES_PER_BUFFER 4
+
+// Flag for enabling the sampling of the Hall Effect sensors through external analog multiplexers (e.g. 74HC4067), allowing more Hall Effect
+// keys than there are ADC pins. Every multiplexer is connected to one ADC pin, starting at A0, and shares the select lines with the others.
+// The first 2^ANALOG_MULTIPLEXER_SELECT_BITS keys are on the first multiplexer, the next ones on the second, and so on. Uncomment this line
+// to enable it. This mode does not support DMA sampling, which is disabled then. As the sensors are read on every scan instead of being sampled
+// in the background, taking the settle time plus one conversion (2us) per multiplexer for every channel (e.g. 176us for 64 keys), the maximum
+// scan rate is lower in this mode. The HE_PIN macro does not apply in this mode.
+// #define USE_ANALOG_MULTIPLEXER
+
+// The amount of select lines of the analog multiplexers, with every multiplexer having 2^bits channels. (e.g. 4 for the 74HC4067)
+#define ANALOG_MULTIPLEXER_SELECT_BITS 4
+
+// The first pin of the select lines of the analog multiplexers. The select lines are connected to consecutive pins,
+// starting with the least significant bit on this pin. These pins may not overlap with the pins of the digital keys.
+#define ANALOG_MULTIPLEXER_SELECT_PIN_BASE 6
+
+// The time in microseconds the analog multiplexers need to settle after switching the channel before the sensors can be read.
+#define ANALOG_MULTIPLEXER_SETTLE_TIME 2
+
+// The delay in milliseconds between a save of the configuration being requested and it being committed to the flash. The commit is
+// further held back until no key is pressed, as the keys are not scanned while the flash is being written.
+#define CONFIG_COMMIT_DELAY 1000
+
+// The minimum amount the rest or down position of a key has to move by since its calibration was last saved for it to be saved again.
+// The calibration is restored at bootup, making the keys usable without being pressed down first. A lower value saves the calibration
+// more accurately, but causes more writes to the flash.
+#define CALIBRATION_SAVE_THRESHOLD 20
+
+// The maximum difference between the first sensor reading at bootup and the saved rest position of a key for its saved calibration to be restored.
+// If the difference is bigger, e.g. because the key is held down or the hardware changed, the key is calibrated from scratch.
+#define CALIBRATION_RESTORE_TOLERANCE 50
+
 // The buffer size of any serial input. Defined here for consistent use across the serial handler and avoiding of magic numbers.
-#define SERIAL_INPUT_BUFFER_SIZE 1024
+// Scaled with the amount of Hall Effect keys, as the whole configuration has to fit into a single binary frame.
+#define SERIAL_INPUT_BUFFER_SIZE (1024 + HE_KEYS * 32)
+
+// The maximum amount of bytes of serial input read per loop iteration. This limits the time spent on reading the serial input,
+// so a flood of data from the host device can never delay the rest of the loop by much.
+#define SERIAL_INPUT_MAX_BYTES_PER_LOOP 64
+
+// The size of the buffer for the serial output. All output is written into this buffer and passed to the serial interface as fast
+// as the host device reads it. If a message does not fit into the buffer anymore, it is dropped. Has to be below 65536.
+// Scaled with the amount of Hall Effect keys, as the output of the get command grows with it and has to fit into the buffer at once.
+#define SERIAL_OUTPUT_BUFFER_SIZE (2048 + HE_KEYS * 512)
+
+// The maximum size of a single formatted message written to the serial output buffer, including the null-terminator.
+#define SERIAL_OUTPUT_MAX_MESSAGE_SIZE 256
+
+// The byte marking the start of a binary frame on the serial interface. Binary frames consist of this byte, the length of
+// the payload (uint16), the payload and a CRC-16/CCITT-FALSE checksum (uint16) over the length and the payload, all little-endian.
+// The byte is outside of the ASCII range, allowing the host device to tell binary frames and text lines apart.
+#define BINARY_FRAME_MAGIC 0xA5
+
+// The time in milliseconds after which a binary frame that is being received is discarded if no further byte arrived.
+// This prevents a truncated binary frame from swallowing the following input on the serial interface.
+#define BINARY_FRAME_TIMEOUT 100
+
+// The capacity of the queue passing telemetry frames from the scanning code to the serial interface. Has to be a power of 2.
+// If the queue is full, telemetry frames are dropped, which the host device can detect by the sequence number of the frames.
+#define TELEMETRY_QUEUE_SIZE 32
+
+// Flag for enabling the recording of traces of the sensor values with the "trace" command, for reproducing reported issues with the keys
+// on the host through the trace replay of the native environment. Uncomment this line to enable it. If disabled, the trace buffer does not
+// take up any RAM and the scans do not check whether a trace is being recorded.
+// #define USE_TRACE
+
+// The size of the RAM buffer for recording traces of the sensor values with the "trace" command, in bytes. A trace takes about one byte
+// per scan plus one byte per key and scan, meaning 64KB hold about 2 seconds of scans of 3 keys at 8000 scans per second.
+#define TRACE_BUFFER_SIZE 65536
+
+// The size of the blocks the trace buffer is split into, each of which can be decoded independently. Once the buffer is full,
+// the oldest block is overwritten. Has to fit into the serial output buffer, as every block is sent as one binary frame.
+#define TRACE_BLOCK_SIZE 1024
 
 // The exponent for the amount of samples for the SMA filter. This filter reduces fluctuation of analog values.
 // A value too high may cause unresponsiveness. 1 = 1 sample, 2 = 4 samples, 3 = 8 samples, 4 = 16 samples, ...
 #define SMA_FILTER_SAMPLE_EXPONENT 4
 
+// The exponent for the smoothing factor of the EMA filter, where the smoothing factor is 1 / 2^exponent.
+// A value too high may cause unresponsiveness. 1 = 1/2, 2 = 1/4, 3 = 1/8, ...
+#define EMA_FILTER_ALPHA_EXPONENT 2
+
+// The minimum cutoff frequency of the One-Euro filter at rest, given as 2π times the cutoff frequency per scan, with 256 equaling 1.
+// (e.g. 16 equals about 80Hz at 8000 scans per second) A lower value smooths the noise at rest more, but causes more delay on slow movements.
+#define ONE_EURO_FILTER_MIN_CUTOFF 16
+
+// The increase of the cutoff frequency of the One-Euro filter per ADC unit per sample of the derivative, in the same unit as the minimum cutoff.
+// A higher value reduces the delay on fast movements, but lets more noise through on slow movements.
+#define ONE_EURO_FILTER_BETA 8
+
+// The exponent for the smoothing factor of the low-pass filter on the derivative in the One-Euro filter, where the smoothing factor is 1 / 2^exponent.
+// This corresponds to the derivative cutoff of the One-Euro filter, with a higher value suppressing more noise in the derivative.
+#define ONE_EURO_FILTER_DERIVATIVE_EXPONENT 2
+
+// The amount of samples for the median filter. Has to be odd. A higher value rejects longer spikes but delays the values more.
+#define MEDIAN_FILTER_SAMPLES 5
+
 // The travel distance of the switches, where 1 unit equals 0.01mm. This is used to map the values properly to
 // guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
 #define TRAVEL_DISTANCE_IN_0_01MM 400
@@ -70,17 +182,67 @@
 // By default, the firmware is made to handle the readings going down and not up.
 // #define INVERT_SENSOR_READINGS
 
-// The delay for the debounce on digital keys. This is necessary because the contacts on digital buttons "bounce",
-// meaning instead of a steady HIGH signal you'll get a couple signal changes (e.g. HIGH LOW HIGH LOW HIGH)
-// This millisecond delay is the minimum time between button presses for the HID signal to send to the host device.
-#define DIGITAL_DEBOUNCE_DELAY 50
+// The time in microseconds before the next USB start-of-frame at which pending HID reports are sent. HID reports are only sent if the key state
+// changed and are held back until right before the host device polls them, so every report contains the freshest key state. A lower value sends
+// fresher key states, but the report misses its frame if sending it is delayed by more than this, in which case it is sent one frame later.
+#define HID_REPORT_SOF_LEAD 100
+
+// Flag for enabling the analog HID interface, reporting the travel distance of the first 6 Hall Effect keys as the axes of a gamepad
+// (X, Y, Z, Z rotation, left and right slider) in addition to the keyboard. The distances are mapped to the axes through the curve
+// configured per key. Uncomment this line to enable it.
+// #define USE_ANALOG_HID
+
+// The minimum change of an axis value (0-1023) for the analog HID interface to send a new report. Smaller changes, like the noise of the
+// sensors, are not reported to not flood the USB bus. Reaching either end of an axis is always reported.
+#define ANALOG_HID_CHANGE_THRESHOLD 4
+
+// The time for the debounce on digital keys in microseconds. This is necessary because the contacts on digital buttons "bounce",
+// meaning instead of a steady HIGH signal you'll get a couple signal changes (e.g. HIGH LOW HIGH LOW HIGH). Presses are sent
+// to the host device right away, while releases are only sent once the signal has not changed for this amount of time.
+#define DIGITAL_DEBOUNCE_TIME 5000
+
+// Flag for enabling dual-core scanning. If enabled, the keys are scanned on the second core at a fixed rate and all key transitions
+// are passed to the first core, which sends the HID reports and handles the serial communication. This way, neither the USB stack
+// nor serial commands can slow down or delay the sampling of the sensors. Comment this line out to handle everything on one core.
+#define USE_DUAL_CORE_SCANNING
+
+// The default rate at which the keys are scanned, in scans per second. The scans are started by a hardware alarm, keeping the time between
+// them fixed, so the filters and sensitivities always cover the same time span. The rate can be changed with the "rate" command.
+#ifndef USE_ANALOG_MULTIPLEXER
+#define SCAN_RATE 8000
+#else
+#define SCAN_RATE 2000
+#endif
+
+// The minimum and maximum rate at which the keys can be scanned, in scans per second. Only rates dividing 1000000 evenly are supported,
+// as the time between two scans is kept in whole microseconds. (e.g. 1000, 2000, 4000, 5000, 8000, 10000, 12500 or 15625)
+// With analog multiplexers, the maximum rate is limited so reading all sensors takes at most half of the time between two scans.
+// It may be raised for devices with fewer keys, as long as the firmware still compiles.
+#define SCAN_RATE_MIN 1000
+#ifndef USE_ANALOG_MULTIPLEXER
+#define SCAN_RATE_MAX 15625
+#else
+#define SCAN_RATE_MAX 2000
+#endif
+
+// Flag for enabling the profiler, measuring the CPU cycles spent in every stage of the key pipeline with the SysTick timer of the cores.
+// The measurements are output and reset with the "perf" command. Uncomment this line to enable it. If disabled, the profiler adds no
+// overhead at all. Since the SysTick timer is used for the measurements, this cannot be combined with code relying on the SysTick timer.
+// #define USE_PROFILER
+
+// The capacity of the queue passing key transitions from the scanning code to the HID interface. Has to be a power of 2.
+// If the queue is full, key transitions are held back and retried on the next scan, meaning no transition is ever lost.
+#define KEY_EVENT_QUEUE_SIZE 64
 
 // Macro for getting the hall effect sensor pin of the specified key index. The pin order is being swapped here,
 // meaning on a 3-key device the pins are 28, 27 and 26. This macro has to be adjusted, depending on how the PCB
 // and hardware of the device using this firmware has been designed. The A0 constant is 26 in the RP2040 environment.
 // NOTE: By the uint8 datatype, the amount of keys is limited to 255.
-// NOTE: By the RP2040, the amount of analog pins (and therefore keys) is limited o 4.
+// NOTE: By the RP2040, the amount of analog pins (and therefore keys) is limited o 4, unless analog multiplexers are used.
+// NOTE: With analog multiplexers, the keys are assigned to the channels of the multiplexers instead, which is why this macro is not defined then.
+#ifndef USE_ANALOG_MULTIPLEXER
 #define HE_PIN(index) A0 + HE_KEYS - index - 1
+#endif
 
 // Macro for getting the pin of the specified index of the digital key. The pin order is swapped here, meaning
 // the first digital key is on DIGITAL_KEYS - 1, the second on DIGITAL_KEYS - 2, and so on.
@@ -89,9 +251,16 @@
 #define DIGITAL_PIN(index) 0 + DIGITAL_KEYS - index - 1
 
 // Add a compiler error if the firmware is being tried to built with more than the supported 4 keys.
-// (only 4 ADC pins available)
-#if HE_KEYS > 4
-#error As of right now, the firmware only supports up to 4 hall effect keys.
+// (only 4 ADC pins available) With analog multiplexers, every ADC pin supports as many keys as a multiplexer has channels.
+#if !defined(USE_ANALOG_MULTIPLEXER) && HE_KEYS > 4
+#error As of right now, the firmware only supports up to 4 hall effect keys without analog multiplexers.
+#elif defined(USE_ANALOG_MULTIPLEXER) && HE_KEYS > 4 << ANALOG_MULTIPLEXER_SELECT_BITS
+#error The firmware only supports up to 4 analog multiplexers.
+#endif
+
+// Disable DMA sampling if analog multiplexers are used, as the free-running ADC cannot switch the multiplexer channels.
+#if defined(USE_DMA_ADC_SAMPLING) && defined(USE_ANALOG_MULTIPLEXER)
+#undef USE_DMA_ADC_SAMPLING
 #endif
 
 // Add a compiler error if the firmware is being tried to built with more than the supported 26 digital keys.
@@ -100,6 +269,16 @@
 #error As of right now, the firmware only supports up to 26 digital keys.
 #endif
 
+// Add a compiler error if DMA sampling is enabled with an analog resolution other than the 12 bit provided by the ADC.
+#if defined(USE_DMA_ADC_SAMPLING) && ANALOG_RESOLUTION != 12
+#error DMA sampling only supports an analog resolution of 12 bit.
+#endif
+
+// Add a compiler error if the default scan rate is not one of the supported scan rates.
+#if SCAN_RATE < SCAN_RATE_MIN || SCAN_RATE > SCAN_RATE_MAX || 1000000 % SCAN_RATE != 0
+#error The scan rate has to be within the boundaries and divide 1000000 evenly.
+#endif
+
 // If the debug flag is not set via compiler parameters, default it to 0 since it's required for if statements.
 #ifndef DEV
 #define DEV 0
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include "helpers/analog_curve.hpp"
+#include "definitions.hpp"
+
+inline class AnalogHandler
+{
+public:
+    void begin();
+    void report(const uint16_t *distances, bool keyboardPending);
+
+    // The amount of analog reports sent.
+    uint32_t reportsSent = 0;
+
+private:
+    void setAxis(uint8_t axis, uint16_t value);
+
+    // The amount of axes of the HID gamepad, limiting the amount of Hall Effect keys reported as axes.
+    static constexpr uint8_t axes = HE_KEYS < 6 ? HE_KEYS : 6;
+
+    // The curves of the Hall Effect keys reported as axes.
+    AnalogCurve curves[axes];
+
+    // The axis values last sent to the host device.
+    uint16_t sentValues[axes] = {0};
+
+    // The time the last analog report was sent at, in microseconds since firmware bootup.
+    uint32_t lastSentAt = 0;
+} AnalogHandler;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+
+// Handler for binary frames received via the serial interface, allowing host devices to read and write the configuration
+// without formatting and parsing text. Every request is answered with a frame of the request type with bit 7 set,
+// followed by a status byte and the response data. Writes are validated as a whole and only applied if fully valid.
+inline class BinaryHandler
+{
+public:
+    void handleFrame(const uint8_t *payload, uint16_t length);
+
+    // The types of the request payloads.
+    static constexpr uint8_t schemaType = 0x10;
+    static constexpr uint8_t readConfigType = 0x11;
+    static constexpr uint8_t writeConfigType = 0x12;
+    static constexpr uint8_t readFieldsType = 0x13;
+    static constexpr uint8_t writeFieldsType = 0x14;
+    static constexpr uint8_t saveType = 0x15;
+
+    // The status codes sent in the responses.
+    enum Status : uint8_t
+    {
+        // The request has been handled successfully.
+        Ok = 0,
+
+        // The type of the request is unknown.
+        UnknownType = 1,
+
+        // The request is too short or too long for its type.
+        Malformed = 2,
+
+        // A field is outside of the configuration or the response would not fit into a frame.
+        OutOfRange = 3,
+
+        // The resulting configuration is invalid and has not been applied.
+        Invalid = 4
+    };
+
+private:
+    void schema(const uint8_t *data, uint16_t length);
+    void readConfig(const uint8_t *data, uint16_t length);
+    void writeConfig(const uint8_t *data, uint16_t length);
+    void readFields(const uint8_t *data, uint16_t length);
+    void writeFields(const uint8_t *data, uint16_t length);
+    void save(const uint8_t *data, uint16_t length);
+
+    void beginResponse(uint8_t type, Status status);
+    void sendResponse();
+
+    // The buffer the response is built in, containing the type, status and response data.
+    uint8_t response[SERIAL_INPUT_BUFFER_SIZE];
+    static_assert(sizeof(Configuration) + 2 <= SERIAL_INPUT_BUFFER_SIZE, "The configuration has to fit into a single binary frame.");
+
+    // The amount of bytes in the response.
+    uint16_t responseLength = 0;
+} BinaryHandler;
@@ -1,11 +1,20 @@
 #pragma once
 #pragma GCC diagnostic ignored "-Wtype-limits"
 
+#include <atomic>
 #include "config/configuration_controller.hpp"
 #include "handlers/keys/he_key.hpp"
+#include "handlers/keys/he_key_states.hpp"
 #include "handlers/keys/digital_key.hpp"
+#include "handlers/keys/key_event.hpp"
 #include "helpers/sma_filter.hpp"
 #include "helpers/gauss_lut.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/spsc_queue.hpp"
+#include "helpers/report_scheduler.hpp"
+#include "helpers/keyboard_report.hpp"
+#include "helpers/latency_tracker.hpp"
 #include "definitions.hpp"
 
 inline class KeyHandler
@@ -22,20 +31,79 @@ public:
             digitalKeys[i] = DigitalKey(i, &ConfigController.config.digitalKeys[i]);
     }
 
+    void begin();
     void handle();
+    void scan();
+    void report();
+    bool isIdle() const;
+    void storeCalibration();
+    void requestConfigSync();
     bool outputMode;
     HEKey heKeys[HE_KEYS];
+    HEKeyStates heKeyStates;
     DigitalKey digitalKeys[DIGITAL_KEYS];
 
+    // The scheduler deciding when the HID reports are sent.
+    ReportScheduler reportScheduler;
+
+    // The tracker measuring the latency from sampling the keys to sending the HID reports.
+    LatencyTracker latencyTracker;
+
+    // The amount of key transitions performed early by predictive actuation.
+    uint32_t predictedTransitions = 0;
+
 private:
-    void updateSensorBoundaries(HEKey &key);
-    void checkHEKey(HEKey &key);
-    void checkDigitalKey(DigitalKey &key);
-    void scanHEKey(HEKey &key);
-    void scanDigitalKey(DigitalKey &key);
+    void syncConfig();
+    bool syncUsage(Key &key);
+    void scanHEKeys();
+    void filterHEKeys();
+    void mapHEKeys();
+    void trackHEKeys();
+    int32_t predictDistance(uint8_t index) const;
+    void restoreCalibration(HEKey &key, uint16_t value);
+    void updateSensorBoundaries(HEKey &key, uint16_t rawValue);
+    void updateDistanceScaling(HEKey &key);
+    void checkTraditional(HEKey &key);
+    void checkRapidTrigger(HEKey &key);
+    void checkDigitalKey(DigitalKey &key, uint32_t now);
+    void scanDigitalKey(DigitalKey &key, uint32_t levels, uint32_t now);
     void setPressedState(Key &key, bool pressed);
 
+    // The function type of the actuation checks of the Hall Effect keys. The checks are selected per key whenever the configuration
+    // is copied into the key states, depending on the actuation mode, instead of checking the mode of each key on every scan.
+    using HEKeyCheck = void (KeyHandler::*)(HEKey &key);
+    HEKeyCheck heKeyChecks[HE_KEYS];
+
+    // Bool whether the configuration has changed and has to be copied into the key states before the next scan.
+    // Set by the code changing the configuration, which might run on the other core, and cleared by the scanning code.
+    std::atomic<bool> configChanged{true};
+
+    // The time the values causing the key transitions currently being checked were sampled at, in microseconds since firmware bootup.
+    // For the Hall Effect keys, that is the time the sampler completed the frame, and for a digital key the time of the last edge on its pin.
+    uint32_t sampledAt = 0;
+
+    // The queue of key transitions, filled by the scanning code and drained into HID reports.
+    SPSCQueue<KeyEvent, KEY_EVENT_QUEUE_SIZE> keyEvents;
+
+    // The state of all pressed HID usages, built from the key transitions and sent via the HID interface.
+    KeyboardReport keyboardReport;
+
+    // The local ID of the NKRO report registered with the USB stack.
+    uint8_t nkroDevice = 0;
+
+    // Bool whether the host device had selected the boot protocol instead of the report protocol when the report was last checked.
+    bool bootProtocol = false;
+
 #ifdef USE_GAUSS_CORRECTION_LUT
-    GaussLUT gaussLUT = GaussLUT(GAUSS_CORRECTION_PARAM_A, GAUSS_CORRECTION_PARAM_B, GAUSS_CORRECTION_PARAM_C, GAUSS_CORRECTION_PARAM_D);
+    // The lookup table for the gauss correction, generated at compile time and stored in the flash.
+    static constexpr GaussLUT gaussLUT = GaussLUT();
+
+    // The amount of fractional bits of the fixed-point distance scales. The scaled distances are exact as long as the squared travel
+    // distance stays below 2^shift, while the travel distance shifted by it still has to fit into 32 bits.
+    static constexpr uint8_t distanceScaleShift = 18;
+    static_assert(TRAVEL_DISTANCE_IN_0_01MM * TRAVEL_DISTANCE_IN_0_01MM < 1 << distanceScaleShift, "The travel distance is too big for the distance scale precision.");
 #endif
+
+    // The amount of fractional bits of the fixed-point velocities and accelerations.
+    static constexpr uint8_t motionShift = 8;
 } KeyHandler;
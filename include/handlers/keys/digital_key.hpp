@@ -10,16 +10,16 @@
 struct DigitalKey : Key
 {
     // Default constructor for the DigitalKey struct for initializing the arrays in the KeyHandler class.
-    DigitalKey() : Key(0, nullptr) {}
+    DigitalKey() : Key(0, nullptr, 0) {}
 
     // Require every DigitalKey object to pass a KeyConfig object to the underlaying Key object.
-    DigitalKey(uint8_t index, DigitalKeyConfig *config) : Key(index, config), config(config) {}
+    DigitalKey(uint8_t index, DigitalKeyConfig *config) : Key(index, config, HE_KEYS + index), config(config) {}
 
     // The HEKeyConfig object of this digital key.
     DigitalKeyConfig *config;
 
-    // The last time a key press on the digital key was sent, in milliseconds since firmware bootup.
-    unsigned long lastDebounce = 0;
+    // The time of the last edge on the pin of the digital key, in microseconds since firmware bootup.
+    uint32_t lastEdge = 0;
 
     // Bool whether the key is currently considered pressed, ignoring any debouncing and only considering the current digital signal.
     bool pressed;
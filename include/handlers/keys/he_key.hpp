@@ -3,42 +3,46 @@
 #include <Arduino.h>
 #include "config/keys/he_key_config.hpp"
 #include "handlers/keys/key.hpp"
-#include "helpers/sma_filter.hpp"
+#include "helpers/key_filter.hpp"
 #include "definitions.hpp"
 
-// A struct representing a Hall Effect key, including it's current runtime state and HEKeyConfig object.
+// A struct representing a Hall Effect key, including it's calibration, filter and HEKeyConfig object.
+// The state of the key accessed on every scan is stored in the HEKeyStates of the key handler instead.
 struct HEKey : Key
 {
     // Default constructor for the HEKey struct for initializing the arrays in the KeyHandler class.
-    HEKey() : Key(0, nullptr) {}
+    HEKey() : Key(0, nullptr, 0) {}
 
     // Require every HEKey object to pass a KeyConfig object to the underlaying Key object.
-    HEKey(uint8_t index, HEKeyConfig *config) : Key(index, config), config(config) {}
+    HEKey(uint8_t index, HEKeyConfig *config) : Key(index, config, index), config(config) {}
 
     // The HEKeyConfig object of this Hall Effect key.
     HEKeyConfig *config;
 
-    // State whether the hall effect key is currently inside the rapid trigger zone (below the lower hysteresis).
-    bool inRapidTriggerZone = false;
-
-    // The current peak value for the rapid trigger logic.
-    uint16_t rapidTriggerPeak = UINT16_MAX;
-
-    // The raw value with low-pass filter applied read from the Hall Effect sensor.
-    uint16_t rawValue = 0;
-
-    // The distance of the magnet from the sensor, calculated through the raw value.
-    uint16_t distance = 0;
-
     // The highest and lowest values ever read on the sensor. Used for calibration purposes,
     // specifically mapping future values read from the sensors from this range to 0.01mm steps.
     // By default, set the range from (1<<analog_resolution)-1 to 0 so it can be updated.
     uint16_t restPosition = 0;
     uint16_t downPosition = (1 << ANALOG_RESOLUTION) - 1;
 
+#ifdef USE_GAUSS_CORRECTION_LUT
+    // The offset of the sensor readings to the indices of the gauss correction LUT, determined by the rest position.
+    int16_t lutOffset = 0;
+
+    // The distance of the down position according to the gauss correction LUT.
+    uint16_t downDistance = 0;
+
+    // The fixed-point reciprocal of the down position's distance, multiplied by the travel distance. Used to stretch
+    // the distances read from the LUT to the full travel distance without having to perform a division on every scan.
+    uint32_t distanceScale = 0;
+#endif
+
     // A bool whether the key is "calibrated", meaning the down position boundary has been updated from it's 4095 default value.
     bool calibrated = false;
 
-    // The simple moving average filter for stabilizing the analog outpt.
-    SMAFilter filter = SMAFilter(SMA_FILTER_SAMPLE_EXPONENT);
+    // A bool whether restoring the saved calibration has been attempted, which is done on the first scan with sensor values available.
+    bool calibrationRestoreAttempted = false;
+
+    // The filter for stabilizing the analog output, with the type of filter being selected by the configuration.
+    KeyFilter filter;
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The state of all Hall Effect keys accessed on every scan, with every field being stored as a contiguous array indexed by the key index.
+// This way, the scanning code processes all keys field by field in batched passes instead of following pointers key by key. The settings
+// of the keys are copied from the configuration whenever it changes, instead of being read through the pointers to the key configurations.
+struct HEKeyStates
+{
+    // The unfiltered values read from the Hall Effect sensors.
+    uint16_t adcValues[HE_KEYS] = {0};
+
+    // The raw values with low-pass filter applied read from the Hall Effect sensors.
+    uint16_t rawValues[HE_KEYS] = {0};
+
+    // The distances of the magnets from the sensors, calculated through the raw values.
+    uint16_t distances[HE_KEYS] = {0};
+
+    // The current peak values for the rapid trigger logic.
+    uint16_t rapidTriggerPeaks[HE_KEYS];
+
+    // States whether the keys are currently inside the rapid trigger zone (below the lower hysteresis).
+    bool inRapidTriggerZone[HE_KEYS] = {false};
+
+    // The distances of the previous scan, used for tracking the movement of the keys.
+    uint16_t previousDistances[HE_KEYS];
+
+    // The smoothed velocities and accelerations of the keys in 0.01mm per scan (and per scan squared) with 8 fractional bits.
+    // Negative velocities mean that the key is moving down.
+    int32_t velocities[HE_KEYS] = {0};
+    int32_t accelerations[HE_KEYS] = {0};
+
+    // The hysteresis and rapid trigger settings of the keys, copied from the configuration.
+    uint16_t lowerHysteresis[HE_KEYS];
+    uint16_t upperHysteresis[HE_KEYS];
+    uint16_t rapidTriggerUpSensitivity[HE_KEYS];
+    uint16_t rapidTriggerDownSensitivity[HE_KEYS];
+
+    // The distances at or above which the keys leave the rapid trigger zone. This is the upper hysteresis, or the
+    // threshold of a fully released key if continuous rapid trigger is enabled, which is resolved when copying the settings.
+    uint16_t rapidTriggerResetDistances[HE_KEYS];
+
+    // States whether predictive actuation is enabled on the keys, copied from the configuration.
+    bool predictiveActuation[HE_KEYS] = {false};
+
+    HEKeyStates()
+    {
+        for (uint16_t &peak : rapidTriggerPeaks)
+            peak = UINT16_MAX;
+
+        // Start with the keys being fully released, which is the distance of uncalibrated keys.
+        for (uint16_t &distance : previousDistances)
+            distance = TRAVEL_DISTANCE_IN_0_01MM;
+    }
+};
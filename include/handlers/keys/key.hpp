@@ -6,15 +6,23 @@
 // The base struct containing info about the state of a key for the key handler.
 struct Key
 {
-    // Require every Key object to get an index and a KeyConfig object passed from its inheritors.
-    Key(uint8_t index, KeyConfig *config) : index(index), config(config) {}
+    // Require every Key object to get an index, a KeyConfig object and an ID passed from its inheritors.
+    Key(uint8_t index, KeyConfig *config, uint8_t id) : index(index), id(id), config(config) {}
 
     // The index of the key. This is used to link this Key object to the corresponding KeyConfig object.
     uint8_t index;
 
+    // The ID of the key, unique across all keys. The Hall Effect keys come first, followed by the digital keys.
+    uint8_t id;
+
     // The KeyConfig object of this key.
     KeyConfig *config;
 
     // State whether the key is currently pressed down.
     bool pressed = false;
+
+    // The HID usage of the key and the bits of the modifiers required by it, resolved from the key char in the KeyConfig object
+    // whenever the configuration changes.
+    uint8_t usage = 0;
+    uint8_t modifiers = 0;
 };
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// A struct representing a transition of the pressed state of a key, passed from the scanning code to the HID interface.
+struct KeyEvent
+{
+    // The HID usage of the key that changed its pressed state, resolved from its key char.
+    uint8_t usage;
+
+    // The bits of the modifiers held while the key is pressed, as required by the character of the key.
+    uint8_t modifiers;
+
+    // Bool whether the key has been pressed down or released.
+    bool pressed;
+
+    // The ID of the key that changed its pressed state.
+    uint8_t key;
+
+    // The time the values causing the transition were sampled at, in microseconds since firmware bootup.
+    uint32_t timestamp;
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <string_view>
 #include "config/configuration_controller.hpp"
+#include "helpers/string_helper.hpp"
+#include "helpers/log_histogram.hpp"
 
 inline class SerialHandler
 {
@@ -8,18 +11,62 @@ public:
     void handleSerialInput(char *input);
 
 private:
-    void boot();
-    void save();
-    void get();
-    void name(char *name);
-    void out();
-    void echo(char *input);
-    void hkey_rt(HEKeyConfig &config, bool state);
-    void hkey_crt(HEKeyConfig &config, bool state);
-    void hkey_rtus(HEKeyConfig &config, uint16_t value);
-    void hkey_rtds(HEKeyConfig &config, uint16_t value);
-    void hkey_lh(HEKeyConfig &config, uint16_t value);
-    void hkey_uh(HEKeyConfig &config, uint16_t value);
-    void key_char(KeyConfig &config, uint8_t keyChar);
-    void key_hid(KeyConfig &config, bool state);
+    // An entry in a command table, mapping the name of a command or setting to the function handling it. The hash of the name
+    // is calculated at compile time, allowing the entry to be looked up by comparing hashes instead of whole strings.
+    template <typename Handler>
+    struct Command
+    {
+        constexpr Command(std::string_view name, Handler handler) : name(name), hash(StringHelper::hash(name)), handler(handler) {}
+
+        // The name of the command or setting.
+        std::string_view name;
+
+        // The hash of the name.
+        uint32_t hash;
+
+        // The function handling the command or setting. The handlers validate the specified values themselves.
+        Handler handler;
+    };
+
+    // The function types for handling global commands, Hall Effect key settings and settings shared by all keys.
+    using GlobalCommandHandler = void (SerialHandler::*)(std::string_view parameters);
+    using HEKeySettingHandler = void (SerialHandler::*)(HEKeyConfig &config, std::string_view value);
+    using KeySettingHandler = void (SerialHandler::*)(KeyConfig &config, std::string_view value);
+
+    // The tables of all global commands, Hall Effect key settings and settings shared by all keys.
+    static const Command<GlobalCommandHandler> globalCommands[];
+    static const Command<HEKeySettingHandler> heKeySettings[];
+    static const Command<KeySettingHandler> keySettings[];
+
+    template <typename Handler, size_t size>
+    static const Command<Handler> *findCommand(const Command<Handler> (&commands)[size], std::string_view name);
+
+    void boot(std::string_view parameters);
+    void save(std::string_view parameters);
+    void get(std::string_view parameters);
+    void name(std::string_view name);
+    void rate(std::string_view rate);
+    void out(std::string_view parameters);
+    void stats(std::string_view parameters);
+    void latency(std::string_view parameters);
+    void stream(std::string_view decimation);
+#ifdef USE_TRACE
+    void trace(std::string_view action);
+#endif
+    void echo(std::string_view input);
+#ifdef USE_PROFILER
+    void perf(std::string_view parameters);
+    void printHistogram(const char *stage, uint8_t key, const LogHistogram &histogram);
+#endif
+    void hkey_rt(HEKeyConfig &config, std::string_view state);
+    void hkey_crt(HEKeyConfig &config, std::string_view state);
+    void hkey_pred(HEKeyConfig &config, std::string_view state);
+    void hkey_rtus(HEKeyConfig &config, std::string_view str);
+    void hkey_rtds(HEKeyConfig &config, std::string_view str);
+    void hkey_lh(HEKeyConfig &config, std::string_view str);
+    void hkey_uh(HEKeyConfig &config, std::string_view str);
+    void hkey_filter(HEKeyConfig &config, std::string_view str);
+    void hkey_curve(HEKeyConfig &config, std::string_view str);
+    void key_char(KeyConfig &config, std::string_view keyChar);
+    void key_hid(KeyConfig &config, std::string_view state);
 } SerialHandler;
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "handlers/keys/he_key.hpp"
+#include "handlers/keys/he_key_states.hpp"
+#include "helpers/spsc_queue.hpp"
+#include "definitions.hpp"
+
+// The values of a single Hall Effect key in a telemetry frame.
+struct __attribute__((packed)) TelemetryKeyValues
+{
+    // The unfiltered value read from the sensor.
+    uint16_t adcValue;
+
+    // The value with the filter applied.
+    uint16_t rawValue;
+
+    // The distance of the key in 0.01mm.
+    uint16_t distance;
+
+    // The current peak value for the rapid trigger logic.
+    uint16_t rapidTriggerPeak;
+
+    // Bit 0 is set if the key is pressed, bit 1 if the key is inside the rapid trigger zone.
+    uint8_t flags;
+};
+
+// The payload of a binary frame sent to the host device while streaming telemetry, containing the values of all Hall Effect keys.
+struct __attribute__((packed)) TelemetryFrame
+{
+    // The type of the payload, always TelemetryHandler::frameType.
+    uint8_t type;
+
+    // The sequence number of the frame, incremented on every captured frame. Gaps indicate dropped frames.
+    uint32_t sequence;
+
+    // The time the values were captured at, in microseconds since firmware bootup.
+    uint32_t timestamp;
+
+    // The amount of Hall Effect keys in the frame.
+    uint8_t keyCount;
+
+    // The values of all Hall Effect keys.
+    TelemetryKeyValues keys[HE_KEYS];
+};
+
+inline class TelemetryHandler
+{
+public:
+    void start(uint16_t decimation);
+    void stop();
+    void capture(const HEKeyStates &states, const HEKey *keys);
+    void flush();
+
+    // The type of the telemetry frame payloads.
+    static constexpr uint8_t frameType = 0x01;
+
+    // The amount of frames sent to and dropped before reaching the serial output.
+    uint32_t framesSent = 0;
+    uint32_t framesDropped = 0;
+
+private:
+    // The queue of captured frames, filled by the scanning code and drained into the serial output.
+    SPSCQueue<TelemetryFrame, TELEMETRY_QUEUE_SIZE> frames;
+
+    // Only every n-th scan is captured, with 0 meaning telemetry streaming is stopped.
+    std::atomic<uint16_t> decimation{0};
+
+    // The amount of scans since the last captured frame.
+    uint16_t scans = 0;
+
+    // The sequence number of the next captured frame.
+    uint32_t sequence = 0;
+} TelemetryHandler;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "definitions.hpp"
+
+#ifdef USE_TRACE
+// The recorder of the unfiltered sensor values of all Hall Effect keys on every scan, for reproducing the behavior of the keys later.
+// The values are recorded into a ring of fixed-size blocks in the RAM, overwriting the oldest block once all are filled, so the trace
+// always covers the most recent scans. Every block starts with a keyframe containing the absolute time and values, followed by frames
+// containing only the differences to the previous frame. Since the values barely change between two scans, most differences take one byte.
+// The blocks can be decoded independently, and are sent to the host device as binary frames once the trace is dumped.
+inline class TraceHandler
+{
+public:
+    void start();
+    void stop();
+    void dump();
+    void capture(uint32_t timestamp, const uint16_t *values);
+    void flush();
+
+    // The type of the trace block payloads.
+    static constexpr uint8_t frameType = 0x02;
+
+private:
+    void startBlock(uint32_t timestamp, const uint16_t *values);
+    static uint8_t writeVarInt(uint8_t *data, uint32_t value);
+
+    // The states of the recording. A stop is requested by the serial handler and acknowledged by the scanning code
+    // on its next capture, so the blocks are never read while the scanning code is still writing into them.
+    enum State : uint8_t
+    {
+        Stopped,
+        Recording,
+        StopRequested
+    };
+    std::atomic<uint8_t> state{Stopped};
+
+    // The size of the blocks and the amount of blocks in the ring.
+    static constexpr uint16_t blockSize = TRACE_BLOCK_SIZE;
+    static constexpr uint16_t blockCount = TRACE_BUFFER_SIZE / TRACE_BLOCK_SIZE;
+
+    // The maximum size of a frame, with every difference taking up to 5 bytes for the time and 2 bytes for each value.
+    static constexpr uint16_t maxFrameSize = 5 + HE_KEYS * 2;
+    static_assert(4 + HE_KEYS * 2 <= blockSize, "The trace blocks are too small for a keyframe.");
+    static_assert(blockSize + 11 <= SERIAL_OUTPUT_BUFFER_SIZE, "The trace blocks have to fit into the serial output buffer.");
+
+    // The blocks of the ring and the amount of bytes used in each of them.
+    uint8_t blocks[blockCount][blockSize];
+    uint16_t blockLengths[blockCount] = {0};
+
+    // The block currently being recorded into, and the amount of blocks containing recorded values.
+    uint16_t currentBlock = 0;
+    uint16_t filledBlocks = 0;
+
+    // The time and values of the last recorded frame, which the next frame is encoded relative to.
+    uint32_t lastTimestamp = 0;
+    uint16_t lastValues[HE_KEYS] = {0};
+
+    // Bool whether the recorded blocks are being sent, and the amount of blocks sent so far.
+    bool dumping = false;
+    uint16_t dumpedBlocks = 0;
+} TraceHandler;
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The sample source for the Hall Effect keys, reading the sensor values of all keys at once into a frame.
+// By default, the sensors are read one after another using analogRead. If USE_DMA_ADC_SAMPLING is defined, the ADC is
+// put into free-running round-robin mode and the samples are written into a double-buffered ring via DMA instead,
+// allowing the key pipeline to read the newest completed frame without waiting for any conversions. Until the first buffer has
+// been filled after the sampling started, no frame is available and read returns false. If USE_ANALOG_MULTIPLEXER
+// is defined, the sensors are read through external analog multiplexers, switching the channel of all multiplexers at once.
+// The DMA sampling relies on the completion interrupt to move each channel back to the start of its buffer before it is started
+// again, so it has to be paused while interrupts are held back for longer than a buffer takes to fill, e.g. while writing the flash.
+inline class ADCSampler
+{
+public:
+    void begin();
+    bool read(uint16_t *values, uint32_t &sampledAt);
+    void pause();
+    void resume();
+
+#ifdef USE_DMA_ADC_SAMPLING
+    void onDMAComplete();
+
+private:
+    // The amount of samples in one buffer of the ring, consisting of multiple frames with one sample for each key.
+    static constexpr uint16_t bufferSize = DMA_ADC_FRAMES_PER_BUFFER * HE_KEYS;
+
+    // The two buffers of the ring, each being filled by one of the DMA channels.
+    uint16_t buffers[2][bufferSize];
+
+    // The index of the buffer that has been filled completely most recently.
+    volatile uint8_t latestBuffer = 0;
+
+    // Bool whether a buffer has been filled completely since the sampling started. Before that, the buffers contain no samples yet.
+    volatile bool frameAvailable = false;
+
+    // The time each buffer has last been filled completely at, in microseconds since firmware bootup, which is when its newest frame was sampled.
+    volatile uint32_t completedAt[2] = {};
+
+    // The two DMA channels, each filling one buffer and starting the other channel once finished.
+    uint8_t dmaChannels[2];
+
+    // Bool whether the sampling has been started, as there is nothing to pause before. The configuration may be saved before that.
+    volatile bool started = false;
+#endif
+
+#ifdef USE_ANALOG_MULTIPLEXER
+private:
+    void selectChannel(uint8_t channel);
+
+    // The amount of channels per multiplexer and the amount of channels in use, as keys are assigned to the first channels of each multiplexer.
+    static constexpr uint8_t channels = 1 << ANALOG_MULTIPLEXER_SELECT_BITS;
+    static constexpr uint8_t activeChannels = HE_KEYS < channels ? HE_KEYS : channels;
+
+    // The amount of multiplexers, each connected to one ADC input.
+    static constexpr uint8_t multiplexers = (HE_KEYS + channels - 1) / channels;
+
+    // The time of a single conversion of the ADC in microseconds, which is 96 cycles of the 48MHz ADC clock.
+    static constexpr uint8_t conversionTime = 2;
+
+    // The longest time reading the sensors of all keys can take in microseconds, with the settle time being waited for in whole microseconds.
+    static constexpr uint32_t readTime = activeChannels * (ANALOG_MULTIPLEXER_SETTLE_TIME + 1 + multiplexers * conversionTime);
+    static_assert(readTime <= 1000000 / SCAN_RATE_MAX / 2, "Reading the analog multiplexers takes more than half of the time between two scans at the maximum scan rate.");
+
+    // The bit mask of the pins of the select lines.
+    static constexpr uint32_t selectMask = ((1 << ANALOG_MULTIPLEXER_SELECT_BITS) - 1) << ANALOG_MULTIPLEXER_SELECT_PIN_BASE;
+
+    // The time the channel was last switched at, in microseconds since firmware bootup.
+    uint32_t channelSelectedAt = 0;
+#endif
+} ADCSampler;
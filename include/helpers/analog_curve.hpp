@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The types of curves available for mapping the travel distance of the Hall Effect keys to the value of their analog axis.
+enum class AnalogCurveType : uint8_t
+{
+    // The axis value is proportional to the travel distance.
+    Linear = 0,
+
+    // The axis value rises slowly at the start of the travel and fast near the bottom, allowing for more precision on light presses.
+    Progressive = 1,
+
+    // The axis value rises fast at the start of the travel and slowly near the bottom, reaching high values with light presses.
+    Aggressive = 2,
+
+    // The amount of curve types, used for validating values.
+    Count = 3
+};
+
+// The curve of a Hall Effect key, mapping its distance to a 10-bit axis value. The curve is stored as a table of evenly spaced points,
+// computed whenever the type of curve is changed, with the values in between being linearly interpolated. This way, mapping a distance
+// only costs a lookup and a few multiplications, independent of the type of curve.
+class AnalogCurve
+{
+public:
+    AnalogCurve()
+    {
+        setType(AnalogCurveType::Linear);
+    }
+
+    // The call operator for mapping the distance of a key (0 = fully pressed) to the axis value (0 = fully released).
+    uint16_t operator()(uint16_t distance) const;
+
+    // Returns the currently selected type of curve.
+    AnalogCurveType getType() const
+    {
+        return type;
+    }
+
+    void setType(AnalogCurveType type);
+
+    // The maximum axis value.
+    static constexpr uint16_t maxValue = 1023;
+
+private:
+    // The amount of segments of the curve, with one more point than segments.
+    static constexpr uint8_t segments = 16;
+
+    // The fixed-point factor converting the travel of a key into the segment with 8 fractional bits, replacing the division by the travel
+    // distance. It is rounded up, which matches the division for a travel distance of 4.00mm and is off by at most 1/256 of a segment otherwise.
+    static constexpr uint8_t positionScaleShift = 16;
+    static constexpr uint32_t positionScale = (((uint32_t)segments * 256 << positionScaleShift) + TRAVEL_DISTANCE_IN_0_01MM - 1) / TRAVEL_DISTANCE_IN_0_01MM;
+    static_assert((uint64_t)TRAVEL_DISTANCE_IN_0_01MM * positionScale <= UINT32_MAX, "The travel distance is too big for the analog curve precision.");
+
+    // The currently selected type of curve.
+    AnalogCurveType type;
+
+    // The axis values at the evenly spaced points of the travel distance.
+    uint16_t points[segments + 1];
+};
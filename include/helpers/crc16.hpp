@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace CRC16
+{
+    uint16_t compute(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+};
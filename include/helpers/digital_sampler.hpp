@@ -0,0 +1,42 @@
+#pragma once
+#pragma GCC diagnostic ignored "-Wtype-limits"
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The sample source for the digital keys, reading the levels of all digital keys at once from the GPIO input register and
+// timestamping every edge on their pins with a GPIO interrupt. The timestamps are precise to the microsecond, independent
+// of when the keys are scanned, and include the edges of bounces happening in between two scans.
+inline class DigitalSampler
+{
+public:
+    void begin();
+    uint32_t read() const;
+    void onEdge();
+
+    // Returns the time of the last edge on the pin of the specified digital key, in microseconds since firmware bootup.
+    uint32_t getLastEdge(uint8_t index) const
+    {
+        return lastEdges[index];
+    }
+
+    // Returns the bit mask of the pin of the specified digital key in the value returned by read().
+    static constexpr uint32_t getPinMask(uint8_t index)
+    {
+        return 1u << (DIGITAL_PIN(index));
+    }
+
+private:
+    // The bit mask of the pins of all digital keys.
+    static constexpr uint32_t pinsMask()
+    {
+        uint32_t mask = 0;
+        for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+            mask |= getPinMask(i);
+
+        return mask;
+    }
+
+    // The time of the last edge on the pin of every digital key, written by the interrupt.
+    volatile uint32_t lastEdges[DIGITAL_KEYS] = {};
+} DigitalSampler;
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// An exponential moving average filter with a smoothing factor of 1 / 2^EMA_FILTER_ALPHA_EXPONENT.
+// Compared to the SMA filter, it reacts to changes immediately with only a single value of state.
+class EMAFilter
+{
+public:
+    // The call operator for passing values through the filter.
+    uint16_t operator()(uint16_t value);
+
+    // Sets the average to the specified value.
+    void reset(uint16_t value);
+
+private:
+    // The current average in fixed-point with 8 fractional bits to not lose precision on small changes.
+    int32_t average = 0;
+};
@@ -3,18 +3,101 @@
 #include <cstdint>
 #include "definitions.hpp"
 
+// The lookup table for the gauss correction, translating ADC readings into the distance of the magnet from the sensor.
+// The table is generated at compile time from the GAUSS_CORRECTION_PARAM_A..D parameters and only covers the useful ADC
+// range from 0 to a - d, since every reading above that equals a distance of 0. Instances of this class are meant to be
+// constexpr, placing the table in the flash instead of calculating it at runtime and storing it in the RAM.
 class GaussLUT
 {
 public:
-    // Variables for the equation to calculate the ADC reading into a physical distance.
+    // Variables for the equation to calculate the ADC reading into a physical distance are taken from the definitions.
     // a = y-stretch, b = x-stretch, c = x-offset, d = y-offset, for more info: https://www.desmos.com/calculator/ps4wd127tu
-    GaussLUT(double a, double b, double c, double d);
+    constexpr GaussLUT()
+        : lut()
+        , lutRestPosition(a * (1 - exp(-b * c)) - d)
+    {
+        // Fill the range from a to d in the LUT based on the parameters and the equation. (See: https://www.desmos.com/calculator/ps4wd127tu)
+        // This calculates the "ideal" distance based on the relevant ADC range, being from a to d, since everything above a - d will equal to 0, anyways.
+        for (uint16_t i = 0; i < size; i++)
+        {
+            const double distance = (log(1 - ((i + d) / a)) / -b) - c;
+            lut[i] = distance < 0 ? 0 : distance > TRAVEL_DISTANCE_IN_0_01MM ? TRAVEL_DISTANCE_IN_0_01MM : distance;
+        }
+    }
 
-    uint16_t adcToDistance(const uint16_t adc, uint16_t const restPosition);
+    uint16_t adcToDistance(const uint16_t adc, const uint16_t restPosition) const;
+    uint16_t lookup(const int32_t index) const;
+
+    // Returns the offset between the "ideal" rest position of the LUT and the specified one of the sensor,
+    // which is added to the ADC readings of the sensor to get the index in the lookup table.
+    constexpr int16_t getOffset(const uint16_t restPosition) const
+    {
+        return lutRestPosition - restPosition;
+    }
 
 private:
+    // The parameters of the equation, taken from the definitions.
+    static constexpr double a = GAUSS_CORRECTION_PARAM_A;
+    static constexpr double b = GAUSS_CORRECTION_PARAM_B;
+    static constexpr double c = GAUSS_CORRECTION_PARAM_C;
+    static constexpr double d = GAUSS_CORRECTION_PARAM_D;
+
+    // The amount of entries in the lookup table, being all whole numbers below a - d.
+    static constexpr uint16_t size = (uint16_t)(a - d) + ((uint16_t)(a - d) < a - d ? 1 : 0);
+
+    // Calculates the natural logarithm of the specified positive number at compile time. The number is reduced to the range of
+    // [sqrt(0.5), sqrt(2)] by powers of 2, after which ln(x) = 2 * atanh((x - 1) / (x + 1)) is calculated using its power series.
+    static constexpr double log(double x)
+    {
+        int16_t exponent = 0;
+        while (x > 1.4142135623730951)
+        {
+            x /= 2;
+            exponent++;
+        }
+        while (x < 0.7071067811865476)
+        {
+            x *= 2;
+            exponent--;
+        }
+
+        const double z = (x - 1) / (x + 1);
+        double term = z;
+        double sum = 0;
+        for (uint8_t i = 1; i < 64; i += 2)
+        {
+            sum += term / i;
+            term *= z * z;
+        }
+
+        return exponent * 0.6931471805599453 + 2 * sum;
+    }
+
+    // Calculates the exponential function of the specified number at compile time. The number is split into n * ln(2) + r
+    // with |r| <= ln(2) / 2, after which e^x = 2^n * e^r is calculated using the power series of e^r.
+    static constexpr double exp(double x)
+    {
+        const int16_t exponent = (int16_t)(x / 0.6931471805599453 + (x < 0 ? -0.5 : 0.5));
+        const double r = x - exponent * 0.6931471805599453;
+
+        double term = 1;
+        double sum = 1;
+        for (uint8_t i = 1; i < 32; i++)
+        {
+            term *= r / i;
+            sum += term;
+        }
+
+        for (int16_t i = 0; i < exponent; i++)
+            sum *= 2;
+        for (int16_t i = 0; i > exponent; i--)
+            sum /= 2;
+
+        return sum;
+    }
+
     // The calculated lookup table used by this GaussLUT instance.
-    uint16_t lut[1 << ANALOG_RESOLUTION];
+    uint16_t lut[size];
 
     // The rest position of the keys according to the lookup table.
     uint16_t lutRestPosition;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace HIDUsage
+{
+    // A HID usage along with the bits of the modifiers that have to be held while it is pressed, in the order of the modifier byte.
+    struct KeyCode
+    {
+        uint8_t usage;
+        uint8_t modifiers;
+    };
+
+    // The bit of the left shift modifier in the modifier byte.
+    constexpr uint8_t leftShift = 1 << 1;
+
+    KeyCode fromKeyChar(uint8_t keyChar);
+};
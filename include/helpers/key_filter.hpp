@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include "helpers/sma_filter.hpp"
+#include "helpers/ema_filter.hpp"
+#include "helpers/one_euro_filter.hpp"
+#include "helpers/median_filter.hpp"
+
+// The types of filters available for stabilizing the analog values of the Hall Effect keys.
+enum class FilterType : uint8_t
+{
+    // A simple moving average filter, averaging a fixed amount of samples.
+    SMA = 0,
+
+    // An exponential moving average filter, reacting to changes immediately.
+    EMA = 1,
+
+    // An adaptive filter, smoothing heavily at rest and barely at all on fast movements.
+    OneEuro = 2,
+
+    // A median filter, rejecting single spikes.
+    Median = 3,
+
+    // The amount of filter types, used for validating values.
+    Count = 4
+};
+
+// The filter of a Hall Effect key, passing the values through the filter of the selected type.
+class KeyFilter
+{
+public:
+    // The call operator for passing values through the filter.
+    uint16_t operator()(uint16_t value);
+
+    // Returns the currently selected type of filter.
+    FilterType getType() const
+    {
+        return type;
+    }
+
+    void setType(FilterType type);
+    void reset(uint16_t value);
+
+    // Bool whether enough values have been passed through the filter for the output to be stable.
+    bool initialized = false;
+
+private:
+    void resetSelected(uint16_t value);
+
+    // The currently selected type of filter.
+    FilterType type = FilterType::SMA;
+
+    // The amount of values passed through the filter, counted up until the filter is initialized.
+    uint8_t samples = 0;
+
+    // The last value returned by the filter, used to seamlessly switch between the filters.
+    uint16_t lastValue = 0;
+
+    // The instances of all filters. The storage of all filters is fixed-size, meaning no heap allocations are made.
+    SMAFilter sma;
+    EMAFilter ema;
+    OneEuroFilter oneEuro;
+    MedianFilter median;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+// The state of the keyboard as a bitmap of all pressed HID usages, tracking any amount of pressed keys at once.
+// The modifier usages (0xE0 to 0xE7) are part of the bitmap, with their byte in the bitmap matching the modifier byte of HID reports.
+// Keys typing characters that require a modifier (e.g. shift for 'A') hold that modifier while being pressed, which is counted per
+// modifier so it stays held until all of these keys are released, independently from the keys bound to the modifier itself.
+// While the host device uses the report protocol, the state is sent as an NKRO report containing the whole bitmap, so any amount of
+// keys can be pressed at once. Before that, e.g. in the BIOS, the state is converted into a boot protocol report holding up to 6 keys.
+class KeyboardReport
+{
+public:
+    bool press(uint8_t usage, uint8_t modifiers = 0);
+    bool release(uint8_t usage, uint8_t modifiers = 0);
+    uint8_t getModifiers() const;
+    void toBootReport(uint8_t &modifiers, uint8_t (&keys)[6]) const;
+
+    // The index of the byte in the bitmap containing the modifier usages, which is also the amount of bytes of the bitmap up to them.
+    static constexpr uint8_t modifierByte = 0xE0 / 8;
+
+    // The size of the NKRO report, consisting of the modifier byte followed by the bitmap of the usages 0x00 to 0xDF.
+    static constexpr uint8_t nkroReportSize = 1 + modifierByte;
+
+    void toNKROReport(uint8_t (&report)[nkroReportSize]) const;
+
+    // The HID report descriptor of the NKRO report. The report ID is assigned by the USB stack when the descriptor is registered.
+    static constexpr uint8_t nkroDescriptor[] = {
+        0x05, 0x01, // Usage Page (Generic Desktop)
+        0x09, 0x06, // Usage (Keyboard)
+        0xA1, 0x01, // Collection (Application)
+        0x85, 0x01, //   Report ID (1)
+        0x05, 0x07, //   Usage Page (Keyboard/Keypad)
+        0x15, 0x00, //   Logical Minimum (0)
+        0x25, 0x01, //   Logical Maximum (1)
+        0x75, 0x01, //   Report Size (1)
+        0x19, 0xE0, //   Usage Minimum (Left Control)
+        0x29, 0xE7, //   Usage Maximum (Right GUI)
+        0x95, 0x08, //   Report Count (8)
+        0x81, 0x02, //   Input (Data, Variable, Absolute)
+        0x19, 0x00, //   Usage Minimum (0x00)
+        0x29, 0xDF, //   Usage Maximum (0xDF)
+        0x95, 0xE0, //   Report Count (224)
+        0x81, 0x02, //   Input (Data, Variable, Absolute)
+        0xC0        // End Collection
+    };
+
+private:
+    // The bitmap of all 256 HID usages, with a bit being set if the usage is pressed.
+    uint8_t usages[32] = {0};
+
+    // The amount of pressed keys requiring each modifier to be held, in the order of the bits in the modifier byte.
+    uint8_t modifierHolds[8] = {0};
+};
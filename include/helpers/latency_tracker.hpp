@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include "helpers/log_histogram.hpp"
+#include "definitions.hpp"
+
+// The tracker measuring the end-to-end latency of the key transitions, from the time the values causing the transition were sampled at
+// to the time the HID report carrying it was passed to the USB stack. The transitions changing the report are remembered until the report
+// is sent, at which point their latencies in microseconds are added to the histogram of their keys. The Hall Effect keys come first, followed
+// by the digital keys. The bookkeeping only costs a few instructions per transition, so it is always enabled.
+class LatencyTracker
+{
+public:
+    void onChange(uint8_t key, uint32_t timestamp);
+    void onSent(uint32_t now);
+    void reset();
+
+    // The latency histograms of all keys.
+    LogHistogram histograms[HE_KEYS + DIGITAL_KEYS];
+
+    // The amount of transitions not measured as too many were waiting for a report to be sent.
+    uint32_t dropped = 0;
+
+private:
+    // A transition waiting for the report carrying it to be sent.
+    struct PendingTransition
+    {
+        // The key of the transition.
+        uint8_t key;
+
+        // The time the values causing the transition were sampled at, in microseconds since firmware bootup.
+        uint32_t timestamp;
+    };
+
+    // The transitions waiting for the report carrying them to be sent.
+    PendingTransition pending[KEY_EVENT_QUEUE_SIZE];
+    uint8_t pendingCount = 0;
+};
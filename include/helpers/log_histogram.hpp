@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// A histogram with logarithmic buckets, where bucket 0 counts the value 0 and bucket n counts the values from 2^(n-1) to 2^n - 1.
+// Values beyond the last bucket are counted in it. Along with the buckets, the amount, minimum, maximum and sum of all values are kept.
+// The storage is fixed-size, so the histogram can be used in the hot path without any heap allocations.
+class LogHistogram
+{
+public:
+    void add(uint32_t value);
+    void reset();
+    uint32_t getMean() const;
+    uint32_t getPercentile(uint8_t percent) const;
+
+    // The amount of buckets.
+    static constexpr uint8_t bucketCount = 16;
+
+    // The amount of values counted in each bucket.
+    uint32_t buckets[bucketCount] = {0};
+
+    // The amount, minimum, maximum and sum of all added values.
+    uint32_t count = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    uint64_t sum = 0;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// A median filter over the last MEDIAN_FILTER_SAMPLES values. Unlike averaging filters, single spikes are rejected
+// completely instead of being spread over multiple values, while steps in the signal are passed without being smeared.
+class MedianFilter
+{
+public:
+    // The call operator for passing values through the filter.
+    uint16_t operator()(uint16_t value);
+
+    // Fills the whole buffer with the specified value.
+    void reset(uint16_t value);
+
+private:
+    // The amount of samples.
+    static constexpr uint8_t samples = MEDIAN_FILTER_SAMPLES;
+    static_assert(samples % 2 == 1, "The amount of samples of the median filter has to be odd.");
+
+    // The buffer containing all values.
+    uint16_t buffer[samples] = {0};
+
+    // The index of the oldest and thus next element to overwrite.
+    uint8_t index = 0;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The One-Euro filter, an adaptive low-pass filter implemented in fixed-point. The cutoff frequency is increased with the speed of the
+// signal, estimated by the low-pass filtered derivative of the input, meaning the noise at rest is smoothed heavily while fast movements
+// pass with barely any delay. The time between two values is the scan period, so the cutoffs are given per scan instead of in Hz.
+// For more info on the One-Euro filter: https://gery.casiez.net/1euro/
+class OneEuroFilter
+{
+public:
+    // The call operator for passing values through the filter.
+    uint16_t operator()(uint16_t input);
+
+    // Sets the filtered value to the specified value and the derivative to 0.
+    void reset(uint16_t input);
+
+private:
+    // The current filtered value in fixed-point with 8 fractional bits.
+    int32_t value = 0;
+
+    // The previous input, from which the derivative of the signal is calculated.
+    uint16_t previousInput = 0;
+
+    // The low-pass filtered derivative of the signal in fixed-point with 8 fractional bits, in ADC units per sample.
+    int32_t derivative = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include "helpers/log_histogram.hpp"
+#include "definitions.hpp"
+
+// The stages of the key pipeline measured by the profiler. The stages processing the Hall Effect keys one by one come first.
+enum class ProfilerStage : uint8_t
+{
+    // Filtering the sensor values and updating the calibration.
+    Filter = 0,
+
+    // Mapping the filtered values to the distances.
+    Map = 1,
+
+    // Running the actuation checks of the Hall Effect keys.
+    Check = 2,
+
+    // Reading the sensor values of all Hall Effect keys.
+    Sample = 3,
+
+    // Tracking the velocity and acceleration of the keys.
+    Track = 4,
+
+    // Reading and debouncing the digital keys.
+    Digital = 5,
+
+    // Building and sending the HID report.
+    Report = 6,
+
+    // The amount of stages.
+    Count = 7
+};
+
+// The profiler measuring the time spent in the stages of the key pipeline in CPU cycles, using the SysTick timer of the core the code runs
+// on. For every stage, and for every Hall Effect key in the stages processing the keys one by one, the cycles are recorded into a histogram.
+// The histograms are only ever read and reset by the core recording them, with the measurements being moved into a snapshot for the output.
+// If USE_PROFILER is not defined, the profiler does not exist and the profiler scopes are empty, compiling to nothing.
+#ifdef USE_PROFILER
+inline class Profiler
+{
+public:
+    void begin();
+    void record(ProfilerStage stage, uint32_t cycles);
+    void record(ProfilerStage stage, uint8_t key, uint32_t cycles);
+    void snapshot();
+    void update();
+
+    // Returns the current value of the SysTick timer of this core, counting down once per CPU cycle.
+    static uint32_t now();
+
+    // Returns the amount of cycles passed since the specified value of the SysTick timer.
+    static uint32_t since(uint32_t start)
+    {
+        return (start - now()) & 0xFFFFFF;
+    }
+
+    // The amount of stages processing the Hall Effect keys one by one, meaning every key is measured separately.
+    static constexpr uint8_t perKeyStages = (uint8_t)ProfilerStage::Check + 1;
+
+    // The snapshot of the histograms of all stages, and of every Hall Effect key in the stages processing the keys one
+    // by one, covering the time between the last two snapshots. Only valid on the core that called snapshot().
+    LogHistogram stageSnapshots[(uint8_t)ProfilerStage::Count];
+    LogHistogram keySnapshots[perKeyStages][HE_KEYS];
+
+private:
+    void moveToSnapshot(bool scanningStages, bool reportStage);
+
+    // The histograms of all stages, and of every Hall Effect key in the stages processing the keys one by one.
+    LogHistogram stages[(uint8_t)ProfilerStage::Count];
+    LogHistogram keys[perKeyStages][HE_KEYS];
+
+    // Bool whether a snapshot of the stages measured on the scanning core has been requested by the other core and not been taken yet.
+    std::atomic<bool> snapshotRequested{false};
+} Profiler;
+#endif
+
+// The scope measuring the time from its construction to its destruction, recording it for the specified stage (and key).
+class ProfilerScope
+{
+public:
+#ifdef USE_PROFILER
+    ProfilerScope(ProfilerStage stage) : stage(stage), key(UINT8_MAX), start(Profiler::now()) {}
+    ProfilerScope(ProfilerStage stage, uint8_t key) : stage(stage), key(key), start(Profiler::now()) {}
+
+    ~ProfilerScope()
+    {
+        const uint32_t cycles = Profiler::since(start);
+        if (key == UINT8_MAX)
+            Profiler.record(stage, cycles);
+        else
+            Profiler.record(stage, key, cycles);
+    }
+
+private:
+    ProfilerStage stage;
+    uint8_t key;
+    uint32_t start;
+#else
+    ProfilerScope(ProfilerStage) {}
+    ProfilerScope(ProfilerStage, uint8_t) {}
+#endif
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The scheduler deciding when HID reports are sent. A report is only sent if the key state changed since the last report, and is held back
+// until right before the next USB start-of-frame (SOF), at which the host device polls the next report. This way, every frame carries
+// the freshest key state, while all changes within a frame are coalesced into a single report instead of flooding the USB stack.
+// The scheduler only contains the decision logic, with the frame number, time and state changes being passed in by the caller.
+class ReportScheduler
+{
+public:
+    void onFrame(uint16_t frame, uint32_t now);
+    void onChange();
+    bool isDue(uint32_t now) const;
+    void onSent();
+
+    // Returns whether the key state changed since the last report, meaning a report is waiting to be sent.
+    bool isPending() const
+    {
+        return pending;
+    }
+
+    // The amount of reports sent, the amount of frames no report was sent in as the key state did not
+    // change, and the amount of key state changes that were merged into a report that was already pending.
+    uint32_t reportsSent = 0;
+    uint32_t reportsSkipped = 0;
+    uint32_t reportsCoalesced = 0;
+
+private:
+    // The duration of a USB frame in microseconds.
+    static constexpr uint32_t framePeriod = 1000;
+
+    // The number of the current USB frame and the time it started at, in microseconds since firmware bootup.
+    uint16_t frame = 0;
+    uint32_t frameStartedAt = 0;
+
+    // Bool whether the key state changed since the last report, and whether that has been the case since a previous frame already.
+    bool pending = false;
+    bool overdue = false;
+};
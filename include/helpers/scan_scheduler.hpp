@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include "definitions.hpp"
+
+// The scheduler deciding when the keys are scanned, keeping a fixed rate between the scans and recording how well it is kept.
+// The due times are advanced by the period from the previous due time, instead of the time the scan started at, so the scans
+// do not drift. If a scan started late by a whole period or more, the missed scans are skipped instead of being run back-to-back.
+// The scheduler only contains the decision logic and statistics, with the current time being passed in by the caller.
+class ScanScheduler
+{
+public:
+    void setRate(uint16_t rate, uint32_t now);
+    void onScanStart(uint32_t now);
+    void onScanEnd(uint32_t now);
+    void resetStats();
+
+    // Returns whether the specified rate is supported, which is the case if it is within the boundaries and the
+    // time between two scans is a whole amount of microseconds, as the scans would run at another rate otherwise.
+    static bool isSupportedRate(uint16_t rate)
+    {
+        return rate >= SCAN_RATE_MIN && rate <= SCAN_RATE_MAX && 1000000 % rate == 0;
+    }
+
+    // Returns whether the next scan is due.
+    bool isDue(uint32_t now) const
+    {
+        return (int32_t)(now - nextDue) >= 0;
+    }
+
+    // Returns the rate in scans per second.
+    uint16_t getRate() const
+    {
+        return rate;
+    }
+
+    // Returns the time the next scan is due at, in microseconds since firmware bootup.
+    uint32_t getNextDue() const
+    {
+        return nextDue;
+    }
+
+    // The amount of scans, and the amount of scans that started a whole period late or later, skipping at least one scan.
+    uint32_t scans = 0;
+    uint32_t overruns = 0;
+
+    // The largest deviation of the time between two scans from the period, and the longest duration of a scan, in microseconds.
+    uint32_t maxJitter = 0;
+    uint32_t maxDuration = 0;
+
+private:
+    // The rate in scans per second and the resulting time between two scans in microseconds.
+    uint16_t rate = 0;
+    uint32_t period = 0;
+
+    // The time the next scan is due at, and the time the last scan started at, in microseconds since firmware bootup.
+    uint32_t nextDue = 0;
+    uint32_t lastStart = 0;
+
+    // Bool whether a scan has been started since the rate has been set, as the first scan has no previous one to measure the period to.
+    bool started = false;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include "helpers/scan_scheduler.hpp"
+
+// The timer starting the scans at the rate set in the configuration. A hardware alarm fires at the due time of every scan, waking the
+// core waiting for it, so the scans start at a fixed rate no matter how long the code in between them takes. The alarm interrupt
+// runs on the core that called begin(), which should be the one scanning the keys.
+inline class ScanTimer
+{
+public:
+    void begin();
+    bool poll();
+    void wait();
+    void finish();
+    void onAlarm();
+
+    // The scheduler deciding the due times of the scans and recording the statistics.
+    ScanScheduler scheduler;
+
+private:
+    void arm();
+
+    // The hardware alarm claimed for the timer.
+    uint8_t alarm;
+
+    // Bool whether the alarm fired since the last scan has been started.
+    volatile bool fired = false;
+} ScanTimer;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "definitions.hpp"
+
+// An incremental reader assembling text lines and binary frames from single bytes, used to read the serial input without ever blocking.
+// Bytes are appended to a fixed-size buffer until a newline character completes the line. Lines exceeding the buffer are discarded
+// as a whole, as handling a truncated command could lead to unintended configuration changes. If a line starts with the binary frame
+// magic byte, the following bytes are read as a binary frame instead, which is only passed on if its length and checksum are valid.
+class SerialReader
+{
+public:
+    // The kinds of input completed by a byte.
+    enum class Input
+    {
+        // No input has been completed.
+        None,
+
+        // A text line has been completed and can be accessed via getLine.
+        Line,
+
+        // A binary frame has been completed and its payload can be accessed via getPayload and getPayloadLength.
+        Frame
+    };
+
+    // Feeds the specified byte into the reader, returning the kind of input completed by it.
+    Input feed(uint8_t byte);
+
+    // Returns the last completed line as a null-terminated string. Only valid until the next byte is fed.
+    char *getLine()
+    {
+        return (char *)buffer;
+    }
+
+    // Returns the payload of the last completed binary frame. Only valid until the next byte is fed.
+    const uint8_t *getPayload() const
+    {
+        return buffer;
+    }
+
+    // Returns the length of the payload of the last completed binary frame.
+    uint16_t getPayloadLength() const
+    {
+        return frameLength;
+    }
+
+private:
+    // The states of the reader.
+    enum class State
+    {
+        Line,
+        FrameLength,
+        FramePayload
+    };
+
+    void reset();
+
+    // The current state of the reader.
+    State state = State::Line;
+
+    // The buffer containing the bytes of the current line or payload of the current binary frame.
+    uint8_t buffer[SERIAL_INPUT_BUFFER_SIZE];
+
+    // The amount of bytes read for the current line or binary frame, excluding the magic byte.
+    size_t length = 0;
+
+    // Bool whether the current line or binary frame exceeded the buffer and is being discarded.
+    bool overflowed = false;
+
+    // The length of the payload of the current binary frame and its checksum.
+    uint16_t frameLength = 0;
+    uint16_t frameChecksum = 0;
+
+    // The time the last byte of the current binary frame was read at, in milliseconds since firmware bootup.
+    unsigned long lastFrameByte = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "definitions.hpp"
+
+// A fixed-size output buffer for the serial interface. All serial output is written into this buffer and only passed to the serial
+// interface as much as it can take without blocking, meaning a host device being slow to read can never stall the firmware.
+// If a message does not fit into the buffer, it is dropped as a whole, so the host device never receives partial messages.
+inline class SerialWriter
+{
+public:
+    bool printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    bool println(const char *str);
+    bool write(const uint8_t *data, size_t length);
+    bool writeFrame(const uint8_t *payload, uint16_t length);
+    void flush();
+
+    // Returns the amount of bytes that can currently be queued into the buffer.
+    size_t getFreeSpace() const
+    {
+        return capacity - size;
+    }
+
+    // The total amount of bytes queued into and dropped from the buffer.
+    uint32_t bytesQueued = 0;
+    uint32_t bytesDropped = 0;
+
+    // The highest amount of bytes that have been in the buffer at once.
+    uint16_t maxDepth = 0;
+
+private:
+    // The capacity of the buffer.
+    static constexpr size_t capacity = SERIAL_OUTPUT_BUFFER_SIZE;
+    static_assert(capacity < 65536, "The serial output buffer size has to be below 65536.");
+
+    // The circular buffer containing all bytes that have not been written to the serial interface yet.
+    uint8_t buffer[capacity];
+
+    // The index of the oldest byte in the buffer and the amount of bytes in it.
+    uint16_t start = 0;
+    uint16_t size = 0;
+} SerialWriter;
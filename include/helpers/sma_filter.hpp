@@ -1,31 +1,25 @@
 #pragma once
 
 #include <cstdint>
+#include "definitions.hpp"
 
+// A simple moving average filter, averaging the last 2^SMA_FILTER_SAMPLE_EXPONENT values.
 class SMAFilter
 {
 public:
-    // Initialize the SMAFilter instance with the specified sample exponent.
-    // (1 = 1 sample, 2 = 4 samples, 3 = 8 samples, ...)
-    SMAFilter(uint8_t samplesExponent)
-        : samplesExponent(samplesExponent)
-        , samples(1 << samplesExponent)
-        , buffer(new uint16_t[samples] {0})
-    {}
-
     // The call operator for passing values through the filter.
     uint16_t operator()(uint16_t value);
 
-    // Bool whether the whole buffer has been written at least once.
-    bool initialized = false;
+    // Fills the whole buffer with the specified value.
+    void reset(uint16_t value);
 
 private:
     // The amount of samples and the exponent.
-    uint8_t samplesExponent;
-    uint8_t samples;
+    static constexpr uint8_t samplesExponent = SMA_FILTER_SAMPLE_EXPONENT;
+    static constexpr uint8_t samples = 1 << samplesExponent;
 
     // The buffer containing all values.
-    uint16_t *buffer;
+    uint16_t buffer[samples] = {0};
 
     // The index of the oldest and thus next element to overwrite.
     uint8_t index = 0;
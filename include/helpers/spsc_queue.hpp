@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// A lock-free single-producer/single-consumer queue with a fixed capacity. This is used to pass data from one core of the
+// RP2040 to the other without any locking, as long as only one core pushes and only the other core pops elements.
+// The capacity has to be a power of 2, allowing the indices to be wrapped around using a bitmask instead of a modulo.
+template <typename T, uint16_t capacity>
+class SPSCQueue
+{
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "The capacity of the SPSCQueue has to be a power of 2.");
+
+public:
+    // Pushes the specified item into the queue. Returns false if the queue is full. Only to be called by the producer.
+    bool push(const T &item)
+    {
+        // Check whether the queue is full by comparing the write index with the read index of the consumer.
+        const uint16_t writeIndex = head.load(std::memory_order_relaxed);
+        if ((uint16_t)(writeIndex - tail.load(std::memory_order_acquire)) >= capacity)
+            return false;
+
+        // Write the item and only publish the new write index afterwards, so the consumer never sees an incomplete item.
+        buffer[writeIndex & (capacity - 1)] = item;
+        head.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops the oldest item from the queue into the specified output. Returns false if the queue is empty. Only to be called by the consumer.
+    bool pop(T &item)
+    {
+        // Check whether the queue is empty by comparing the read index with the write index of the producer.
+        const uint16_t readIndex = tail.load(std::memory_order_relaxed);
+        if (readIndex == head.load(std::memory_order_acquire))
+            return false;
+
+        // Read the item and only publish the new read index afterwards, so the producer does not overwrite it while reading.
+        item = buffer[readIndex & (capacity - 1)];
+        tail.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns the amount of items currently in the queue. The value may already be outdated when being used.
+    uint16_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // The buffer containing all items of the queue.
+    T buffer[capacity];
+
+    // The free-running write and read indices, only ever being written by the producer and consumer respectively.
+    // They are only wrapped to the capacity when accessing the buffer, which allows to tell apart a full and an empty queue.
+    std::atomic<uint16_t> head{0};
+    std::atomic<uint16_t> tail{0};
+};
@@ -1,11 +1,25 @@
 #pragma once
 
 #include <cstdint>
+#include <string_view>
 
 namespace StringHelper
 {
-    void getArgumentAt(const char *input, char delimiter, uint8_t index, char *output);
+    std::string_view nextToken(std::string_view &input, char delimiter);
+    int32_t parseInt(std::string_view str);
+    bool parseBool(std::string_view str);
     void toLower(char *input);
     void replace(char *input, char target, char replacement);
     void makeSafename(char *str);
+
+    // Calculates the 32-bit FNV-1a hash of the specified string. This is constexpr, allowing the hashes
+    // of known strings (e.g. command names) to be calculated at compile time and compared at runtime.
+    constexpr uint32_t hash(std::string_view str)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char c : str)
+            hash = (hash ^ (uint8_t)c) * 16777619u;
+
+        return hash;
+    }
 };
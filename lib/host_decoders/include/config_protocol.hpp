@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// The host-side encoder for the binary configuration requests and decoder for their responses, as documented in the README.
+class ConfigProtocol
+{
+public:
+    // The types of the requests.
+    static constexpr uint8_t schemaType = 0x10;
+    static constexpr uint8_t readConfigType = 0x11;
+    static constexpr uint8_t writeConfigType = 0x12;
+    static constexpr uint8_t readFieldsType = 0x13;
+    static constexpr uint8_t writeFieldsType = 0x14;
+    static constexpr uint8_t saveType = 0x15;
+
+    // A field of the configuration to write, addressed by its byte offset.
+    struct Field
+    {
+        uint16_t offset;
+        std::vector<uint8_t> bytes;
+    };
+
+    // A decoded response, with the type of the request it answers.
+    struct Response
+    {
+        uint8_t type;
+        uint8_t status;
+        std::vector<uint8_t> data;
+    };
+
+    // The decoded data of a schema response.
+    struct Schema
+    {
+        uint32_t version;
+        uint16_t size;
+        uint8_t heKeys;
+        uint8_t digitalKeys;
+    };
+
+    // Returns the complete binary frame, including the magic byte, length and checksum, around the specified payload.
+    static std::vector<uint8_t> encodeFrame(const std::vector<uint8_t> &payload);
+
+    // Returns the payloads of the requests.
+    static std::vector<uint8_t> writeConfig(const std::vector<uint8_t> &config);
+    static std::vector<uint8_t> readFields(const std::vector<std::pair<uint16_t, uint16_t>> &fields);
+    static std::vector<uint8_t> writeFields(const std::vector<Field> &fields);
+
+    // Decodes the specified payload of a response. Returns false if it is no response.
+    static bool decodeResponse(const std::vector<uint8_t> &payload, Response &response);
+
+    // Decodes the data of the specified schema response. Returns false if it is malformed.
+    static bool decodeSchema(const Response &response, Schema &schema);
+};
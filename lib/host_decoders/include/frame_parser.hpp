@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The host-side parser for the binary frames in the serial output of the firmware, as documented in the README. Text lines in
+// between the frames are skipped. It is written against the documented format only, without sharing any code with the firmware,
+// so the tests using it catch the firmware deviating from the documentation.
+class FrameParser
+{
+public:
+    // Feeds the specified serial output into the parser, appending the payloads of all completed frames with a valid checksum.
+    void feed(const uint8_t *data, size_t length);
+
+    // The payloads of all frames parsed so far.
+    std::vector<std::vector<uint8_t>> payloads;
+
+    // The amount of frames discarded because of an invalid checksum.
+    uint32_t invalidFrames = 0;
+
+    // Calculates the CRC-16/CCITT-FALSE checksum of the specified data, continuing from the specified checksum.
+    static uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+private:
+    // The bytes of the frame currently being parsed, including its header, or empty while reading text.
+    std::vector<uint8_t> frame;
+
+    // Bool whether the current byte is the first one of a line, as frames only start at the beginning of a line.
+    bool lineStart = true;
+};
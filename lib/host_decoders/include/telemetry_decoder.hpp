@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The host-side decoder for the telemetry frames streamed by the firmware with "stream <n>", as documented in the README.
+class TelemetryDecoder
+{
+public:
+    // The values of a single Hall Effect key in a telemetry frame.
+    struct Key
+    {
+        uint16_t adcValue;
+        uint16_t rawValue;
+        uint16_t distance;
+        uint16_t rapidTriggerPeak;
+        bool pressed;
+        bool inRapidTriggerZone;
+    };
+
+    // A decoded telemetry frame, with the values of all Hall Effect keys.
+    struct Frame
+    {
+        uint32_t sequence;
+        uint32_t timestamp;
+        std::vector<Key> keys;
+    };
+
+    // Decodes the specified payload of a telemetry frame. Returns false if it is no telemetry frame or malformed.
+    static bool decode(const std::vector<uint8_t> &payload, Frame &frame);
+};
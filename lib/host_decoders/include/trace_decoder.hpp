@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The host-side decoder for the traces of the sensor values dumped by the firmware with "trace dump", as documented in the README.
+class TraceDecoder
+{
+public:
+    // A decoded frame of the trace, with the time it was sampled at and the sensor values of all Hall Effect keys.
+    struct Frame
+    {
+        uint32_t timestamp;
+        std::vector<uint16_t> values;
+    };
+
+    // Adds the specified payload of a trace block frame. Returns false if it is no trace block or malformed.
+    bool addBlock(const std::vector<uint8_t> &payload);
+
+    // Decodes all blocks added so far, ordered by their index in the dump, into the frames. Returns false if blocks are missing.
+    bool decode(std::vector<Frame> &frames) const;
+
+    // The amount of Hall Effect keys in the trace, or 0 if no block has been added yet.
+    uint8_t keyCount = 0;
+
+private:
+    // The blocks of the dump, indexed by their index, and the amount of blocks in the dump.
+    std::vector<std::vector<uint8_t>> blocks;
+    uint16_t blockCount = 0;
+};
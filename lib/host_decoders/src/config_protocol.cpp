@@ -0,0 +1,79 @@
+#include "config_protocol.hpp"
+#include "frame_parser.hpp"
+
+// The byte every binary frame starts with.
+static constexpr uint8_t magic = 0xA5;
+
+// Appends the specified value as a little-endian uint16 to the specified data.
+static void appendUInt16(std::vector<uint8_t> &data, uint16_t value)
+{
+    data.push_back(value);
+    data.push_back(value >> 8);
+}
+
+std::vector<uint8_t> ConfigProtocol::encodeFrame(const std::vector<uint8_t> &payload)
+{
+    // The checksum covers the length and the payload, but not the magic byte.
+    std::vector<uint8_t> frame = {magic};
+    appendUInt16(frame, payload.size());
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    appendUInt16(frame, FrameParser::crc16(frame.data() + 1, frame.size() - 1));
+    return frame;
+}
+
+std::vector<uint8_t> ConfigProtocol::writeConfig(const std::vector<uint8_t> &config)
+{
+    std::vector<uint8_t> payload = {writeConfigType};
+    payload.insert(payload.end(), config.begin(), config.end());
+    return payload;
+}
+
+std::vector<uint8_t> ConfigProtocol::readFields(const std::vector<std::pair<uint16_t, uint16_t>> &fields)
+{
+    std::vector<uint8_t> payload = {readFieldsType, (uint8_t)fields.size()};
+    for (const std::pair<uint16_t, uint16_t> &field : fields)
+    {
+        appendUInt16(payload, field.first);
+        appendUInt16(payload, field.second);
+    }
+
+    return payload;
+}
+
+std::vector<uint8_t> ConfigProtocol::writeFields(const std::vector<Field> &fields)
+{
+    std::vector<uint8_t> payload = {writeFieldsType, (uint8_t)fields.size()};
+    for (const Field &field : fields)
+    {
+        appendUInt16(payload, field.offset);
+        appendUInt16(payload, field.bytes.size());
+        payload.insert(payload.end(), field.bytes.begin(), field.bytes.end());
+    }
+
+    return payload;
+}
+
+bool ConfigProtocol::decodeResponse(const std::vector<uint8_t> &payload, Response &response)
+{
+    // Responses are of the type of the request with bit 7 set, followed by the status.
+    if (payload.size() < 2 || !(payload[0] & 0x80))
+        return false;
+
+    response.type = payload[0] & 0x7F;
+    response.status = payload[1];
+    response.data.assign(payload.begin() + 2, payload.end());
+    return true;
+}
+
+bool ConfigProtocol::decodeSchema(const Response &response, Schema &schema)
+{
+    if (response.type != schemaType || response.data.size() != 8)
+        return false;
+
+    const std::vector<uint8_t> &data = response.data;
+    schema.version = data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+    schema.size = data[4] | data[5] << 8;
+    schema.heKeys = data[6];
+    schema.digitalKeys = data[7];
+    return true;
+}
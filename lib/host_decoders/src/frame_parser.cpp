@@ -0,0 +1,57 @@
+#include "frame_parser.hpp"
+
+// The byte every binary frame starts with, and the size of the header and checksum around the payload.
+static constexpr uint8_t magic = 0xA5;
+static constexpr size_t headerSize = 3;
+static constexpr size_t checksumSize = 2;
+
+void FrameParser::feed(const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        const uint8_t byte = data[i];
+
+        // Outside of a frame, skip the text until a frame starts at the beginning of a line.
+        if (frame.empty())
+        {
+            if (lineStart && byte == magic)
+                frame.push_back(byte);
+            else
+                lineStart = byte == '\n';
+
+            continue;
+        }
+
+        // Collect the bytes of the frame until it is complete, which is known once the length has been read.
+        frame.push_back(byte);
+        if (frame.size() < headerSize)
+            continue;
+
+        const uint16_t payloadLength = frame[1] | frame[2] << 8;
+        if (frame.size() < headerSize + payloadLength + checksumSize)
+            continue;
+
+        // Check the checksum over the length and the payload, and keep the payload if it is valid.
+        const uint16_t checksum = frame[headerSize + payloadLength] | frame[headerSize + payloadLength + 1] << 8;
+        if (crc16(frame.data() + 1, 2 + payloadLength) == checksum)
+            payloads.emplace_back(frame.begin() + headerSize, frame.begin() + headerSize + payloadLength);
+        else
+            invalidFrames++;
+
+        frame.clear();
+        lineStart = true;
+    }
+}
+
+uint16_t FrameParser::crc16(const uint8_t *data, size_t length, uint16_t crc)
+{
+    // The polynomial 0x1021, processed bit by bit starting with the most significant one.
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
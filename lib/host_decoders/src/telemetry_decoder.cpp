@@ -0,0 +1,44 @@
+#include "telemetry_decoder.hpp"
+
+// The type of the telemetry frame payloads, the size of their header and the size of the values of every key.
+static constexpr uint8_t frameType = 0x01;
+static constexpr size_t headerSize = 10;
+static constexpr size_t keySize = 9;
+
+// Reads a little-endian unsigned integer of the specified size at the specified position.
+static uint32_t readInt(const std::vector<uint8_t> &data, size_t position, uint8_t size)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < size; i++)
+        value |= (uint32_t)data[position + i] << (8 * i);
+
+    return value;
+}
+
+bool TelemetryDecoder::decode(const std::vector<uint8_t> &payload, Frame &frame)
+{
+    if (payload.size() < headerSize || payload[0] != frameType)
+        return false;
+
+    // The payload has to contain exactly the values of the amount of keys in the header.
+    const uint8_t keyCount = payload[9];
+    if (payload.size() != headerSize + keyCount * keySize)
+        return false;
+
+    frame.sequence = readInt(payload, 1, 4);
+    frame.timestamp = readInt(payload, 5, 4);
+    frame.keys.resize(keyCount);
+    for (uint8_t i = 0; i < keyCount; i++)
+    {
+        const size_t position = headerSize + i * keySize;
+        Key &key = frame.keys[i];
+        key.adcValue = readInt(payload, position, 2);
+        key.rawValue = readInt(payload, position + 2, 2);
+        key.distance = readInt(payload, position + 4, 2);
+        key.rapidTriggerPeak = readInt(payload, position + 6, 2);
+        key.pressed = payload[position + 8] & 0x01;
+        key.inRapidTriggerZone = payload[position + 8] & 0x02;
+    }
+
+    return true;
+}
@@ -0,0 +1,82 @@
+#include <cstring>
+#include "trace_decoder.hpp"
+
+// The type of the trace block payloads and the size of their header, preceding the block.
+static constexpr uint8_t blockType = 0x02;
+static constexpr size_t headerSize = 6;
+
+// Reads an unsigned LEB128 varint at the specified position, advancing the position past it. Returns false if the data ends within it.
+static bool readVarInt(const std::vector<uint8_t> &data, size_t &position, uint32_t &value)
+{
+    value = 0;
+    for (uint8_t shift = 0; shift < 35 && position < data.size(); shift += 7)
+    {
+        const uint8_t byte = data[position++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+bool TraceDecoder::addBlock(const std::vector<uint8_t> &payload)
+{
+    if (payload.size() < headerSize || payload[0] != blockType)
+        return false;
+
+    // Take the amount of blocks and keys from the first block, with all further blocks having to be of the same dump.
+    const uint16_t index = payload[1] | payload[2] << 8;
+    const uint16_t count = payload[3] | payload[4] << 8;
+    if (blocks.empty())
+    {
+        blockCount = count;
+        keyCount = payload[5];
+        blocks.resize(count);
+    }
+
+    if (count != blockCount || payload[5] != keyCount || index >= blockCount)
+        return false;
+
+    blocks[index].assign(payload.begin() + headerSize, payload.end());
+    return true;
+}
+
+bool TraceDecoder::decode(std::vector<Frame> &frames) const
+{
+    frames.clear();
+    for (const std::vector<uint8_t> &block : blocks)
+    {
+        // Every block starts with a keyframe of the absolute time and values.
+        const size_t keyframeSize = 4 + keyCount * 2;
+        if (block.size() < keyframeSize)
+            return false;
+
+        Frame frame = {0, std::vector<uint16_t>(keyCount)};
+        memcpy(&frame.timestamp, block.data(), 4);
+        for (uint8_t i = 0; i < keyCount; i++)
+            frame.values[i] = block[4 + i * 2] | block[5 + i * 2] << 8;
+        frames.push_back(frame);
+
+        // Every further frame consists of the time difference and the zigzag-encoded value differences to the previous frame.
+        size_t position = keyframeSize;
+        while (position < block.size())
+        {
+            uint32_t delta;
+            if (!readVarInt(block, position, delta))
+                return false;
+            frame.timestamp += delta;
+
+            for (uint16_t &value : frame.values)
+            {
+                if (!readVarInt(block, position, delta))
+                    return false;
+                value += delta & 1 ? -(int32_t)(delta >> 1) - 1 : (int32_t)(delta >> 1);
+            }
+
+            frames.push_back(frame);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// Host-native replacement for the Arduino core of the RP2040, providing the parts of the Arduino API used by the firmware.
+// The time, pins and serial interface are simulated by the Simulator instance, which tests and benchmarks use to drive the firmware.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cstdio>
+#include "simulator.hpp"
+
+// The first analog pin of the RP2040.
+#define A0 26
+
+// The pin modes and levels.
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long milliseconds);
+void delayMicroseconds(unsigned int microseconds);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReadResolution(int bits);
+
+void noInterrupts();
+void interrupts();
+
+// Hint for busy-waiting loops. On the host, a microsecond passes with every iteration, as the time does not advance on its own.
+static inline void tight_loop_contents()
+{
+    Simulator.advance(1);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// The min, max and constrain functions as defined by the Arduino API, accepting arguments of different types.
+template <class T, class L>
+auto min(const T &a, const L &b) -> decltype((b < a) ? b : a)
+{
+    return (b < a) ? b : a;
+}
+
+template <class T, class L>
+auto max(const T &a, const L &b) -> decltype((b < a) ? b : a)
+{
+    return (a < b) ? b : a;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// The serial interface, reading the input written into the simulator and writing the output into it.
+class SerialUSB
+{
+public:
+    void begin(unsigned long baud);
+    int available();
+    int peek();
+    int read();
+    int availableForWrite();
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t *data, size_t length);
+    void flush() {}
+    operator bool() { return true; }
+};
+
+extern SerialUSB Serial;
+
+// The functions of the RP2040 class used by the firmware. As the host only runs one core, idling the other core does nothing.
+class RP2040
+{
+public:
+    void enableDoubleResetBootloader() {}
+    void idleOtherCore() {}
+    void resumeOtherCore() {}
+    uint32_t getCycleCount();
+};
+
+extern RP2040 rp2040;
@@ -0,0 +1,33 @@
+#pragma once
+
+// Host-native replacement for the EEPROM library, emulating the EEPROM in RAM. The contents are kept in the simulator.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "simulator.hpp"
+
+class EEPROMClass
+{
+public:
+    void begin(size_t size);
+    bool commit();
+
+    // Reads an object from the EEPROM at the specified address.
+    template <typename T>
+    T &get(int address, T &value)
+    {
+        memcpy(&value, Simulator.eeprom + address, sizeof(T));
+        return value;
+    }
+
+    // Writes an object into the EEPROM at the specified address.
+    template <typename T>
+    const T &put(int address, const T &value)
+    {
+        memcpy(Simulator.eeprom + address, &value, sizeof(T));
+        return value;
+    }
+};
+
+extern EEPROMClass EEPROM;
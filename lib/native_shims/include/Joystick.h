@@ -0,0 +1,29 @@
+#pragma once
+
+// Host-native replacement for the Joystick library, recording the axis values and the sent reports into the simulator.
+
+#include <cstdint>
+
+class Joystick_
+{
+public:
+    void begin() {}
+    void end() {}
+    void use10bit() {}
+    void useManualSend(bool manualSend) { this->manualSend = manualSend; }
+    void X(uint16_t value) { setAxis(0, value); }
+    void Y(uint16_t value) { setAxis(1, value); }
+    void Z(uint16_t value) { setAxis(2, value); }
+    void Zrotate(uint16_t value) { setAxis(3, value); }
+    void sliderLeft(uint16_t value) { setAxis(4, value); }
+    void sliderRight(uint16_t value) { setAxis(5, value); }
+    void send_now();
+
+private:
+    void setAxis(uint8_t axis, uint16_t value);
+
+    // Bool whether reports are only sent when requested.
+    bool manualSend = false;
+};
+
+extern Joystick_ Joystick;
@@ -0,0 +1,28 @@
+#pragma once
+
+// Host-native replacement for the Keyboard library. The firmware sends its keyboard reports via TinyUSB directly,
+// so the library is only set up, and the keys pressed through it are recorded into the simulator like the reports.
+
+#include <cstdint>
+#include <cstddef>
+
+class Keyboard_
+{
+public:
+    void begin() {}
+    void end() {}
+    void setAutoReport(bool autoReport) { this->autoReport = autoReport; }
+    size_t press(uint8_t key);
+    size_t release(uint8_t key);
+    void releaseAll();
+    void sendReport();
+
+private:
+    // Bool whether a report is sent on every press and release.
+    bool autoReport = true;
+
+    // The keys currently pressed through the library.
+    uint8_t keys[6] = {};
+};
+
+extern Keyboard_ Keyboard;
@@ -0,0 +1,14 @@
+#pragma once
+
+// Host-native replacement for the USB declarations of the RP2040 core.
+
+#include <cstdint>
+
+typedef struct
+{
+    uint32_t owner;
+} mutex_t;
+
+// The mutex guarding the USB stack and the report ID of the keyboard interface set up by the Keyboard library.
+extern mutex_t __usb_mutex;
+int __USBGetKeyboardReportID();
@@ -0,0 +1,19 @@
+#pragma once
+
+// Host-native replacement for the USB class of the RP2040 core, which assembles the report descriptor of the HID interface from the
+// descriptors registered by the HID devices. The registered descriptors are kept in the simulator, with the report IDs being assigned
+// in the order of the registration, following the keyboard of the Keyboard library.
+
+#include <cstddef>
+#include <cstdint>
+
+class RP2040USB
+{
+public:
+    uint8_t registerHIDDevice(const uint8_t *descriptor, size_t length, int ordering, uint32_t vidMask);
+    uint8_t findHIDReportID(unsigned int localID);
+    void disconnect() {}
+    void connect() {}
+};
+
+extern RP2040USB USB;
@@ -0,0 +1,42 @@
+#pragma once
+
+// Host-native replacement for the ADC functions of the Pico SDK. The ADC converts the values set in the simulator, either on
+// request or free-running in a round-robin, with the samples being written into the FIFO read by DMA at the configured rate.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// The bit of the control register telling whether the ADC is ready for a conversion, which the simulated ADC always is, as the
+// samples of the free-running ADC are taken at once.
+#define ADC_CS_READY_BITS 0x00000100u
+
+// The registers of the ADC, of which only the FIFO is used as the source address of DMA transfers.
+typedef struct
+{
+    volatile uint32_t cs;
+    volatile uint32_t result;
+    volatile uint32_t fcs;
+    volatile uint32_t fifo;
+    volatile uint32_t div;
+} adc_hw_t;
+
+extern adc_hw_t *adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(unsigned int gpio);
+void adc_select_input(unsigned int input);
+void adc_set_round_robin(unsigned int input_mask);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_set_clkdiv(float clkdiv);
+void adc_run(bool run);
+void adc_fifo_drain(void);
+uint16_t adc_read(void);
+
+#ifdef __cplusplus
+}
+#endif
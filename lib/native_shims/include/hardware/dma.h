@@ -0,0 +1,72 @@
+#pragma once
+
+// Host-native replacement for the DMA functions of the Pico SDK. Only transfers paced by the ADC are simulated, which are
+// run by the simulator whenever the ADC produces a sample, including the chaining of channels and the completion interrupts.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// The transfer request signal of the ADC FIFO.
+#define DREQ_ADC 36
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+// The configuration of a DMA channel. Unlike on the RP2040, the settings are kept as separate fields instead of a control register.
+typedef struct
+{
+    enum dma_channel_transfer_size transfer_size;
+    bool read_increment;
+    bool write_increment;
+    unsigned int dreq;
+    unsigned int chain_to;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(unsigned int channel);
+void dma_channel_configure(unsigned int channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr,
+                           unsigned int transfer_count, bool trigger);
+void dma_channel_start(unsigned int channel);
+void dma_channel_abort(unsigned int channel);
+void dma_channel_set_write_addr(unsigned int channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_irq1_enabled(unsigned int channel, bool enabled);
+bool dma_channel_get_irq1_status(unsigned int channel);
+void dma_channel_acknowledge_irq1(unsigned int channel);
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size size)
+{
+    config->transfer_size = size;
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *config, bool increment)
+{
+    config->read_increment = increment;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *config, bool increment)
+{
+    config->write_increment = increment;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *config, unsigned int dreq)
+{
+    config->dreq = dreq;
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config *config, unsigned int chain_to)
+{
+    config->chain_to = chain_to;
+}
+
+#ifdef __cplusplus
+}
+#endif
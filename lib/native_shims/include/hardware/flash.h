@@ -0,0 +1,26 @@
+#pragma once
+
+// Host-native replacement for the flash functions of the Pico SDK, writing into the flash simulated in RAM. Like on the RP2040,
+// erasing sets all bits of a sector, while programming can only clear bits. The flash is mapped to memory at XIP_BASE.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FLASH_PAGE_SIZE 256
+#define FLASH_SECTOR_SIZE 4096
+
+// The simulated flash, with the filesystem region at its end as in the linker script of the RP2040 core.
+extern uint8_t native_flash[];
+#define XIP_BASE ((uintptr_t)native_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+// Host-native replacement for the GPIO functions of the Pico SDK. The levels of the pins are set in the simulator,
+// raising the GPIO interrupt on the enabled edges.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/irq.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+
+void gpio_init_mask(uint32_t gpio_mask);
+void gpio_set_dir_out_masked(uint32_t mask);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler);
+void gpio_set_irq_enabled(unsigned int gpio, uint32_t events, bool enabled);
+uint32_t gpio_get_irq_event_mask(unsigned int gpio);
+void gpio_acknowledge_irq(unsigned int gpio, uint32_t events);
+
+#ifdef __cplusplus
+}
+#endif
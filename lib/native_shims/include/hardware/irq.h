@@ -0,0 +1,25 @@
+#pragma once
+
+// Host-native replacement for the interrupt functions of the Pico SDK. The handlers are called by the simulator
+// when the simulated hardware raises the interrupt, if it is enabled.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define DMA_IRQ_1 12
+#define IO_IRQ_BANK0 13
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+void irq_add_shared_handler(unsigned int num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(unsigned int num, bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+// Host-native replacement for the SIO registers of the RP2040, with the GPIO levels being set in the simulator.
+
+#include <stdint.h>
+
+typedef struct
+{
+    volatile uint32_t cpuid;
+    volatile uint32_t gpio_in;
+} sio_hw_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern sio_hw_t *sio_hw;
+
+#ifdef __cplusplus
+}
+#endif
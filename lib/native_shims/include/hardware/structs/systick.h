@@ -0,0 +1,27 @@
+#pragma once
+
+// Host-native replacement for the SysTick registers of the RP2040. Once enabled, the counter runs with the simulated time at the clock of the CPU.
+
+#include <stdint.h>
+
+#define M0PLUS_SYST_CSR_ENABLE_BITS 0x1u
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS 0x4u
+
+typedef struct
+{
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern systick_hw_t *systick_hw;
+
+#ifdef __cplusplus
+}
+#endif
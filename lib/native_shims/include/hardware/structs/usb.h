@@ -0,0 +1,23 @@
+#pragma once
+
+// Host-native replacement for the USB registers of the RP2040, with the frame number advancing every millisecond of the simulated time.
+
+#include <stdint.h>
+
+#define USB_SOF_RD_BITS 0x7ffu
+
+typedef struct
+{
+    volatile uint32_t sof_rd;
+} usb_hw_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern usb_hw_t *usb_hw;
+
+#ifdef __cplusplus
+}
+#endif
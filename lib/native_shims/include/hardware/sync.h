@@ -0,0 +1,15 @@
+#pragma once
+
+// Host-native replacement for the synchronization functions of the Pico SDK.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Waits for an event, which advances the simulated time to the next alarm, as nothing else can happen in the meantime on the host.
+void __wfe(void);
+
+#ifdef __cplusplus
+}
+#endif
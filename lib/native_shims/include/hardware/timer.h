@@ -0,0 +1,30 @@
+#pragma once
+
+// Host-native replacement for the timer functions of the Pico SDK, based on the time of the simulator.
+// The hardware alarms fire once the simulated time reaches their target.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef uint64_t absolute_time_t;
+typedef void (*hardware_alarm_callback_t)(unsigned int alarm_num);
+
+static inline absolute_time_t from_us_since_boot(uint64_t us)
+{
+    return us;
+}
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_set_callback(unsigned int alarm_num, hardware_alarm_callback_t callback);
+bool hardware_alarm_set_target(unsigned int alarm_num, absolute_time_t target);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+// Host-native replacement for the bootrom functions of the Pico SDK. Rebooting into the bootloader is recorded in the simulator.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void reset_usb_boot(uint32_t usb_activity_gpio_pin_mask, uint32_t disable_interface_mask);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The simulated hardware of the RP2040 the shims of the native environment are based on, allowing the firmware to run on the host.
+// The time only advances when requested, running the free-running ADC, the DMA transfers paced by it and the hardware alarms in
+// between, and raising their interrupts at the simulated time they happen at. This way, tests and benchmarks drive the firmware
+// deterministically, with the sensor values and pin levels being set from the outside and the sent HID reports being recorded.
+inline class Simulator
+{
+public:
+    Simulator()
+    {
+        reset();
+    }
+
+    void reset();
+    void advance(uint32_t microseconds);
+    void waitForEvent();
+    void setAnalogValue(uint8_t pin, uint16_t value);
+    void setDigitalLevel(uint8_t pin, bool high);
+    void writeSerialInput(std::string_view data);
+    std::string readSerialOutput();
+
+    // Returns the simulated time in microseconds since firmware bootup.
+    uint64_t getTime() const
+    {
+        return time;
+    }
+
+    // A keyboard report sent via the HID interface, along with the simulated time it was sent at. Boot protocol reports contain up
+    // to 6 keys, while NKRO reports contain the bitmap of the usages 0x00 to 0xDF.
+    struct KeyboardReport
+    {
+        uint64_t time;
+        bool nkro;
+        uint8_t modifiers;
+        uint8_t keys[6];
+        uint8_t usages[28];
+
+        // Returns whether the specified usage, which may not be a modifier, is pressed in the report.
+        bool contains(uint8_t usage) const
+        {
+            if (nkro)
+                return usage < 0xE0 && usages[usage / 8] & (1 << (usage % 8));
+
+            for (uint8_t key : keys)
+                if (key == usage)
+                    return true;
+
+            return false;
+        }
+    };
+
+    // All keyboard reports sent via the HID interface since the last reset.
+    std::vector<KeyboardReport> keyboardReports;
+
+    // The report descriptors registered for the HID interface, and the protocol selected by the host device, with 0 being the boot
+    // protocol and 1 the report protocol. The host device selects the report protocol unless it only supports the boot protocol.
+    std::vector<std::vector<uint8_t>> hidDescriptors;
+    uint8_t hidProtocol;
+
+    // The axis values of the gamepad and the amount of gamepad reports sent since the last reset.
+    uint16_t gamepadAxes[6];
+    uint32_t gamepadReports;
+
+    // Bool whether the HID interface is ready to take another report.
+    bool hidReady;
+
+    // The amount of bytes the host device takes from the serial interface per write, simulating a host device reading slowly if lowered.
+    int serialWriteCapacity;
+
+    // Bool whether a reboot into the bootloader has been requested.
+    bool rebootRequested;
+
+    // The analog multiplexers in front of the ADC inputs, only simulated if enabled. The channel of all multiplexers is switched by the select
+    // lines on consecutive pins, starting at the base pin. After switching, the ADC inputs keep reading the previously selected channel until
+    // the settle time has passed, with these reads being counted. The values are the sensor values of every channel of every multiplexer.
+    struct
+    {
+        bool enabled;
+        uint8_t selectBits;
+        uint8_t selectPinBase;
+        uint32_t settleTime;
+        uint16_t values[4][16];
+        uint32_t unsettledReads;
+        uint8_t selectedChannel;
+        uint8_t previousChannel;
+        uint64_t selectedAt;
+    } multiplexers;
+
+    // The amount of sectors erased and pages programmed in the flash since the last reset, for checking the wear of the flash.
+    uint32_t flashErases;
+    uint32_t flashPrograms;
+
+    // The time erasing a sector and programming a page of the flash takes in microseconds, being the typical times of the flash chips
+    // used with the RP2040. The time passes while the flash is written, with the ADC and DMA running on and interrupts being held back.
+    static constexpr uint32_t flashEraseTime = 45000;
+    static constexpr uint32_t flashProgramTime = 400;
+
+    // The size of the flash, with the filesystem region at its end, and of the filesystem region, as set up in the platformio.ini.
+    static constexpr size_t flashSize = 4096 + 64 * 1024;
+    static constexpr size_t filesystemSize = 64 * 1024;
+
+    // The contents of the emulated EEPROM.
+    uint8_t eeprom[4096];
+
+    // The state of the simulated hardware, used by the shims.
+    // The analog values of all pins and the levels of all pins as read from the GPIO input register.
+    uint16_t analogValues[30];
+    uint32_t gpioLevels;
+
+    // The state of the ADC, with the time of the next sample in cycles of the 48MHz ADC clock.
+    struct
+    {
+        bool running;
+        bool dreqEnabled;
+        uint8_t input;
+        uint8_t roundRobinMask;
+        uint32_t clockDivider;
+        uint64_t nextSampleAt;
+    } adc;
+
+    // The state of all DMA channels.
+    struct DMAChannel
+    {
+        bool claimed;
+        bool busy;
+        bool irq1Enabled;
+        bool irq1Status;
+        uint8_t transferSize;
+        bool writeIncrement;
+        uint8_t dreq;
+        uint8_t chainTo;
+        volatile uint8_t *writeAddress;
+        uint32_t transferCount;
+        uint32_t remaining;
+    } dmaChannels[12];
+
+    // The state of the hardware alarms, with the target being the time they fire at in microseconds.
+    struct Alarm
+    {
+        bool claimed;
+        bool armed;
+        uint64_t target;
+        void (*callback)(unsigned int alarm);
+    } alarms[4];
+
+    // The interrupt handlers added to every interrupt, whether the interrupts are enabled, and whether they are raised but not handled yet
+    // as interrupts are disabled globally. The GPIO interrupt handlers are added for the pins in their mask.
+    std::vector<void (*)()> irqHandlers[32];
+    bool irqEnabled[32];
+    bool irqPending[32];
+    bool interruptsDisabled;
+    std::vector<std::pair<uint32_t, void (*)()>> gpioHandlers;
+
+    // The edges the GPIO interrupt is enabled for on every pin, and the edges that have been detected and not acknowledged yet.
+    uint32_t gpioIrqEvents[30];
+    uint32_t gpioIrqPending[30];
+
+    // The serial input not read yet and the serial output not read from the simulator yet.
+    std::string serialInput;
+    std::string serialOutput;
+
+    void raiseIRQ(unsigned int num);
+    void runADC(uint64_t until);
+    void setTime(uint64_t time);
+
+private:
+    void sample();
+
+    // The simulated time in microseconds since firmware bootup.
+    uint64_t time;
+} Simulator;
@@ -0,0 +1,14 @@
+#pragma once
+
+// Host-native replacement for the HID device functions of TinyUSB, recording the sent reports into the simulator.
+
+#include <cstdint>
+
+// The protocols the host device can select for the HID interface.
+#define HID_PROTOCOL_BOOT 0
+#define HID_PROTOCOL_REPORT 1
+
+bool tud_hid_ready();
+uint8_t tud_hid_get_protocol();
+bool tud_hid_report(uint8_t report_id, const void *report, uint16_t len);
+bool tud_hid_keyboard_report(uint8_t report_id, uint8_t modifier, const uint8_t keycode[6]);
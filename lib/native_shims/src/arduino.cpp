@@ -0,0 +1,239 @@
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "Keyboard.h"
+#include "Joystick.h"
+#include "RP2040USB.h"
+#include "USB.h"
+#include "tusb.h"
+
+SerialUSB Serial;
+RP2040 rp2040;
+EEPROMClass EEPROM;
+Keyboard_ Keyboard;
+RP2040USB USB;
+Joystick_ Joystick;
+mutex_t __usb_mutex;
+
+unsigned long millis()
+{
+    return (unsigned long)(Simulator.getTime() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)Simulator.getTime();
+}
+
+void delay(unsigned long milliseconds)
+{
+    Simulator.advance(milliseconds * 1000);
+}
+
+void delayMicroseconds(unsigned int microseconds)
+{
+    Simulator.advance(microseconds);
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (Simulator.gpioLevels >> pin) & 1 ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    return Simulator.analogValues[pin];
+}
+
+void analogReadResolution(int)
+{
+}
+
+void noInterrupts()
+{
+    Simulator.interruptsDisabled = true;
+}
+
+void interrupts()
+{
+    // Handle all interrupts that have been raised while interrupts were disabled.
+    Simulator.interruptsDisabled = false;
+    for (unsigned int i = 0; i < sizeof(Simulator.irqPending) / sizeof(*Simulator.irqPending); i++)
+        if (Simulator.irqPending[i])
+        {
+            Simulator.irqPending[i] = false;
+            Simulator.raiseIRQ(i);
+        }
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+void SerialUSB::begin(unsigned long)
+{
+}
+
+int SerialUSB::available()
+{
+    return (int)Simulator.serialInput.size();
+}
+
+int SerialUSB::peek()
+{
+    return Simulator.serialInput.empty() ? -1 : (uint8_t)Simulator.serialInput.front();
+}
+
+int SerialUSB::read()
+{
+    if (Simulator.serialInput.empty())
+        return -1;
+
+    const uint8_t byte = Simulator.serialInput.front();
+    Simulator.serialInput.erase(0, 1);
+    return byte;
+}
+
+int SerialUSB::availableForWrite()
+{
+    return Simulator.serialWriteCapacity;
+}
+
+size_t SerialUSB::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t SerialUSB::write(const uint8_t *data, size_t length)
+{
+    // Only take as many bytes as the host device reads per write, like the USB CDC buffer of the RP2040 core.
+    if ((int)length > Simulator.serialWriteCapacity)
+        length = Simulator.serialWriteCapacity;
+
+    Simulator.serialOutput.append((const char *)data, length);
+    return length;
+}
+
+uint32_t RP2040::getCycleCount()
+{
+    // The RP2040 runs at 133MHz by default.
+    return (uint32_t)(Simulator.getTime() * 133);
+}
+
+void EEPROMClass::begin(size_t)
+{
+}
+
+bool EEPROMClass::commit()
+{
+    return true;
+}
+
+size_t Keyboard_::press(uint8_t key)
+{
+    for (uint8_t &slot : keys)
+        if (slot == key)
+            return 1;
+
+    for (uint8_t &slot : keys)
+        if (!slot)
+        {
+            slot = key;
+            if (autoReport)
+                sendReport();
+            return 1;
+        }
+
+    return 0;
+}
+
+size_t Keyboard_::release(uint8_t key)
+{
+    for (uint8_t &slot : keys)
+        if (slot == key)
+        {
+            slot = 0;
+            if (autoReport)
+                sendReport();
+            return 1;
+        }
+
+    return 0;
+}
+
+void Keyboard_::releaseAll()
+{
+    memset(keys, 0, sizeof(keys));
+    if (autoReport)
+        sendReport();
+}
+
+void Keyboard_::sendReport()
+{
+    tud_hid_keyboard_report(__USBGetKeyboardReportID(), 0, keys);
+}
+
+void Joystick_::setAxis(uint8_t axis, uint16_t value)
+{
+    Simulator.gamepadAxes[axis] = value;
+    if (!manualSend)
+        send_now();
+}
+
+void Joystick_::send_now()
+{
+    Simulator.gamepadReports++;
+}
+
+int __USBGetKeyboardReportID()
+{
+    return 1;
+}
+
+uint8_t RP2040USB::registerHIDDevice(const uint8_t *descriptor, size_t length, int, uint32_t)
+{
+    Simulator.hidDescriptors.emplace_back(descriptor, descriptor + length);
+    return Simulator.hidDescriptors.size() - 1;
+}
+
+uint8_t RP2040USB::findHIDReportID(unsigned int localID)
+{
+    return __USBGetKeyboardReportID() + 1 + localID;
+}
+
+bool tud_hid_ready()
+{
+    return Simulator.hidReady;
+}
+
+uint8_t tud_hid_get_protocol()
+{
+    return Simulator.hidProtocol;
+}
+
+bool tud_hid_report(uint8_t report_id, const void *report, uint16_t len)
+{
+    // The only reports sent this way are the NKRO reports, with their report ID being the one of the first registered descriptor.
+    if (!Simulator.hidReady || report_id != USB.findHIDReportID(0) || len != 1 + sizeof(Simulator::KeyboardReport::usages))
+        return false;
+
+    Simulator::KeyboardReport record = {Simulator.getTime(), true, ((const uint8_t *)report)[0], {}, {}};
+    memcpy(record.usages, (const uint8_t *)report + 1, sizeof(record.usages));
+    Simulator.keyboardReports.push_back(record);
+    return true;
+}
+
+bool tud_hid_keyboard_report(uint8_t, uint8_t modifier, const uint8_t keycode[6])
+{
+    if (!Simulator.hidReady)
+        return false;
+
+    Simulator::KeyboardReport report = {Simulator.getTime(), false, modifier, {}, {}};
+    memcpy(report.keys, keycode, sizeof(report.keys));
+    Simulator.keyboardReports.push_back(report);
+    return true;
+}
@@ -0,0 +1,292 @@
+#include <cstring>
+#include "simulator.hpp"
+extern "C"
+{
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "hardware/flash.h"
+#include "hardware/structs/sio.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/usb.h"
+#include "pico/bootrom.h"
+}
+
+// The simulated registers, with the GPIO input register being kept up to date with the levels of the pins by the simulator.
+static adc_hw_t adcRegisters;
+static systick_hw_t systickRegisters;
+static usb_hw_t usbRegisters;
+static sio_hw_t sioRegisters;
+
+extern "C"
+{
+adc_hw_t *adc_hw = &adcRegisters;
+systick_hw_t *systick_hw = &systickRegisters;
+usb_hw_t *usb_hw = &usbRegisters;
+sio_hw_t *sio_hw = &sioRegisters;
+
+// The simulated flash, with the boundaries of the filesystem region being provided as symbols like by the linker script of the RP2040 core.
+uint8_t native_flash[Simulator.flashSize];
+}
+
+asm(".globl _FS_start\n"
+    ".set _FS_start, native_flash + 4096\n"
+    ".globl _FS_end\n"
+    ".set _FS_end, native_flash + 4096 + 65536\n");
+
+static_assert(Simulator.flashSize == 4096 + 65536 && Simulator.filesystemSize == 65536, "The filesystem symbols do not match the simulated flash.");
+
+extern "C"
+{
+void adc_init(void)
+{
+    Simulator.adc = {};
+    adc_hw->cs = ADC_CS_READY_BITS;
+}
+
+void adc_gpio_init(unsigned int)
+{
+}
+
+void adc_select_input(unsigned int input)
+{
+    Simulator.adc.input = input;
+}
+
+void adc_set_round_robin(unsigned int input_mask)
+{
+    Simulator.adc.roundRobinMask = input_mask;
+}
+
+void adc_fifo_setup(bool, bool dreq_en, uint16_t, bool, bool)
+{
+    Simulator.adc.dreqEnabled = dreq_en;
+}
+
+void adc_set_clkdiv(float clkdiv)
+{
+    Simulator.adc.clockDivider = (uint32_t)clkdiv;
+}
+
+void adc_run(bool run)
+{
+    // Start the free-running ADC, with the first sample being done after one sample period.
+    Simulator.adc.running = run;
+    const uint32_t period = Simulator.adc.clockDivider + 1 < 96 ? 96 : Simulator.adc.clockDivider + 1;
+    Simulator.adc.nextSampleAt = Simulator.getTime() * 48 + period;
+}
+
+void adc_fifo_drain(void)
+{
+    // The samples are passed to the DMA channels right away, so the FIFO is always empty.
+}
+
+uint16_t adc_read(void)
+{
+    // Sample the selected input, which reads the selected channel of its multiplexer if multiplexers are used. If the multiplexers
+    // have not settled since switching the channel yet, the previously selected channel is read instead.
+    uint16_t value = Simulator.analogValues[26 + Simulator.adc.input];
+    if (Simulator.multiplexers.enabled)
+    {
+        const bool settled = Simulator.getTime() - Simulator.multiplexers.selectedAt >= Simulator.multiplexers.settleTime;
+        value = Simulator.multiplexers.values[Simulator.adc.input][settled ? Simulator.multiplexers.selectedChannel : Simulator.multiplexers.previousChannel];
+        if (!settled)
+            Simulator.multiplexers.unsettledReads++;
+    }
+
+    // A conversion takes 96 cycles of the 48MHz ADC clock, with the result being returned once it is finished.
+    Simulator.advance(2);
+    return value;
+}
+
+int dma_claim_unused_channel(bool)
+{
+    for (uint8_t i = 0; i < sizeof(Simulator.dmaChannels) / sizeof(*Simulator.dmaChannels); i++)
+        if (!Simulator.dmaChannels[i].claimed)
+        {
+            Simulator.dmaChannels[i].claimed = true;
+            return i;
+        }
+
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(unsigned int channel)
+{
+    // By default, channels transfer 32 bit from an incrementing read address to an incrementing write address, unpaced and unchained.
+    return {DMA_SIZE_32, true, true, 0x3F, channel};
+}
+
+void dma_channel_configure(unsigned int channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *,
+                           unsigned int transfer_count, bool trigger)
+{
+    Simulator::DMAChannel &state = Simulator.dmaChannels[channel];
+    state.transferSize = config->transfer_size;
+    state.writeIncrement = config->write_increment;
+    state.dreq = config->dreq;
+    state.chainTo = config->chain_to;
+    state.writeAddress = (volatile uint8_t *)write_addr;
+    state.transferCount = transfer_count;
+    if (trigger)
+        dma_channel_start(channel);
+}
+
+void dma_channel_start(unsigned int channel)
+{
+    // Start the channel, with the transfer count being reloaded.
+    Simulator::DMAChannel &state = Simulator.dmaChannels[channel];
+    state.busy = true;
+    state.remaining = state.transferCount;
+}
+
+void dma_channel_abort(unsigned int channel)
+{
+    // Stop the channel without completing its transfers, which neither starts the chained channel nor raises the interrupt.
+    Simulator.dmaChannels[channel].busy = false;
+}
+
+void dma_channel_set_write_addr(unsigned int channel, volatile void *write_addr, bool trigger)
+{
+    Simulator.dmaChannels[channel].writeAddress = (volatile uint8_t *)write_addr;
+    if (trigger)
+        dma_channel_start(channel);
+}
+
+void dma_channel_set_irq1_enabled(unsigned int channel, bool enabled)
+{
+    Simulator.dmaChannels[channel].irq1Enabled = enabled;
+}
+
+bool dma_channel_get_irq1_status(unsigned int channel)
+{
+    return Simulator.dmaChannels[channel].irq1Status;
+}
+
+void dma_channel_acknowledge_irq1(unsigned int channel)
+{
+    Simulator.dmaChannels[channel].irq1Status = false;
+}
+
+void irq_add_shared_handler(unsigned int num, irq_handler_t handler, uint8_t)
+{
+    Simulator.irqHandlers[num].push_back(handler);
+}
+
+void irq_set_enabled(unsigned int num, bool enabled)
+{
+    Simulator.irqEnabled[num] = enabled;
+}
+
+void gpio_init_mask(uint32_t)
+{
+}
+
+void gpio_set_dir_out_masked(uint32_t)
+{
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    // Reflect the output levels in the input register, as on the hardware.
+    Simulator.gpioLevels = (Simulator.gpioLevels & ~mask) | (value & mask);
+    sio_hw->gpio_in = Simulator.gpioLevels;
+
+    // Switch the channel of the multiplexers if the levels of the select lines changed, which then start settling.
+    const uint8_t channel = (Simulator.gpioLevels >> Simulator.multiplexers.selectPinBase) & ((1 << Simulator.multiplexers.selectBits) - 1);
+    if (Simulator.multiplexers.enabled && channel != Simulator.multiplexers.selectedChannel)
+    {
+        Simulator.multiplexers.previousChannel = Simulator.multiplexers.selectedChannel;
+        Simulator.multiplexers.selectedChannel = channel;
+        Simulator.multiplexers.selectedAt = Simulator.getTime();
+    }
+}
+
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler)
+{
+    Simulator.gpioHandlers.push_back({gpio_mask, handler});
+}
+
+void gpio_set_irq_enabled(unsigned int gpio, uint32_t events, bool enabled)
+{
+    if (enabled)
+        Simulator.gpioIrqEvents[gpio] |= events;
+    else
+        Simulator.gpioIrqEvents[gpio] &= ~events;
+}
+
+uint32_t gpio_get_irq_event_mask(unsigned int gpio)
+{
+    return Simulator.gpioIrqPending[gpio];
+}
+
+void gpio_acknowledge_irq(unsigned int gpio, uint32_t events)
+{
+    Simulator.gpioIrqPending[gpio] &= ~events;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)Simulator.getTime();
+}
+
+uint64_t time_us_64(void)
+{
+    return Simulator.getTime();
+}
+
+int hardware_alarm_claim_unused(bool)
+{
+    for (uint8_t i = 0; i < sizeof(Simulator.alarms) / sizeof(*Simulator.alarms); i++)
+        if (!Simulator.alarms[i].claimed)
+        {
+            Simulator.alarms[i].claimed = true;
+            return i;
+        }
+
+    return -1;
+}
+
+void hardware_alarm_set_callback(unsigned int alarm_num, hardware_alarm_callback_t callback)
+{
+    Simulator.alarms[alarm_num].callback = callback;
+}
+
+bool hardware_alarm_set_target(unsigned int alarm_num, absolute_time_t target)
+{
+    // Like on the hardware, the alarm is not armed if the target has already been reached, which is signalized by returning true.
+    Simulator::Alarm &alarm = Simulator.alarms[alarm_num];
+    alarm.armed = target > Simulator.getTime();
+    alarm.target = target;
+    return !alarm.armed;
+}
+
+void __wfe(void)
+{
+    Simulator.waitForEvent();
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    memset(native_flash + flash_offs, 0xFF, count);
+    Simulator.flashErases += count / FLASH_SECTOR_SIZE;
+    Simulator.advance(count / FLASH_SECTOR_SIZE * Simulator.flashEraseTime);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    // Programming the flash can only clear bits, which is why data can only be written to erased flash.
+    for (size_t i = 0; i < count; i++)
+        native_flash[flash_offs + i] &= data[i];
+
+    Simulator.flashPrograms += count / FLASH_PAGE_SIZE;
+    Simulator.advance(count / FLASH_PAGE_SIZE * Simulator.flashProgramTime);
+}
+
+void reset_usb_boot(uint32_t, uint32_t)
+{
+    Simulator.rebootRequested = true;
+}
+}
@@ -0,0 +1,243 @@
+#include <cstring>
+#include "simulator.hpp"
+extern "C"
+{
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/structs/sio.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/usb.h"
+}
+
+// The clock of the ADC in cycles per microsecond, and the amount of cycles a conversion takes at least.
+static constexpr uint64_t adcCyclesPerMicrosecond = 48;
+static constexpr uint32_t adcConversionCycles = 96;
+
+// The clock of the CPU in cycles per microsecond, which is 133MHz by default.
+static constexpr uint64_t cpuCyclesPerMicrosecond = 133;
+
+void Simulator::reset()
+{
+    // Stop the SysTick timer, and reset the time and the recorded output.
+    *systick_hw = {};
+    setTime(0);
+    keyboardReports.clear();
+    hidProtocol = 1;
+    memset(gamepadAxes, 0, sizeof(gamepadAxes));
+    gamepadReports = 0;
+    hidReady = true;
+    serialWriteCapacity = 4096;
+    rebootRequested = false;
+    multiplexers = {};
+    serialInput.clear();
+    serialOutput.clear();
+
+    // Erase the flash and clear the EEPROM.
+    memset(native_flash, 0xFF, flashSize);
+    memset(eeprom, 0, sizeof(eeprom));
+    flashErases = 0;
+    flashPrograms = 0;
+
+    // Reset the pins, with all pins reading high as if pulled up, and the state of the ADC, DMA channels, alarms and interrupts.
+    memset(analogValues, 0, sizeof(analogValues));
+    gpioLevels = UINT32_MAX;
+    sio_hw->gpio_in = gpioLevels;
+    adc = {};
+    memset(dmaChannels, 0, sizeof(dmaChannels));
+    memset(alarms, 0, sizeof(alarms));
+    for (std::vector<void (*)()> &handlers : irqHandlers)
+        handlers.clear();
+    memset(irqEnabled, 0, sizeof(irqEnabled));
+    memset(irqPending, 0, sizeof(irqPending));
+    interruptsDisabled = false;
+    gpioHandlers.clear();
+    memset(gpioIrqEvents, 0, sizeof(gpioIrqEvents));
+    memset(gpioIrqPending, 0, sizeof(gpioIrqPending));
+}
+
+void Simulator::advance(uint32_t microseconds)
+{
+    // Advance the time from one alarm to the next until the end is reached, running the ADC in between.
+    const uint64_t end = time + microseconds;
+    while (true)
+    {
+        // Find the next alarm firing before the end.
+        uint64_t next = end;
+        for (const Alarm &alarm : alarms)
+            if (alarm.armed && alarm.target < next)
+                next = alarm.target;
+
+        runADC(next);
+        setTime(next);
+
+        // Fire all alarms that are due, disarming them before calling their callback as the hardware does.
+        for (unsigned int i = 0; i < sizeof(alarms) / sizeof(*alarms); i++)
+        {
+            Alarm &alarm = alarms[i];
+            if (!alarm.armed || alarm.target > time)
+                continue;
+
+            alarm.armed = false;
+            if (alarm.callback)
+                alarm.callback(i);
+        }
+
+        if (time >= end)
+            break;
+    }
+}
+
+void Simulator::waitForEvent()
+{
+    // Advance the time to the next alarm, as nothing else can wake up the core. If no alarm is armed, only advance by a microsecond.
+    uint64_t next = UINT64_MAX;
+    for (const Alarm &alarm : alarms)
+        if (alarm.armed && alarm.target < next)
+            next = alarm.target;
+
+    advance(next == UINT64_MAX || next <= time ? 1 : next - time);
+}
+
+void Simulator::setAnalogValue(uint8_t pin, uint16_t value)
+{
+    analogValues[pin] = value;
+}
+
+void Simulator::setDigitalLevel(uint8_t pin, bool high)
+{
+    // Only edges change anything.
+    const uint32_t mask = 1u << pin;
+    if (((gpioLevels & mask) != 0) == high)
+        return;
+
+    gpioLevels ^= mask;
+    sio_hw->gpio_in = gpioLevels;
+
+    // Latch the edge if the interrupt is enabled for it, and raise the interrupt of the GPIO bank.
+    const uint32_t event = high ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (!(gpioIrqEvents[pin] & event))
+        return;
+
+    gpioIrqPending[pin] |= event;
+    raiseIRQ(IO_IRQ_BANK0);
+}
+
+void Simulator::writeSerialInput(std::string_view data)
+{
+    serialInput.append(data);
+}
+
+std::string Simulator::readSerialOutput()
+{
+    // Return the serial output written since the last call.
+    std::string output;
+    output.swap(serialOutput);
+    return output;
+}
+
+void Simulator::raiseIRQ(unsigned int num)
+{
+    // Hold the interrupt back if interrupts are disabled globally, it is handled once they are enabled again.
+    if (!irqEnabled[num])
+        return;
+
+    if (interruptsDisabled)
+    {
+        irqPending[num] = true;
+        return;
+    }
+
+    // The GPIO interrupt calls the handlers of all pins with pending edges, every other interrupt calls all of its handlers.
+    if (num == IO_IRQ_BANK0)
+    {
+        for (const std::pair<uint32_t, void (*)()> &handler : gpioHandlers)
+            for (uint8_t pin = 0; pin < 30; pin++)
+                if ((handler.first & (1u << pin)) && gpioIrqPending[pin])
+                {
+                    handler.second();
+                    break;
+                }
+
+        return;
+    }
+
+    for (void (*handler)() : irqHandlers[num])
+        handler();
+}
+
+void Simulator::runADC(uint64_t until)
+{
+    // Take all samples of the free-running ADC that are done until the specified time, setting the time to the one of every sample,
+    // so the interrupts raised by the DMA transfers see the time they would on the hardware.
+    while (adc.running && adc.nextSampleAt <= until * adcCyclesPerMicrosecond)
+    {
+        setTime(adc.nextSampleAt / adcCyclesPerMicrosecond);
+        sample();
+        adc.nextSampleAt += adc.clockDivider + 1 < adcConversionCycles ? adcConversionCycles : adc.clockDivider + 1;
+    }
+}
+
+void Simulator::setTime(uint64_t time)
+{
+    // Count the SysTick timer down by the CPU cycles passed if it is enabled, reloading it after reaching 0 like the hardware does.
+    if (systick_hw->csr & M0PLUS_SYST_CSR_ENABLE_BITS)
+    {
+        const uint64_t period = (uint64_t)systick_hw->rvr + 1;
+        const uint64_t cycles = (time - this->time) * cpuCyclesPerMicrosecond % period;
+        systick_hw->cvr = (systick_hw->cvr + period - cycles) % period;
+    }
+
+    // Update the time and the number of the current USB frame, with a frame starting every millisecond.
+    this->time = time;
+    usb_hw->sof_rd = (time / 1000) & USB_SOF_RD_BITS;
+}
+
+void Simulator::sample()
+{
+    // Convert the current input, with the ADC inputs 0 to 3 being the pins A0 (26) to A3 (29).
+    const uint32_t value = analogValues[26 + adc.input];
+
+    // Move on to the next input of the round-robin.
+    for (uint8_t i = 1; i <= 5 && adc.roundRobinMask; i++)
+    {
+        const uint8_t input = (adc.input + i) % 5;
+        if (adc.roundRobinMask & (1 << input))
+        {
+            adc.input = input;
+            break;
+        }
+    }
+
+    // Pass the sample to the DMA channel transferring from the ADC FIFO, if any. Without DMA, the sample is dropped.
+    if (!adc.dreqEnabled)
+        return;
+
+    for (uint8_t i = 0; i < sizeof(dmaChannels) / sizeof(*dmaChannels); i++)
+    {
+        DMAChannel &channel = dmaChannels[i];
+        if (!channel.busy || channel.dreq != DREQ_ADC)
+            continue;
+
+        // Write the sample with the transfer size of the channel.
+        const uint8_t size = 1 << channel.transferSize;
+        memcpy((uint8_t *)channel.writeAddress, &value, size);
+        if (channel.writeIncrement)
+            channel.writeAddress += size;
+
+        // Once the channel completed all transfers, trigger the channel it is chained to and raise the interrupt.
+        if (--channel.remaining == 0)
+        {
+            channel.busy = false;
+            if (channel.chainTo != i)
+                dma_channel_start(channel.chainTo);
+
+            channel.irq1Status = true;
+            if (channel.irq1Enabled)
+                raiseIRQ(DMA_IRQ_1);
+        }
+
+        break;
+    }
+}
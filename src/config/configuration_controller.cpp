@@ -1,23 +1,118 @@
 #include <EEPROM.h>
 #include <Arduino.h>
+#include <cstring>
 #include "config/configuration_controller.hpp"
+#include "helpers/scan_scheduler.hpp"
 
 void ConfigurationController::loadConfig()
 {
-    // Load the configuration struct from the EEPROM.
-    EEPROM.get(0, config);
+    // Load the newest configuration from the journal. If the journal is empty, fall back to the configuration
+    // saved in the EEPROM by previous firmware versions and move it into the journal.
+    if (!journal.load(config))
+    {
+        EEPROM.get(0, config);
+        if (config.version == defaultConfig.version)
+            saveConfig();
+    }
 
     // Check if the version matches with the one read; If not, replace the config with it's default state.
     if (config.version != defaultConfig.version)
-    {
         config = defaultConfig;
-        saveConfig();
-    }
+
+    // Fall back to the default scan rate if the saved one is not supported (anymore), as the scans would run at another rate otherwise.
+    if (!ScanScheduler::isSupportedRate(config.scanRate))
+        config.scanRate = defaultConfig.scanRate;
+
+    persistedConfig = config;
 }
 
 void ConfigurationController::saveConfig()
 {
-    // Write the struct back into the EEPROM and commit the change.
-    EEPROM.put(0, config);
-    EEPROM.commit();
+    // Take over the current configuration and schedule the configuration to be committed to the flash. Writing the flash halts the whole chip, which is why the commit is deferred
+    // until the keypad is idle. Every request restarts the delay, meaning multiple saves in a short time only result in a single commit.
+    persistedConfig = config;
+    savePending = true;
+    saveRequestedAt = millis();
+}
+
+void ConfigurationController::update(bool idle)
+{
+    // Commit the configuration to the journal if a save is pending, the delay has passed and no key is pressed.
+    if (!savePending || !idle || millis() - saveRequestedAt < CONFIG_COMMIT_DELAY)
+        return;
+
+    journal.append(persistedConfig);
+    savePending = false;
+}
+
+void ConfigurationController::storeCalibration(uint8_t index, uint16_t restPosition, uint16_t downPosition)
+{
+    // Always keep the calibration in the current configuration up-to-date.
+    config.heKeys[index].restPosition = restPosition;
+    config.heKeys[index].downPosition = downPosition;
+
+    // Only save the calibration if one of the positions moved by at least the threshold since it was last saved. The positions are updated
+    // on many scans while the key is being pressed for the first time and creep slowly afterwards, which would otherwise wear the flash.
+    HEKeyConfig &persisted = persistedConfig.heKeys[index];
+    if (abs(persisted.restPosition - restPosition) < CALIBRATION_SAVE_THRESHOLD && abs(persisted.downPosition - downPosition) < CALIBRATION_SAVE_THRESHOLD)
+        return;
+
+    // Save the calibration into the persisted configuration and schedule it to be committed.
+    persisted.restPosition = restPosition;
+    persisted.downPosition = downPosition;
+    savePending = true;
+    saveRequestedAt = millis();
+}
+
+// Returns whether the specified bool has a valid representation. Bools written byte-wise by the host device could contain other values.
+static bool isValidBool(const bool &value)
+{
+    uint8_t byte;
+    memcpy(&byte, &value, 1);
+    return byte <= 1;
+}
+
+bool ConfigurationController::validateConfig(const Configuration &config) const
+{
+    // Check whether the configuration has the layout of this firmware.
+    if (config.version != defaultConfig.version)
+        return false;
+
+    // Check whether the name is null-terminated and not empty.
+    if (config.name[0] == '\0' || !memchr(config.name, '\0', sizeof(config.name)))
+        return false;
+
+    if (!ScanScheduler::isSupportedRate(config.scanRate))
+        return false;
+
+    // Check whether all values of the Hall Effect keys are within the boundaries also enforced by the serial commands.
+    for (const HEKeyConfig &key : config.heKeys)
+    {
+        if (!isValidBool(key.hidEnabled) || !isValidBool(key.rapidTrigger) || !isValidBool(key.continuousRapidTrigger) || !isValidBool(key.predictiveActuation))
+            return false;
+
+        if (key.rapidTriggerUpSensitivity < RAPID_TRIGGER_TOLERANCE || key.rapidTriggerUpSensitivity > TRAVEL_DISTANCE_IN_0_01MM)
+            return false;
+
+        if (key.rapidTriggerDownSensitivity < RAPID_TRIGGER_TOLERANCE || key.rapidTriggerDownSensitivity > TRAVEL_DISTANCE_IN_0_01MM)
+            return false;
+
+        if (key.upperHysteresis - key.lowerHysteresis < HYSTERESIS_TOLERANCE || TRAVEL_DISTANCE_IN_0_01MM - key.upperHysteresis < HYSTERESIS_TOLERANCE)
+            return false;
+
+        if ((uint8_t)key.filter >= (uint8_t)FilterType::Count || (uint8_t)key.analogCurve >= (uint8_t)AnalogCurveType::Count)
+            return false;
+
+        // The calibration has to be either unset or keep the minimum distance between the rest and down position.
+        if ((key.restPosition != 0 || key.downPosition != 0) &&
+            (key.restPosition >= 1 << ANALOG_RESOLUTION || key.restPosition - key.downPosition < SENSOR_BOUNDARY_MIN_DISTANCE * TRAVEL_DISTANCE_IN_0_01MM / 400))
+            return false;
+    }
+
+    // Check whether all values of the digital keys are valid.
+    for (const DigitalKeyConfig &key : config.digitalKeys)
+        if (!isValidBool(key.hidEnabled))
+            return false;
+
+    return true;
 }
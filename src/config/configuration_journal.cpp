@@ -0,0 +1,143 @@
+#include <Arduino.h>
+#include "config/configuration_journal.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/crc16.hpp"
+extern "C"
+{
+#include "hardware/flash.h"
+}
+
+// The boundaries of the flash region reserved for the filesystem, provided by the linker script. They are declared as arrays of unknown
+// size, as the compiler would otherwise assume that they are single bytes and flag all accesses beyond them as out of bounds.
+extern uint8_t _FS_start[];
+extern uint8_t _FS_end[];
+
+static_assert(FLASH_PAGE_SIZE == 256 && FLASH_SECTOR_SIZE == 4096, "The flash page or sector size does not match the journal.");
+
+bool ConfigurationJournal::load(Configuration &config)
+{
+    // The journal needs at least two sectors, as the newest record may never be erased while writing a new one.
+    const uint32_t slotCount = getSlotCount();
+    if (slotCount < 2 * slotsPerSector)
+        return false;
+
+    // Find the record with the highest sequence number below the limit by only looking at the headers, keeping the time spent at bootup low.
+    // If its checksum is invalid, e.g. because of a power loss while writing it, look for the next older record.
+    uint32_t limit = UINT32_MAX;
+    uint32_t highest = 0;
+    const RecordHeader *newest = nullptr;
+    uint32_t newestSlot = 0;
+    while (true)
+    {
+        newest = nullptr;
+        for (uint32_t slot = 0; slot < slotCount; slot++)
+        {
+            const RecordHeader *record = getRecord(slot);
+            if (record->magic == recordMagic && record->sequence < limit && (!newest || record->sequence > newest->sequence))
+            {
+                newest = record;
+                newestSlot = slot;
+            }
+        }
+
+        // If no valid record exists, start the journal at the first slot.
+        if (!newest)
+        {
+            nextSlot = 0;
+            nextSequence = highest + 1;
+            return false;
+        }
+
+        // Remember the highest sequence number of all records, which has to be exceeded by the next record to be written.
+        if (limit == UINT32_MAX)
+            highest = newest->sequence;
+
+        if (isValid(newest))
+            break;
+
+        limit = newest->sequence;
+    }
+
+    // Continue the journal right after the newest record and copy its configuration.
+    nextSlot = (newestSlot + 1) % slotCount;
+    nextSequence = highest + 1;
+    memcpy(&config, (const uint8_t *)newest + sizeof(RecordHeader), sizeof(Configuration));
+
+    return true;
+}
+
+bool ConfigurationJournal::append(const Configuration &config)
+{
+    const uint32_t slotCount = getSlotCount();
+    if (slotCount < 2 * slotsPerSector)
+        return false;
+
+    // If the next slot is not erased, e.g. because of a power loss while writing it, continue at the start of the next sector.
+    if (nextSlot % slotsPerSector != 0 && !isErased(nextSlot))
+        nextSlot = (nextSlot / slotsPerSector + 1) * slotsPerSector % slotCount;
+
+    // Build the record in RAM, as the flash cannot be read while being programmed. The rest of the slot stays erased.
+    uint8_t buffer[slotSize];
+    memset(buffer, 0xFF, sizeof(buffer));
+    RecordHeader header = {recordMagic, nextSequence, sizeof(Configuration), 0};
+    memcpy(buffer + sizeof(RecordHeader), &config, sizeof(Configuration));
+    header.checksum = CRC16::compute(buffer + sizeof(RecordHeader), sizeof(Configuration),
+                                     CRC16::compute((const uint8_t *)&header.sequence, sizeof(header.sequence) + sizeof(header.length)));
+    memcpy(buffer, &header, sizeof(RecordHeader));
+
+    // Get the offset of the slot in the flash. Records never span across sectors, so the sector has to be erased when entering it.
+    const uint32_t offset = (uint32_t)((uintptr_t)_FS_start - XIP_BASE) + nextSlot / slotsPerSector * sectorSize + nextSlot % slotsPerSector * slotSize;
+    const bool erase = nextSlot % slotsPerSector == 0;
+
+    // Erase and program the flash. Since the flash cannot be read during that, code may neither run from it on the other core nor in interrupts.
+    // The sampling of the ADC is paused beforehand, as its DMA channels would write past their buffers without their interrupt being handled.
+    ADCSampler.pause();
+    rp2040.idleOtherCore();
+    noInterrupts();
+    if (erase)
+        flash_range_erase(offset - offset % sectorSize, sectorSize);
+    flash_range_program(offset, buffer, slotSize);
+    interrupts();
+    rp2040.resumeOtherCore();
+    ADCSampler.resume();
+
+    // Verify the written record and move on to the next slot. On a failure, the next record is written to the next slot regardless.
+    const bool valid = isValid(getRecord(nextSlot));
+    nextSlot = (nextSlot + 1) % slotCount;
+    nextSequence++;
+
+    return valid;
+}
+
+const ConfigurationJournal::RecordHeader *ConfigurationJournal::getRecord(uint32_t slot) const
+{
+    // Return the record in the slot via the memory-mapped flash.
+    return (const RecordHeader *)(_FS_start + slot / slotsPerSector * sectorSize + slot % slotsPerSector * slotSize);
+}
+
+uint32_t ConfigurationJournal::getSlotCount() const
+{
+    // Calculate the amount of slots fitting into the whole sectors of the filesystem region.
+    return (_FS_end - _FS_start) / sectorSize * slotsPerSector;
+}
+
+bool ConfigurationJournal::isValid(const RecordHeader *record) const
+{
+    // Check whether the record has the magic number, contains a configuration of the correct size and the checksum matches.
+    if (record->magic != recordMagic || record->length != sizeof(Configuration))
+        return false;
+
+    const uint16_t checksum = CRC16::compute((const uint8_t *)&record->sequence, sizeof(record->sequence) + sizeof(record->length));
+    return record->checksum == CRC16::compute((const uint8_t *)record + sizeof(RecordHeader), sizeof(Configuration), checksum);
+}
+
+bool ConfigurationJournal::isErased(uint32_t slot) const
+{
+    // Check whether all bytes in the slot are erased, meaning the slot can be programmed.
+    const uint8_t *bytes = (const uint8_t *)getRecord(slot);
+    for (size_t i = 0; i < slotSize; i++)
+        if (bytes[i] != 0xFF)
+            return false;
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#include <Arduino.h>
+#include "handlers/analog_handler.hpp"
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+#ifdef USE_ANALOG_HID
+#include <Joystick.h>
+#include <tusb.h>
+#endif
+
+#ifdef USE_ANALOG_HID
+void AnalogHandler::begin()
+{
+    // Set up the gamepad interface with 10-bit axis values, only sending reports when requested.
+    Joystick.begin();
+    Joystick.use10bit();
+    Joystick.useManualSend(true);
+}
+
+void AnalogHandler::report(const uint16_t *distances, bool keyboardPending)
+{
+    // Limit the analog reports to the HID polling rate.
+    if (micros() - lastSentAt < 1000000 / HID_POLLING_RATE)
+        return;
+
+    // Map the distances of the keys to their axis values and check whether any of them changed by the threshold since the last report.
+    uint16_t values[axes];
+    bool changed = false;
+    for (uint8_t i = 0; i < axes; i++)
+    {
+        // Switch the curve of the key if another type of curve has been selected in the configuration.
+        const AnalogCurveType curveType = ConfigController.config.heKeys[i].analogCurve;
+        if (curves[i].getType() != curveType)
+            curves[i].setType(curveType);
+
+        values[i] = curves[i](distances[i]);
+
+        // Always report reaching either end of the axis, as those values might not change by the threshold.
+        const bool atEnd = (values[i] == 0 || values[i] == AnalogCurve::maxValue) && values[i] != sentValues[i];
+        if (atEnd || abs(values[i] - sentValues[i]) >= ANALOG_HID_CHANGE_THRESHOLD)
+            changed = true;
+    }
+
+    // The gamepad shares the HID endpoint with the keyboard, so the analog report is held back while a keyboard report is
+    // pending to never delay the key transitions. It is also held back if the HID interface is not ready to take a report.
+    if (!changed || keyboardPending || !tud_hid_ready())
+        return;
+
+    // Send all axis values in one report.
+    for (uint8_t i = 0; i < axes; i++)
+    {
+        setAxis(i, values[i]);
+        sentValues[i] = values[i];
+    }
+
+    Joystick.send_now();
+    lastSentAt = micros();
+    reportsSent++;
+}
+
+void AnalogHandler::setAxis(uint8_t axis, uint16_t value)
+{
+    // Assign the keys to the axes of the gamepad in order.
+    switch (axis)
+    {
+    case 0:
+        Joystick.X(value);
+        break;
+    case 1:
+        Joystick.Y(value);
+        break;
+    case 2:
+        Joystick.Z(value);
+        break;
+    case 3:
+        Joystick.Zrotate(value);
+        break;
+    case 4:
+        Joystick.sliderLeft(value);
+        break;
+    case 5:
+        Joystick.sliderRight(value);
+        break;
+    }
+}
+#endif
@@ -0,0 +1,203 @@
+#include <Arduino.h>
+#include "handlers/binary_handler.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/serial_writer.hpp"
+#include "definitions.hpp"
+
+// Reads a little-endian uint16 from the specified bytes.
+static uint16_t readUInt16(const uint8_t *data)
+{
+    return data[0] | data[1] << 8;
+}
+
+void BinaryHandler::handleFrame(const uint8_t *payload, uint16_t length)
+{
+    // Ignore empty payloads, as they do not contain a type that could be responded to.
+    if (length == 0)
+        return;
+
+    // Pass the data after the type byte to the handler of the request type.
+    const uint8_t *data = payload + 1;
+    length--;
+    switch (payload[0])
+    {
+    case schemaType:
+        schema(data, length);
+        break;
+    case readConfigType:
+        readConfig(data, length);
+        break;
+    case writeConfigType:
+        writeConfig(data, length);
+        break;
+    case readFieldsType:
+        readFields(data, length);
+        break;
+    case writeFieldsType:
+        writeFields(data, length);
+        break;
+    case saveType:
+        save(data, length);
+        break;
+    default:
+        beginResponse(payload[0], UnknownType);
+        sendResponse();
+        break;
+    }
+}
+
+void BinaryHandler::schema(const uint8_t *, uint16_t length)
+{
+    // Respond with the version and size of the configuration layout, as well as the amount of keys. The host
+    // device uses these to check whether it knows the layout before reading or writing fields by their offset.
+    beginResponse(schemaType, length == 0 ? Ok : Malformed);
+    if (length == 0)
+    {
+        const uint32_t version = Configuration::getVersion();
+        const uint16_t size = sizeof(Configuration);
+        const uint8_t schema[8] = {(uint8_t)version, (uint8_t)(version >> 8), (uint8_t)(version >> 16), (uint8_t)(version >> 24),
+                                   (uint8_t)size, (uint8_t)(size >> 8), HE_KEYS, DIGITAL_KEYS};
+        memcpy(response + responseLength, schema, sizeof(schema));
+        responseLength += sizeof(schema);
+    }
+    sendResponse();
+}
+
+void BinaryHandler::readConfig(const uint8_t *, uint16_t length)
+{
+    // Respond with the whole configuration.
+    beginResponse(readConfigType, length == 0 ? Ok : Malformed);
+    if (length == 0)
+    {
+        memcpy(response + responseLength, &ConfigController.config, sizeof(Configuration));
+        responseLength += sizeof(Configuration);
+    }
+    sendResponse();
+}
+
+void BinaryHandler::writeConfig(const uint8_t *data, uint16_t length)
+{
+    // The request has to contain exactly one whole configuration.
+    if (length != sizeof(Configuration))
+    {
+        beginResponse(writeConfigType, Malformed);
+        sendResponse();
+        return;
+    }
+
+    // Copy the configuration and only apply it if it is valid, which also requires the version to match.
+    Configuration config;
+    memcpy(&config, data, sizeof(Configuration));
+    const bool valid = ConfigController.validateConfig(config);
+    if (valid)
+    {
+        ConfigController.config = config;
+        KeyHandler.requestConfigSync();
+    }
+
+    beginResponse(writeConfigType, valid ? Ok : Invalid);
+    sendResponse();
+}
+
+void BinaryHandler::readFields(const uint8_t *data, uint16_t length)
+{
+    // The request contains the amount of fields, followed by the offset and length (uint16) of every field.
+    if (length == 0 || length != 1 + data[0] * 4)
+    {
+        beginResponse(readFieldsType, Malformed);
+        sendResponse();
+        return;
+    }
+
+    // Append the bytes of all fields to the response in the order they were requested.
+    beginResponse(readFieldsType, Ok);
+    for (uint8_t i = 0; i < data[0]; i++)
+    {
+        const uint16_t offset = readUInt16(data + 1 + i * 4);
+        const uint16_t size = readUInt16(data + 3 + i * 4);
+
+        // Check whether the field is within the configuration and fits into the response.
+        if (offset + size > sizeof(Configuration) || responseLength + size > sizeof(response))
+        {
+            beginResponse(readFieldsType, OutOfRange);
+            break;
+        }
+
+        memcpy(response + responseLength, (const uint8_t *)&ConfigController.config + offset, size);
+        responseLength += size;
+    }
+    sendResponse();
+}
+
+void BinaryHandler::writeFields(const uint8_t *data, uint16_t length)
+{
+    // The request contains the amount of fields, followed by the offset and length (uint16) and the bytes of every field.
+    // All fields are written into a copy of the configuration, which is only applied if the request is well-formed and valid.
+    Configuration config = ConfigController.config;
+    Status status = length == 0 ? Malformed : Ok;
+    uint16_t position = 1;
+    for (uint8_t i = 0; status == Ok && i < data[0]; i++)
+    {
+        // Check whether the header of the field is within the request.
+        if (position + 4 > length)
+        {
+            status = Malformed;
+            break;
+        }
+
+        const uint16_t offset = readUInt16(data + position);
+        const uint16_t size = readUInt16(data + position + 2);
+        position += 4;
+
+        // Check whether the bytes of the field are within the request and the field is within the configuration.
+        if (position + size > length)
+            status = Malformed;
+        else if (offset + size > sizeof(Configuration))
+            status = OutOfRange;
+        else
+            memcpy((uint8_t *)&config + offset, data + position, size);
+
+        position += size;
+    }
+
+    // Make sure there is no trailing data, which would hint at the host device using a different layout of the request.
+    if (status == Ok && position != length)
+        status = Malformed;
+
+    // Validate the resulting configuration. Since the version is validated as well, writes to it are rejected.
+    if (status == Ok && !ConfigController.validateConfig(config))
+        status = Invalid;
+
+    if (status == Ok)
+    {
+        ConfigController.config = config;
+        KeyHandler.requestConfigSync();
+    }
+
+    beginResponse(writeFieldsType, status);
+    sendResponse();
+}
+
+void BinaryHandler::save(const uint8_t *, uint16_t length)
+{
+    // Save the configuration managed by the config controller.
+    if (length == 0)
+        ConfigController.saveConfig();
+
+    beginResponse(saveType, length == 0 ? Ok : Malformed);
+    sendResponse();
+}
+
+void BinaryHandler::beginResponse(uint8_t type, Status status)
+{
+    // Start the response with the type of the request with bit 7 set and the status.
+    response[0] = type | 0x80;
+    response[1] = status;
+    responseLength = 2;
+}
+
+void BinaryHandler::sendResponse()
+{
+    // Queue the response into the serial output. If it does not fit, the host device has to repeat the request.
+    SerialWriter.writeFrame(response, responseLength);
+}
@@ -1,9 +1,21 @@
 #include <Arduino.h>
-#include <Keyboard.h>
+#include <tusb.h>
+#include <RP2040USB.h>
+#include <USB.h>
+#include <CoreMutex.h>
 #include "handlers/key_handler.hpp"
 #include "handlers/serial_handler.hpp"
+#include "handlers/telemetry_handler.hpp"
+#include "handlers/trace_handler.hpp"
 #include "helpers/string_helper.hpp"
+#include "helpers/hid_usage.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/profiler.hpp"
 #include "definitions.hpp"
+extern "C"
+{
+#include "hardware/structs/usb.h"
+}
 
 /*
    Explanation of the Rapid Trigger Logic
@@ -45,7 +57,7 @@
    Workflow of the Rapid Trigger code:
 
    The Rapid Trigger implementation in this firmware consists of 4 steps.
-   Step 1: Check whether the key left the Rapid Trigger zone (normal) or was fully released (CRT mode)
+   Step 1: Check whether the key left the Rapid Trigger zone (normal) or was fully released (CRT mode), using the resolved reset distance
    Step 2: Check whether the key has entered the Rapid Trigger zone, updating the inRapidTriggerZone state and pressing the key
    Step 3: Apply the dynamic travel distance checks, the core of the Rapid Trigger feature
    Step 4: Depending on whether the key is pressed or not, remember the lowest/highest peak achieved
@@ -53,39 +65,277 @@
 
 void KeyHandler::handle()
 {
-    // Go through all Hall Effect keys and run the checks.
-    for (HEKey &key : heKeys)
+    // Scan all keys once the scan timer started the next scan, and send the resulting key transitions via the HID interface right after.
+    if (ScanTimer.poll())
+    {
+        scan();
+        ScanTimer.finish();
+    }
+
+    report();
+}
+
+void KeyHandler::scan()
+{
+    // Copy the configuration into the key states if it has changed since the last scan.
+    if (configChanged.exchange(false))
+        syncConfig();
+
+    // Run the Hall Effect keys through the key pipeline.
+    scanHEKeys();
+
+    // Read the levels of all digital keys at once and go through all digital keys to run the checks.
+    {
+        ProfilerScope scope(ProfilerStage::Digital);
+        const uint32_t levels = DigitalSampler.read();
+        const uint32_t now = micros();
+        for (DigitalKey &key : digitalKeys)
+        {
+            // Scan the digital key to update the pin status.
+            scanDigitalKey(key, levels, now);
+
+            // Run the checks on the digital key. The resulting transitions are timestamped with the last edge on the pin, which is the
+            // time the key was physically pressed or released at, as taken by the interrupt, instead of the time of the scan noticing it.
+            sampledAt = key.lastEdge;
+            checkDigitalKey(key, now);
+        }
+    }
+
+    // Capture the values of the Hall Effect keys for the telemetry stream.
+    TelemetryHandler.capture(heKeyStates, heKeys);
+
+#ifdef USE_PROFILER
+    // Take the snapshot of the profiler measurements if it has been requested, as they are recorded on this core.
+    Profiler.update();
+#endif
+}
+
+void KeyHandler::scanHEKeys()
+{
+    // The Hall Effect keys are processed in batched passes, with every pass going through all keys before the next one starts.
+    // PASS 1: Read the sensor values of all Hall Effect keys at once. If no values are available yet, as the sampler has not completed
+    // its first frame since bootup, the keys are left untouched until the next scan instead of being processed with invalid values.
+    {
+        ProfilerScope scope(ProfilerStage::Sample);
+        // Remember the time the values were sampled at, from which the latency of the resulting key transitions is measured.
+        if (!ADCSampler.read(heKeyStates.adcValues, sampledAt))
+            return;
+    }
+
+#ifdef USE_TRACE
+    // Record the sensor values into the trace if it is being recorded.
+    TraceHandler.capture(sampledAt, heKeyStates.adcValues);
+#endif
+
+    // PASS 2: Run the sensor values through the filters and update the calibration.
+    filterHEKeys();
+
+    // PASS 3: Map the filtered values to the distances.
+    mapHEKeys();
+
+    // PASS 4: Track the velocity and acceleration of the keys for predictive actuation.
+    trackHEKeys();
+
+    // PASS 5: Run the actuation checks selected for the actuation mode of each Hall Effect key.
+    {
+        ProfilerScope scope(ProfilerStage::Check);
+        for (HEKey &key : heKeys)
+        {
+            ProfilerScope keyScope(ProfilerStage::Check, key.index);
+            (this->*heKeyChecks[key.index])(key);
+        }
+    }
+}
+
+void KeyHandler::begin()
+{
+    // Register the NKRO report on the HID interface next to the boot protocol keyboard of the Keyboard library. The USB device
+    // is disconnected while registering it, so the host device reads the report descriptor containing it when reconnecting.
+    USB.disconnect();
+    nkroDevice = USB.registerHIDDevice(KeyboardReport::nkroDescriptor, sizeof(KeyboardReport::nkroDescriptor), 11, 0x0001);
+    USB.connect();
+}
+
+void KeyHandler::report()
+{
+    // Track the USB frames through the number of the frame of the last received SOF packet. This happens before applying the queued
+    // key transitions, so transitions arriving together with a new frame count towards that frame instead of having missed the previous one.
+    reportScheduler.onFrame(usb_hw->sof_rd & USB_SOF_RD_BITS, micros());
+
+    // Apply all queued key transitions to the keyboard report, marking the report as changed if a usage or modifier has been
+    // pressed or released. Transitions not affecting the report (e.g. two keys with the same usage) are not sent.
+    KeyEvent event;
+    while (keyEvents.pop(event))
     {
-        // Scan the Hall Effect key to update the sensor and distance value.
-        scanHEKey(key);
+        const bool changed = event.pressed ? keyboardReport.press(event.usage, event.modifiers) : keyboardReport.release(event.usage, event.modifiers);
+        if (changed)
+        {
+            reportScheduler.onChange();
+            latencyTracker.onChange(event.key, event.timestamp);
+        }
+    }
+
+    // If the host device switched between the boot and the report protocol, send the current state in the format of the new protocol.
+    const bool boot = tud_hid_get_protocol() == HID_PROTOCOL_BOOT;
+    if (boot != bootProtocol)
+    {
+        bootProtocol = boot;
+        reportScheduler.onChange();
+    }
 
-        // Run the checks on the HE key.
-        checkHEKey(key);
+    // Send the key report via the HID interface once it is due. If the HID interface is not ready to take another
+    // report yet, the report stays pending instead of being dropped, and is sent as soon as the interface is ready.
+    if (reportScheduler.isDue(micros()) && tud_hid_ready())
+    {
+        ProfilerScope scope(ProfilerStage::Report);
+
+        // With the report protocol, send the whole bitmap as the NKRO report. Otherwise, convert the keyboard report into the report
+        // format of the keyboard interface set up by the Keyboard library, which is the boot protocol one. The USB mutex is held to
+        // not interfere with other USB devices sending on the other core.
+        if (!boot)
+        {
+            uint8_t report[KeyboardReport::nkroReportSize];
+            keyboardReport.toNKROReport(report);
+            CoreMutex m(&__usb_mutex);
+            tud_hid_report(USB.findHIDReportID(nkroDevice), report, sizeof(report));
+        }
+        else
+        {
+            uint8_t modifiers;
+            uint8_t keys[6];
+            keyboardReport.toBootReport(modifiers, keys);
+            CoreMutex m(&__usb_mutex);
+            tud_hid_keyboard_report(__USBGetKeyboardReportID(), modifiers, keys);
+        }
+
+        reportScheduler.onSent();
+        latencyTracker.onSent(micros());
     }
+}
+
+void KeyHandler::requestConfigSync()
+{
+    // Signal the scanning code to copy the configuration into the key states before the next scan.
+    configChanged = true;
+}
 
-    // Go through all digital keys and run the checks.
+void KeyHandler::syncConfig()
+{
+    // Copy the settings accessed on every scan from the configuration of every Hall Effect key into the key states.
+    for (HEKey &key : heKeys)
+    {
+        const uint8_t i = key.index;
+        heKeyStates.lowerHysteresis[i] = key.config->lowerHysteresis;
+        heKeyStates.upperHysteresis[i] = key.config->upperHysteresis;
+        heKeyStates.rapidTriggerUpSensitivity[i] = key.config->rapidTriggerUpSensitivity;
+        heKeyStates.rapidTriggerDownSensitivity[i] = key.config->rapidTriggerDownSensitivity;
+        heKeyStates.predictiveActuation[i] = key.config->predictiveActuation;
+
+        // Resolve the distance at which the key leaves the rapid trigger zone. With continuous rapid trigger, that is only the case when the key
+        // is fully released (<0.1mm), otherwise once it is above the upper hysteresis. This way, both modes share the same rapid trigger check.
+        heKeyStates.rapidTriggerResetDistances[i] = key.config->continuousRapidTrigger ? TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD
+                                                                                     : key.config->upperHysteresis;
+
+        // Select the actuation check for the mode of the key. Since this happens at the start of a scan, the mode never changes mid-scan.
+        heKeyChecks[i] = key.config->rapidTrigger ? &KeyHandler::checkRapidTrigger : &KeyHandler::checkTraditional;
+
+        // Switch the filter of the key if another type of filter has been selected in the configuration.
+        if (key.filter.getType() != key.config->filter)
+            key.filter.setType(key.config->filter);
+
+        // Resolve the HID usage of the key. If that fails, the synchronization is requested again for the next scan.
+        if (!syncUsage(key))
+            configChanged = true;
+    }
+
+    // Resolve the HID usage of all digital keys.
     for (DigitalKey &key : digitalKeys)
+        if (!syncUsage(key))
+            configChanged = true;
+}
+
+bool KeyHandler::syncUsage(Key &key)
+{
+    // Resolve the HID usage and the required modifiers from the key char once here, instead of on every key transition.
+    const HIDUsage::KeyCode keyCode = HIDUsage::fromKeyChar(key.config->keyChar);
+    if (keyCode.usage == key.usage && keyCode.modifiers == key.modifiers)
+        return true;
+
+    // If the key is pressed while its usage changes, release the old usage and modifiers so they do not get stuck. The key is then
+    // pressed again with the new usage on the next scan. If the queue is full, the usage is kept and retried later.
+    if (key.pressed)
     {
-        // Scan the digital key to update the pin status.
-        scanDigitalKey(key);
+        const uint32_t now = micros();
+        if (!keyEvents.push({key.usage, key.modifiers, false, key.id, now}))
+            return false;
 
-        // Run the checks on the digital key.
-        checkDigitalKey(key);
+        key.pressed = false;
     }
 
-    // Send the key report via the HID interface after updating the report.
-    Keyboard.sendReport();
+    key.usage = keyCode.usage;
+    key.modifiers = keyCode.modifiers;
+    return true;
+}
+
+bool KeyHandler::isIdle() const
+{
+    // Check whether any key is currently pressed.
+    for (const HEKey &key : heKeys)
+        if (key.pressed)
+            return false;
+
+    for (const DigitalKey &key : digitalKeys)
+        if (key.pressed)
+            return false;
+
+    return true;
+}
+
+void KeyHandler::storeCalibration()
+{
+    // Pass the boundaries of all calibrated keys to the config controller, which saves them once they changed considerably.
+    for (const HEKey &key : heKeys)
+        if (key.calibrated)
+            ConfigController.storeCalibration(key.index, key.restPosition, key.downPosition);
+}
+
+void KeyHandler::restoreCalibration(HEKey &key, uint16_t value)
+{
+    // Only attempt to restore the calibration once, and only if a calibration has been saved for the key.
+    key.calibrationRestoreAttempted = true;
+    if (key.config->restPosition == 0 && key.config->downPosition == 0)
+        return;
+
+    // Check whether the sensor reading matches the saved rest position, which has the deadzone applied. If the reading is off,
+    // the key might be held down or the hardware changed, in which case the key is calibrated from scratch instead.
+    uint16_t restValue = value;
+#ifdef INVERT_SENSOR_READINGS
+    restValue = (1 << ANALOG_RESOLUTION) - 1 - value;
+#endif
+    if (abs(restValue - (key.config->restPosition + SENSOR_BOUNDARY_DEADZONE)) > CALIBRATION_RESTORE_TOLERANCE)
+        return;
+
+    // Prime the filter with the reading so it does not have to settle first, and restore the boundaries.
+    // From here on, the key is calibrated and the boundaries keep being updated as usual.
+    key.filter.reset(value);
+    key.restPosition = key.config->restPosition;
+    key.downPosition = key.config->downPosition;
+    key.calibrated = true;
+    updateDistanceScaling(key);
 }
 
-void KeyHandler::updateSensorBoundaries(HEKey &key)
+void KeyHandler::updateSensorBoundaries(HEKey &key, uint16_t rawValue)
 {
     // Calculate the value with the deadzone in the positive and negative direction applied.
-    uint16_t upperValue = key.rawValue - SENSOR_BOUNDARY_DEADZONE;
-    uint16_t lowerValue = key.rawValue + SENSOR_BOUNDARY_DEADZONE;
+    uint16_t upperValue = rawValue - SENSOR_BOUNDARY_DEADZONE;
+    uint16_t lowerValue = rawValue + SENSOR_BOUNDARY_DEADZONE;
 
     // If the read value with deadzone applied is bigger than the current rest position, update it.
     if (key.restPosition < upperValue)
+    {
         key.restPosition = upperValue;
+        updateDistanceScaling(key);
+    }
 
     // If the read value with deadzone applied is lower than the current down position, update it. Make sure that the distance to the rest position
     // is at least SENSOR_BOUNDARY_MIN_DISTANCE (scaled with travel distance @ 4.00mm) to prevent poor calibration/analog range resulting in "crazy behaviour".
@@ -96,126 +346,238 @@ void KeyHandler::updateSensorBoundaries(HEKey &key)
         key.calibrated = true;
 
         key.downPosition = lowerValue;
+        updateDistanceScaling(key);
     }
 }
 
-void KeyHandler::scanHEKey(HEKey &key)
+void KeyHandler::updateDistanceScaling(HEKey &key)
 {
-    // Read the value from the port of the specified key and run it through the SMA filter.
-    key.rawValue = key.filter(analogRead(HE_PIN(key.index)));
+#ifdef USE_GAUSS_CORRECTION_LUT
+
+    // Cache the offset of the sensor readings to the LUT indices, determined by the rest position of the key, and the distance of the down position.
+    key.lutOffset = gaussLUT.getOffset(key.restPosition);
+    key.downDistance = gaussLUT.lookup(key.downPosition + key.lutOffset);
+
+    // Cache the fixed-point reciprocal for stretching distances to the full travel distance, avoiding a division on every scan.
+    // It is rounded up, which guarantees the same results as the division for all distances below the down position's distance.
+    if (key.downDistance > 0)
+        key.distanceScale = ((TRAVEL_DISTANCE_IN_0_01MM << distanceScaleShift) + key.downDistance - 1) / key.downDistance;
 
-    // Invert the value if the definition is set since in rare fields of application the sensor
-    // is mounted the other way around, resulting in a different polarity and inverted sensor readings.
-    // Since this firmware expects the value to go down when the button is pressed down, this is needed.
+#endif
+}
+
+void KeyHandler::filterHEKeys()
+{
+    // Measure the time of the pass, and of every key separately, if profiling is enabled.
+    ProfilerScope scope(ProfilerStage::Filter);
+    for (HEKey &key : heKeys)
+    {
+        const uint8_t i = key.index;
+        ProfilerScope keyScope(ProfilerStage::Filter, i);
+
+        // On the first scan with sensor values, restore the saved calibration of the key, making it usable right away. Since the keys are only
+        // processed once the sampler completed its first frame, the calibration is always checked against an actual reading of the sensor.
+        if (!key.calibrationRestoreAttempted)
+            restoreCalibration(key, heKeyStates.adcValues[i]);
+
+        // Run the value read from the sensor of the key through the filter.
+        uint16_t rawValue = key.filter(heKeyStates.adcValues[i]);
+
+        // Invert the value if the definition is set since in rare fields of application the sensor
+        // is mounted the other way around, resulting in a different polarity and inverted sensor readings.
+        // Since this firmware expects the value to go down when the button is pressed down, this is needed.
 #ifdef INVERT_SENSOR_READINGS
-    key.rawValue = (1 << ANALOG_RESOLUTION) - 1 - key.rawValue;
+        rawValue = (1 << ANALOG_RESOLUTION) - 1 - rawValue;
 #endif
 
-    // If the SMA filter is fully initalized (at least one full circular buffering has been performed), calibration can be performed.
-    // This keeps track of the lowest and highest value reached on each key, giving us boundaries to map to an actual milimeter distance.
-    if (key.filter.initialized)
-        updateSensorBoundaries(key);
+        heKeyStates.rawValues[i] = rawValue;
 
-    // Make sure that the key is calibrated, which means that the down position (default 4095) was updated to be  smaller than the rest position.
-    // If that's not the case, we go with the total switch travel distance representing a key that is fully up, effectively disabling any value processing.
-    // This if-branch is inheritly triggered if the SMA filter is not initialized yet, as the default down position of 4095 was not updated yet.
-    if(!key.calibrated)
-    {
-        key.distance = TRAVEL_DISTANCE_IN_0_01MM;
-        return;
+        // If the filter is fully initalized (enough values have been passed through to be stable), calibration can be performed.
+        // This keeps track of the lowest and highest value reached on each key, giving us boundaries to map to an actual milimeter distance.
+        if (key.filter.initialized)
+            updateSensorBoundaries(key, rawValue);
     }
+}
+
+void KeyHandler::mapHEKeys()
+{
+    // Measure the time of the pass, and of every key separately, if profiling is enabled.
+    ProfilerScope scope(ProfilerStage::Map);
+    for (const HEKey &key : heKeys)
+    {
+        const uint8_t i = key.index;
+        ProfilerScope keyScope(ProfilerStage::Map, i);
+
+        // Make sure that the key is calibrated, which means that the down position (default 4095) was updated to be  smaller than the rest position.
+        // If that's not the case, we go with the total switch travel distance representing a key that is fully up, effectively disabling any value processing.
+        // This if-branch is inheritly triggered if the filter is not initialized yet, as the default down position of 4095 was not updated yet.
+        if (!key.calibrated)
+        {
+            heKeyStates.distances[i] = TRAVEL_DISTANCE_IN_0_01MM;
+            continue;
+        }
 
 #ifdef USE_GAUSS_CORRECTION_LUT
 
-    // If gauss correction is enabled, use the GaussLUT instance to get the distance based on the adc value and the rest position
-    // of the key, which is used to determine the offset from the "ideal" rest position set by the lookup table calculations.
-    uint16_t distance = gaussLUT.adcToDistance(key.rawValue, key.restPosition);
+        // If gauss correction is enabled, use the GaussLUT instance to get the distance based on the adc value and the cached offset
+        // of the key, which is the offset of the rest position from the "ideal" rest position set by the lookup table calculations.
+        const uint16_t distance = gaussLUT.lookup(heKeyStates.rawValues[i] + key.lutOffset);
 
-    // Stretch the value to the full travel distance using our down position since the LUT is rest-position based. Then invert and constrain it.
-    distance = distance * TRAVEL_DISTANCE_IN_0_01MM / gaussLUT.adcToDistance(key.downPosition, key.restPosition);
-    key.distance = constrain(TRAVEL_DISTANCE_IN_0_01MM - distance, 0, TRAVEL_DISTANCE_IN_0_01MM);
+        // Stretch the value to the full travel distance using the cached scale of the down position since the LUT is rest-position based,
+        // then invert it. Distances at or beyond the one of the down position are considered fully pressed, which also prevents overflows.
+        if (distance >= key.downDistance)
+            heKeyStates.distances[i] = 0;
+        else
+            heKeyStates.distances[i] = TRAVEL_DISTANCE_IN_0_01MM - ((distance * key.distanceScale) >> distanceScaleShift);
 
 #else
 
-    // Map the value with the down and rest position values to a range between 0 and TRAVEL_DISTANCE_IN_0_01MM and constrain it.
-    // This is done to guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
-    // NOTE: This calcuation disregards the non-linear nature of the relation between a magnet's distance and it's magnetic field strength.
-    //       This firmware has a gauss correction, which can be enabled and adjusted to match the hardware specifications of the device.
-    return constrain(map(value, key.downPosition, key.restPosition, 0, TRAVEL_DISTANCE_IN_0_01MM), 0, TRAVEL_DISTANCE_IN_0_01MM);
+        // Map the value with the down and rest position values to a range between 0 and TRAVEL_DISTANCE_IN_0_01MM and constrain it.
+        // This is done to guarantee that the unit for the numbers used across the firmware actually matches the milimeter metric.
+        // NOTE: This calcuation disregards the non-linear nature of the relation between a magnet's distance and it's magnetic field strength.
+        //       This firmware has a gauss correction, which can be enabled and adjusted to match the hardware specifications of the device.
+        heKeyStates.distances[i] = constrain(map(heKeyStates.rawValues[i], key.downPosition, key.restPosition, 0, TRAVEL_DISTANCE_IN_0_01MM), 0, TRAVEL_DISTANCE_IN_0_01MM);
 
 #endif
+    }
 }
 
-void KeyHandler::scanDigitalKey(DigitalKey &key)
+void KeyHandler::trackHEKeys()
 {
-    // Read the digital key and consider it pressed if the pin status is LOW (because of PULLUP).
-    key.pressed = digitalRead(DIGITAL_PIN(key.index)) == PinStatus::LOW;
+    // Measure the time of the pass if profiling is enabled.
+    ProfilerScope scope(ProfilerStage::Track);
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        // Get the change of the distance since the last scan as the current velocity, in fixed-point.
+        const int32_t velocity = ((int32_t)heKeyStates.distances[i] - heKeyStates.previousDistances[i]) * (1 << motionShift);
+        heKeyStates.previousDistances[i] = heKeyStates.distances[i];
+
+        // Smooth the velocity and the change of it (the acceleration) with an exponential moving average, suppressing the noise of the sensors.
+        const int32_t previousVelocity = heKeyStates.velocities[i];
+        heKeyStates.velocities[i] += (velocity - previousVelocity) >> PREDICTIVE_ACTUATION_SMOOTHING_EXPONENT;
+        heKeyStates.accelerations[i] += (heKeyStates.velocities[i] - previousVelocity - heKeyStates.accelerations[i]) >> PREDICTIVE_ACTUATION_SMOOTHING_EXPONENT;
+    }
 }
 
-void KeyHandler::checkHEKey(HEKey &key)
+int32_t KeyHandler::predictDistance(uint8_t index) const
 {
-    // If the key is in traditional mode, do the usual hysteresis checks.
-    if (!key.config->rapidTrigger)
-    {
-        // Check whether the value passes the lower or upper hysteresis.
-        // If the value drops <= the lower hysteresis, the key is pressed down.
-        // If the value rises >= the upper hysteresis, the key is released.
-        if (key.distance <= key.config->lowerHysteresis)
-            setPressedState(key, true);
-        else if (key.distance >= key.config->upperHysteresis)
-            setPressedState(key, false);
+    // Without predictive actuation, the prediction is the current distance, which makes the checks behave as without it.
+    const uint16_t distance = heKeyStates.distances[index];
+    if (!heKeyStates.predictiveActuation[index])
+        return distance;
+
+    // Only predict the movement if the key moves fast enough and is not slowing down, meaning it is committed to the movement.
+    const int32_t velocity = heKeyStates.velocities[index];
+    const int32_t acceleration = heKeyStates.accelerations[index];
+    constexpr int32_t minVelocity = PREDICTIVE_ACTUATION_MIN_VELOCITY << motionShift;
+    const bool committedDown = velocity <= -minVelocity && acceleration <= 0;
+    const bool committedUp = velocity >= minVelocity && acceleration >= 0;
+    if (!committedDown && !committedUp)
+        return distance;
+
+    // Extrapolate the distance at the next scan from the velocity and acceleration.
+    return distance + ((velocity + acceleration / 2) >> motionShift);
+}
 
-        // Return here to not run into the rapid trigger code.
-        return;
-    }
+void KeyHandler::scanDigitalKey(DigitalKey &key, uint32_t levels, uint32_t now)
+{
+    // Consider the digital key pressed if the pin status is LOW (because of PULLUP).
+    const bool pressed = !(levels & DigitalSampler.getPinMask(key.index));
 
-    // RT STEP 1: Reset the rapid trigger state if the value left the rapid trigger zone (normal) or was fully released (CRT).
-    // If the value is above the upper hysteresis the value is not (anymore) inside the rapid trigger zone
-    // meaning the rapid trigger state for the key has to be set to false in order to be processed by further checks.
-    // This only applies if continuous rapid trigger is not enabled as it only resets the state when the key is fully released.
-    if (key.distance >= key.config->upperHysteresis && !key.config->continuousRapidTrigger)
-        key.inRapidTriggerZone = false;
-    // If continuous rapid trigger is enabled, the state is only reset to false when the key is fully released (<0.1mm).
-    else if (key.distance >= TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD && key.config->continuousRapidTrigger)
-        key.inRapidTriggerZone = false;
+    // Take the time of the last edge on the pin from the interrupt. If the level changed without the interrupt having timestamped
+    // the edge yet, fall back to the time of the scan. The time only ever moves forward, so a release can never be brought forward.
+    uint32_t lastEdge = DigitalSampler.getLastEdge(key.index);
+    if (pressed != key.pressed && (int32_t)(lastEdge - key.lastEdge) <= 0)
+        lastEdge = now;
+    if ((int32_t)(lastEdge - key.lastEdge) > 0)
+        key.lastEdge = lastEdge;
+
+    key.pressed = pressed;
+}
+
+void KeyHandler::checkTraditional(HEKey &key)
+{
+    // Check whether the value passes the lower or upper hysteresis.
+    // If the value drops <= the lower hysteresis, the key is pressed down.
+    // If the value rises >= the upper hysteresis, the key is released.
+    const uint8_t i = key.index;
+    if (heKeyStates.distances[i] <= heKeyStates.lowerHysteresis[i])
+        setPressedState(key, true);
+    else if (heKeyStates.distances[i] >= heKeyStates.upperHysteresis[i])
+        setPressedState(key, false);
+}
 
+void KeyHandler::checkRapidTrigger(HEKey &key)
+{
+    // Get the state of the key from the key states.
+    const uint8_t i = key.index;
+    const uint16_t distance = heKeyStates.distances[i];
+    uint16_t &rapidTriggerPeak = heKeyStates.rapidTriggerPeaks[i];
+    bool &inRapidTriggerZone = heKeyStates.inRapidTriggerZone[i];
+
+    // RT STEP 1: Reset the rapid trigger state if the value left the rapid trigger zone (normal) or was fully released (CRT).
+    // If the value is above the reset distance the value is not (anymore) inside the rapid trigger zone meaning the rapid trigger
+    // state for the key has to be set to false in order to be processed by further checks. The reset distance is the upper hysteresis,
+    // or the threshold of a fully released key (<0.1mm) if continuous rapid trigger is enabled.
+    if (distance >= heKeyStates.rapidTriggerResetDistances[i])
+        inRapidTriggerZone = false;
     // RT STEP 2: If the value entered the rapid trigger zone, perform a press and set the rapid trigger state to true.
     // If the value is below the lower hysteresis and the rapid trigger state is false on the key, press the key because the action of entering
     // the rapid trigger zone is already counted as a trigger. From there on, the actuation point moves dynamically in that zone.
     // Also the rapid trigger state for the key has to be set to true in order to be processed by furture loops.
-    if (key.distance <= key.config->lowerHysteresis && !key.inRapidTriggerZone)
+    if (distance <= heKeyStates.lowerHysteresis[i] && !inRapidTriggerZone)
     {
         setPressedState(key, true);
-        key.inRapidTriggerZone = true;
+        inRapidTriggerZone = true;
     }
 
     // RT STEP 3: If the key *already is* in the rapid trigger zone (hence the 'else if'), check whether the key has travelled the sufficient amount.
     // Check whether the key should be pressed. This is the case if the key is currently not pressed,
     // the rapid trigger state is true and the value drops more than (down sensitivity) below the highest recorded value.
-    else if (!key.pressed && key.inRapidTriggerZone && key.distance + key.config->rapidTriggerDownSensitivity <= key.rapidTriggerPeak)
-        setPressedState(key, true);
+    // With predictive actuation, this is also the case if the value is predicted to do so on the next scan and has
+    // dropped by at least half of the sensitivity already. The same applies for releases with the up sensitivity.
+    else if (!key.pressed && inRapidTriggerZone)
+    {
+        const uint16_t sensitivity = heKeyStates.rapidTriggerDownSensitivity[i];
+        if (distance + sensitivity <= rapidTriggerPeak)
+            setPressedState(key, true);
+        else if (distance + sensitivity / 2 <= rapidTriggerPeak && predictDistance(i) + sensitivity <= rapidTriggerPeak)
+        {
+            setPressedState(key, true);
+            if (key.pressed)
+                predictedTransitions++;
+        }
+    }
     // Check whether the key should be released. This is the case if the key is currently pressed down and either the
     // rapid trigger state is no longer true or the value rises more than (up sensitivity) above the lowest recorded value.
-    else if (key.pressed && (!key.inRapidTriggerZone || key.distance >= key.rapidTriggerPeak + key.config->rapidTriggerUpSensitivity))
-        setPressedState(key, false);
+    else if (key.pressed)
+    {
+        const uint16_t sensitivity = heKeyStates.rapidTriggerUpSensitivity[i];
+        if (!inRapidTriggerZone || distance >= rapidTriggerPeak + sensitivity)
+            setPressedState(key, false);
+        else if (distance >= rapidTriggerPeak + sensitivity / 2 && predictDistance(i) >= rapidTriggerPeak + sensitivity)
+        {
+            setPressedState(key, false);
+            if (!key.pressed)
+                predictedTransitions++;
+        }
+    }
 
     // RT STEP 4: Always remember the peaks of the values, depending on the current pressed state.
     // If the key is pressed and at an all-time low or not pressed and at an all-time high, save the value.
-    if ((key.pressed && key.distance < key.rapidTriggerPeak) || (!key.pressed && key.distance > key.rapidTriggerPeak))
-        key.rapidTriggerPeak = key.distance;
+    if ((key.pressed && distance < rapidTriggerPeak) || (!key.pressed && distance > rapidTriggerPeak))
+        rapidTriggerPeak = distance;
 }
 
-void KeyHandler::checkDigitalKey(DigitalKey &key)
+void KeyHandler::checkDigitalKey(DigitalKey &key, uint32_t now)
 {
-    // Check whether the key is pressed and debounced.
-    if (key.pressed && millis() - key.lastDebounce >= DIGITAL_DEBOUNCE_DELAY)
-    {
-        // Set the key to pressed and update the last debounce time.
+    // Press the key as soon as the pin reads pressed, without waiting for the signal to settle. Bounces only happen after the contacts
+    // have touched, so the first edge is always a genuine press and the bounces following it are covered by the deferred release.
+    if (key.pressed)
         setPressedState(key, true);
-        key.lastDebounce = millis();
-    }
-    // If the key is not pressed, just set it to unpressed.
-    else if (!key.pressed)
+    // Only release the key once the pin has not changed for the debounce time, so neither the bounces after pressing
+    // nor the ones after releasing the key cause additional transitions.
+    else if (now - key.lastEdge >= DIGITAL_DEBOUNCE_TIME)
         setPressedState(key, false);
 }
 
@@ -226,11 +588,10 @@ void KeyHandler::setPressedState(Key &key, bool pressed)
     if (key.pressed == pressed || (!key.config->hidEnabled && pressed))
         return;
 
-    // Send the HID instruction to the computer.
-    if (pressed)
-        Keyboard.press(key.config->keyChar);
-    else
-        Keyboard.release(key.config->keyChar);
+    // Queue the HID instruction for the computer. If the queue is full, the pressed state is not
+    // updated, causing the transition to be detected and queued again on the next scan.
+    if (!keyEvents.push({key.usage, key.modifiers, pressed, key.id, sampledAt}))
+        return;
 
     // Update the pressed value state.
     key.pressed = pressed;
@@ -2,170 +2,194 @@
 #include "handlers/keys/he_key.hpp"
 #include "handlers/serial_handler.hpp"
 #include "handlers/key_handler.hpp"
+#include "handlers/analog_handler.hpp"
+#include "handlers/telemetry_handler.hpp"
+#include "handlers/trace_handler.hpp"
 #include "helpers/string_helper.hpp"
+#include "helpers/serial_writer.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/profiler.hpp"
 #include "definitions.hpp"
 extern "C"
 {
 #include "pico/bootrom.h"
 }
 
-// Define a handy macro for printing with a newline character at the end.
-#define print(fmt, ...) Serial.printf(fmt "\n", __VA_ARGS__)
-
-// Define two more handy macros for interpreting the serial input.
-#define isEqual(str1, str2) strcmp(str1, str2) == 0
-#define isTrue(str) isEqual(str, "1") || isEqual(str, "true")
+// Define a handy macro for printing with a newline character at the end. The output is buffered to never block.
+#define print(fmt, ...) SerialWriter.printf(fmt "\n", __VA_ARGS__)
+
+// The table of all global commands.
+const SerialHandler::Command<SerialHandler::GlobalCommandHandler> SerialHandler::globalCommands[] = {
+    {"boot", &SerialHandler::boot},
+    {"save", &SerialHandler::save},
+    {"get", &SerialHandler::get},
+    {"name", &SerialHandler::name},
+    {"rate", &SerialHandler::rate},
+    {"out", &SerialHandler::out},
+    {"stats", &SerialHandler::stats},
+    {"latency", &SerialHandler::latency},
+    {"stream", &SerialHandler::stream},
+#ifdef USE_TRACE
+    {"trace", &SerialHandler::trace},
+#endif
+#ifdef USE_PROFILER
+    {"perf", &SerialHandler::perf},
+#endif
+#if DEV
+    {"echo", &SerialHandler::echo},
+#endif
+};
+
+// The table of all settings exclusive to Hall Effect keys.
+const SerialHandler::Command<SerialHandler::HEKeySettingHandler> SerialHandler::heKeySettings[] = {
+    {"rt", &SerialHandler::hkey_rt},
+    {"crt", &SerialHandler::hkey_crt},
+    {"pred", &SerialHandler::hkey_pred},
+    {"rtus", &SerialHandler::hkey_rtus},
+    {"rtds", &SerialHandler::hkey_rtds},
+    {"lh", &SerialHandler::hkey_lh},
+    {"uh", &SerialHandler::hkey_uh},
+    {"filter", &SerialHandler::hkey_filter},
+    {"curve", &SerialHandler::hkey_curve},
+};
+
+// The table of all settings shared by Hall Effect and digital keys.
+const SerialHandler::Command<SerialHandler::KeySettingHandler> SerialHandler::keySettings[] = {
+    {"char", &SerialHandler::key_char},
+    {"hid", &SerialHandler::key_hid},
+};
+
+template <typename Handler, size_t size>
+const SerialHandler::Command<Handler> *SerialHandler::findCommand(const Command<Handler> (&commands)[size], std::string_view name)
+{
+    // Go through all entries and compare the hashes, only comparing the names if the hashes match to rule out collisions.
+    const uint32_t hash = StringHelper::hash(name);
+    for (const Command<Handler> &command : commands)
+        if (command.hash == hash && command.name == name)
+            return &command;
+
+    // Return a nullptr if no entry with the specified name exists.
+    return nullptr;
+}
 
 void SerialHandler::handleSerialInput(char *input)
 {
     // Make the input buffer lowercase for further parsing.
     StringHelper::toLower(input);
 
-    // Parse the command as the first argument, separated by whitespaces.
-    char command[SERIAL_INPUT_BUFFER_SIZE];
-    StringHelper::getArgumentAt(input, ' ', 0, command);
-
-    // Get a pointer pointing to the start of all parameters for the command.
-    char *parameters = input + strlen(command);
-
-    // If the parameters start with a " " it means parameters have been specified.
-    // It's needed because if there are no parameters there's a zero-terminator instead.
-    // Skipping that zero-terminator would lead to arguments filled with memory garbage.
-    if (strstr(parameters, " ") == parameters)
-        parameters += 1;
-
-    // Parse all arguments.
-    char arg0[SERIAL_INPUT_BUFFER_SIZE];
-    StringHelper::getArgumentAt(parameters, ' ', 0, arg0);
-
-    // Handle the global commands and pass their expected required parameters.
-    if (isEqual(command, "boot"))
-        boot();
-    else if (isEqual(command, "save"))
-        save();
-    else if (isEqual(command, "get"))
-        get();
-    else if (isEqual(command, "name"))
-        name(parameters);
-    else if (isEqual(command, "out"))
-        out();
-#ifdef DEV
-    else if (isEqual(command, "echo"))
-        echo(parameters);
-#endif
+    // Parse the command as the first argument, separated by whitespaces. The parameters are everything after
+    // the command, with the first argument being the first parameter. All of these are views into the input buffer.
+    std::string_view parameters = input;
+    const std::string_view command = StringHelper::nextToken(parameters, ' ');
+    std::string_view arguments = parameters;
+    const std::string_view arg0 = StringHelper::nextToken(arguments, ' ');
+
+    // Handle the global commands by passing the parameters to them.
+    if (const Command<GlobalCommandHandler> *globalCommand = findCommand(globalCommands, command))
+    {
+        (this->*globalCommand->handler)(parameters);
+        return;
+    }
+
+    // Split the command into the key string and the setting name. (e.g. "hkey1" and "rt")
+    std::string_view setting = command;
+    const std::string_view keyStr = StringHelper::nextToken(setting, '.');
 
     // Handle hall effect key specific commands by checking if the command starts with "hkey".
-    if (strstr(command, "hkey") == command)
+    if (keyStr.substr(0, 4) == "hkey")
     {
-        // Split the command into the key string and the setting name.
-        char keyStr[SERIAL_INPUT_BUFFER_SIZE];
-        char setting[SERIAL_INPUT_BUFFER_SIZE];
-        StringHelper::getArgumentAt(command, '.', 0, keyStr);
-        StringHelper::getArgumentAt(command, '.', 1, setting);
+        // Look up the setting in the Hall Effect key settings and the settings shared by all keys.
+        const Command<HEKeySettingHandler> *heKeySetting = findCommand(heKeySettings, setting);
+        const Command<KeySettingHandler> *keySetting = findCommand(keySettings, setting);
+        if (!heKeySetting && !keySetting)
+            return;
 
         // By default, apply this command to all hall effect keys.
         HEKeyConfig *keys = ConfigController.config.heKeys;
+        uint8_t keyCount = HE_KEYS;
 
         // If an index is specified ("hkeyX"), replace that keys array with just that key.
         // This is checked by looking whether the key string has > 4 characters.
-        if (strlen(keyStr) > 4)
+        if (keyStr.length() > 4)
         {
             // Get the index and check if it's in the valid range.
-            uint8_t keyIndex = atoi(keyStr + 4) - 1;
-            if (keyIndex >= HE_KEYS)
+            const int32_t keyIndex = StringHelper::parseInt(keyStr.substr(4)) - 1;
+            if (keyIndex < 0 || keyIndex >= HE_KEYS)
                 return;
 
             // Replace the array with that single key.
             keys = &ConfigController.config.heKeys[keyIndex];
+            keyCount = 1;
         }
 
         // Apply the command to all targetted hall effect keys.
-        for (uint8_t i = 0; i < (strlen(keyStr) > 4 ? 1 : HE_KEYS); i++)
+        for (uint8_t i = 0; i < keyCount; i++)
         {
-            // Get the key from the pointer array.
-            HEKeyConfig &key = keys[i];
-
-            // Handle the settings.
-            if (isEqual(setting, "rt"))
-                hkey_rt(key, isTrue(arg0));
-            else if (isEqual(setting, "crt"))
-                hkey_crt(key, isTrue(arg0));
-            else if (isEqual(setting, "rtus"))
-                hkey_rtus(key, atoi(arg0));
-            else if (isEqual(setting, "rtds"))
-                hkey_rtds(key, atoi(arg0));
-            else if (isEqual(setting, "lh"))
-                hkey_lh(key, atoi(arg0));
-            else if (isEqual(setting, "uh"))
-                hkey_uh(key, atoi(arg0));
-            else if (isEqual(setting, "char"))
-                key_char(key, strlen(arg0) == 1 ? (int)arg0[0] : atoi(arg0) /* Allow for either the ASCII character or integer */);
-            else if (isEqual(setting, "hid"))
-                key_hid(key, isTrue(arg0));
+            if (heKeySetting)
+                (this->*heKeySetting->handler)(keys[i], arg0);
+            else
+                (this->*keySetting->handler)(keys[i], arg0);
         }
+
+        // Signal the key handler to copy the changed settings into the key states.
+        KeyHandler.requestConfigSync();
     }
 
     // Handle digital key specific commands by checking if the command starts with "dkey".
-    if (strstr(command, "dkey") == command)
+    else if (keyStr.substr(0, 4) == "dkey")
     {
-        // Split the command into the key string and the setting name.
-        char keyStr[SERIAL_INPUT_BUFFER_SIZE];
-        char setting[SERIAL_INPUT_BUFFER_SIZE];
-        StringHelper::getArgumentAt(command, '.', 0, keyStr);
-        StringHelper::getArgumentAt(command, '.', 1, setting);
+        // Look up the setting in the settings shared by all keys.
+        const Command<KeySettingHandler> *keySetting = findCommand(keySettings, setting);
+        if (!keySetting)
+            return;
 
         // By default, apply this command to all digital keys.
         DigitalKeyConfig *keys = ConfigController.config.digitalKeys;
+        uint8_t keyCount = DIGITAL_KEYS;
 
         // If an index is specified ("dkeyX"), replace that keys array with just that key.
         // This is checked by looking whether the key string has > 4 characters.
-        if (strlen(keyStr) > 4)
+        if (keyStr.length() > 4)
         {
             // Get the index and check if it's in the valid range.
-            uint8_t keyIndex = atoi(keyStr + 4) - 1;
-#pragma GCC diagnostic ignored "-Wtype-limits"
-            if (keyIndex >= DIGITAL_KEYS)
-#pragma GCC diagnostic pop
+            const int32_t keyIndex = StringHelper::parseInt(keyStr.substr(4)) - 1;
+            if (keyIndex < 0 || keyIndex >= DIGITAL_KEYS)
                 return;
 
             // Replace the array with that single digital key.
             keys = &ConfigController.config.digitalKeys[keyIndex];
+            keyCount = 1;
         }
 
         // Apply the command to all targetted digital keys.
-        for (uint8_t i = 0; i < (strlen(keyStr) > 4 ? 1 : DIGITAL_KEYS); i++)
-        {
-            // Get the key from the pointer array.
-            DigitalKeyConfig &key = keys[i];
-
-            // Handle the settings.
-            if (isEqual(setting, "char"))
-                key_char(key, strlen(arg0) == 1 ? (int)arg0[0] : atoi(arg0) /* Allow for either the ASCII character or integer */);
-            else if (isEqual(setting, "hid"))
-                key_hid(key, isTrue(arg0));
-        }
+        for (uint8_t i = 0; i < keyCount; i++)
+            (this->*keySetting->handler)(keys[i], arg0);
+
+        // Signal the key handler to resolve the changed key chars of the keys.
+        KeyHandler.requestConfigSync();
     }
 }
 
-void SerialHandler::boot()
+void SerialHandler::boot(std::string_view)
 {
     // Set the RP2040 into bootloader mode.
     reset_usb_boot(0, 0);
 }
 
-void SerialHandler::save()
+void SerialHandler::save(std::string_view)
 {
     // Save the configuration managed by the config controller.
     ConfigController.saveConfig();
 }
 
-void SerialHandler::get()
+void SerialHandler::get(std::string_view)
 {
     // Output all global settings.
     print("GET version=%s%s", FIRMWARE_VERSION, DEV ? "-dev" : "");
     print("GET hkeys=%d", HE_KEYS);
     print("GET dkeys=%d", DIGITAL_KEYS);
     print("GET name=%s", ConfigController.config.name);
+    print("GET rate=%d", ConfigController.config.scanRate);
     print("GET htol=%d", HYSTERESIS_TOLERANCE);
     print("GET rtol=%d", RAPID_TRIGGER_TOLERANCE);
     print("GET trdt=%d", TRAVEL_DISTANCE_IN_0_01MM);
@@ -177,10 +201,13 @@ void SerialHandler::get()
         // Format the base for all lines being written.
         print("GET hkey%d.rt=%d", key.index + 1, key.config->rapidTrigger);
         print("GET hkey%d.crt=%d", key.index + 1, key.config->continuousRapidTrigger);
+        print("GET hkey%d.pred=%d", key.index + 1, key.config->predictiveActuation);
         print("GET hkey%d.rtus=%d", key.index + 1, key.config->rapidTriggerUpSensitivity);
         print("GET hkey%d.rtds=%d", key.index + 1, key.config->rapidTriggerDownSensitivity);
         print("GET hkey%d.lh=%d", key.index + 1, key.config->lowerHysteresis);
         print("GET hkey%d.uh=%d", key.index + 1, key.config->upperHysteresis);
+        print("GET hkey%d.filter=%d", key.index + 1, (uint8_t)key.config->filter);
+        print("GET hkey%d.curve=%d", key.index + 1, (uint8_t)key.config->analogCurve);
         print("GET hkey%d.char=%d", key.index + 1, key.config->keyChar);
         print("GET hkey%d.hid=%d", key.index + 1, key.config->hidEnabled);
         print("GET hkey%d.rest=%d", key.index + 1, key.restPosition);
@@ -195,68 +222,209 @@ void SerialHandler::get()
     }
 
     // Print this line to signalize the end of printing the settings to the listener.
-    Serial.println("GET END");
+    SerialWriter.println("GET END");
+}
+
+void SerialHandler::name(std::string_view name)
+{
+    // Check if the length of the name is within the boundary of 1 character and the size of the name buffer, minus the null-terminator.
+    if (name.length() >= 1 && name.length() < sizeof(ConfigController.config.name))
+    {
+        memcpy(ConfigController.config.name, name.data(), name.length());
+        ConfigController.config.name[name.length()] = '\0';
+    }
 }
 
-void SerialHandler::name(char *name)
+void SerialHandler::rate(std::string_view rate)
 {
-    // Get the length of the name and check if it's within the 1-128 characters boundary.
-    size_t length = strlen(name);
-    if (length >= 1 && length <= 128)
-        memcpy(ConfigController.config.name, name + '\0', length + 1);
+    // Parse the specified value and check if it's one of the supported scan rates.
+    const int32_t value = StringHelper::parseInt(rate);
+    if (value >= 0 && value <= UINT16_MAX && ScanScheduler::isSupportedRate(value))
+        ConfigController.config.scanRate = value;
 }
 
-void SerialHandler::out()
+void SerialHandler::out(std::string_view)
 {
     // Output the raw sensor value and magnet distance of every Hall Effect key once.
     for (const HEKey &key : KeyHandler.heKeys)
-        print("OUT hkey%d=%d %d", key.index + 1, key.rawValue, key.distance);
+        print("OUT hkey%d=%d %d", key.index + 1, KeyHandler.heKeyStates.rawValues[key.index], KeyHandler.heKeyStates.distances[key.index]);
+}
+
+void SerialHandler::stats(std::string_view)
+{
+    // Output the statistics of the serial output buffer.
+    print("STATS tx.queued=%lu", (unsigned long)SerialWriter.bytesQueued);
+    print("STATS tx.dropped=%lu", (unsigned long)SerialWriter.bytesDropped);
+    print("STATS tx.maxdepth=%u", SerialWriter.maxDepth);
+    print("STATS telemetry.sent=%lu", (unsigned long)TelemetryHandler.framesSent);
+    print("STATS telemetry.dropped=%lu", (unsigned long)TelemetryHandler.framesDropped);
+    print("STATS hid.sent=%lu", (unsigned long)KeyHandler.reportScheduler.reportsSent);
+    print("STATS hid.skipped=%lu", (unsigned long)KeyHandler.reportScheduler.reportsSkipped);
+    print("STATS hid.coalesced=%lu", (unsigned long)KeyHandler.reportScheduler.reportsCoalesced);
+    print("STATS keys.predicted=%lu", (unsigned long)KeyHandler.predictedTransitions);
+
+    // Output the statistics of the key scans.
+    print("STATS scan.rate=%u", ScanTimer.scheduler.getRate());
+    print("STATS scan.count=%lu", (unsigned long)ScanTimer.scheduler.scans);
+    print("STATS scan.overruns=%lu", (unsigned long)ScanTimer.scheduler.overruns);
+    print("STATS scan.maxjitter=%lu", (unsigned long)ScanTimer.scheduler.maxJitter);
+    print("STATS scan.maxduration=%lu", (unsigned long)ScanTimer.scheduler.maxDuration);
+#ifdef USE_ANALOG_HID
+    print("STATS analog.sent=%lu", (unsigned long)AnalogHandler.reportsSent);
+#endif
+
+    // Print this line to signalize the end of printing the statistics to the listener.
+    SerialWriter.println("STATS END");
+}
+
+void SerialHandler::latency(std::string_view parameters)
+{
+    // Reset the latency measurements if requested, so the next output only covers the time since then.
+    if (parameters == "reset")
+    {
+        KeyHandler.latencyTracker.reset();
+        return;
+    }
+
+    // Output the percentiles of the latency from sampling the keys to sending the HID report for every key, in microseconds.
+    // As the latencies are counted in logarithmic buckets, the percentiles are the upper bound of the bucket they fall into.
+    for (uint8_t i = 0; i < HE_KEYS + DIGITAL_KEYS; i++)
+    {
+        const LogHistogram &histogram = KeyHandler.latencyTracker.histograms[i];
+        print("LATENCY %ckey%d count=%lu p50=%lu p99=%lu max=%lu", i < HE_KEYS ? 'h' : 'd', (i < HE_KEYS ? i : i - HE_KEYS) + 1, (unsigned long)histogram.count,
+              (unsigned long)histogram.getPercentile(50), (unsigned long)histogram.getPercentile(99), (unsigned long)histogram.max);
+    }
+
+    print("LATENCY dropped=%lu", (unsigned long)KeyHandler.latencyTracker.dropped);
 }
 
-void SerialHandler::echo(char *input)
+void SerialHandler::stream(std::string_view decimation)
+{
+    // Start streaming telemetry frames on every n-th scan, or stop the streaming if 0 is specified.
+    const int32_t value = StringHelper::parseInt(decimation);
+    if (value > 0 && value <= UINT16_MAX)
+        TelemetryHandler.start(value);
+    else
+        TelemetryHandler.stop();
+}
+
+#ifdef USE_PROFILER
+void SerialHandler::perf(std::string_view)
+{
+    // The names of the profiler stages, in the order of the ProfilerStage enum.
+    static constexpr const char *stageNames[] = {"filter", "map", "check", "sample", "track", "digital", "report"};
+    static_assert(sizeof(stageNames) / sizeof(*stageNames) == (uint8_t)ProfilerStage::Count, "Every profiler stage needs a name.");
+
+    // Take a snapshot of the measurements, resetting them so the next output only covers the time since this one.
+    Profiler.snapshot();
+
+    // Output the measurements of every stage, and of every key in the stages processing the keys one by one.
+    for (uint8_t stage = 0; stage < (uint8_t)ProfilerStage::Count; stage++)
+    {
+        printHistogram(stageNames[stage], 0, Profiler.stageSnapshots[stage]);
+        if (stage < Profiler.perKeyStages)
+            for (uint8_t i = 0; i < HE_KEYS; i++)
+                printHistogram(stageNames[stage], i + 1, Profiler.keySnapshots[stage][i]);
+    }
+}
+
+void SerialHandler::printHistogram(const char *stage, uint8_t key, const LogHistogram &histogram)
+{
+    // Build the list of the bucket counts, leaving out the empty buckets at the end.
+    char buckets[LogHistogram::bucketCount * 11] = "";
+    uint8_t usedBuckets = LogHistogram::bucketCount;
+    while (usedBuckets > 0 && histogram.buckets[usedBuckets - 1] == 0)
+        usedBuckets--;
+
+    size_t length = 0;
+    for (uint8_t i = 0; i < usedBuckets; i++)
+        length += snprintf(buckets + length, sizeof(buckets) - length, i == 0 ? "%lu" : ",%lu", (unsigned long)histogram.buckets[i]);
+
+    // Output the measurements in cycles, with the key index being appended to the stage name for the measurements of a single key.
+    if (key == 0)
+        print("PERF %s count=%lu min=%lu max=%lu mean=%lu hist=%s", stage, (unsigned long)histogram.count, (unsigned long)(histogram.count ? histogram.min : 0),
+              (unsigned long)histogram.max, (unsigned long)histogram.getMean(), buckets);
+    else
+        print("PERF %s.hkey%d count=%lu min=%lu max=%lu mean=%lu hist=%s", stage, key, (unsigned long)histogram.count, (unsigned long)(histogram.count ? histogram.min : 0),
+              (unsigned long)histogram.max, (unsigned long)histogram.getMean(), buckets);
+}
+#endif
+
+#ifdef USE_TRACE
+void SerialHandler::trace(std::string_view action)
+{
+    // Start or stop recording a trace of the sensor values, or dump the recorded trace as binary frames.
+    if (action == "start")
+        TraceHandler.start();
+    else if (action == "stop")
+        TraceHandler.stop();
+    else if (action == "dump")
+        TraceHandler.dump();
+}
+#endif
+
+void SerialHandler::echo(std::string_view input)
 {
     // Output the same input. This command is used for debugging purposes and only available in said environemnts.
-    Serial.println(input);
+    print("%.*s", (int)input.length(), input.data());
 }
 
-void SerialHandler::hkey_rt(HEKeyConfig &config, bool state)
+void SerialHandler::hkey_rt(HEKeyConfig &config, std::string_view state)
 {
     // Set the rapid trigger config value to the specified state.
-    config.rapidTrigger = state;
+    config.rapidTrigger = StringHelper::parseBool(state);
 }
 
-void SerialHandler::hkey_crt(HEKeyConfig &config, bool state)
+void SerialHandler::hkey_crt(HEKeyConfig &config, std::string_view state)
 {
     // Set the continuous rapid trigger config value to the specified state.
-    config.continuousRapidTrigger = state;
+    config.continuousRapidTrigger = StringHelper::parseBool(state);
+}
+
+void SerialHandler::hkey_pred(HEKeyConfig &config, std::string_view state)
+{
+    // Set the predictive actuation config value to the specified state.
+    config.predictiveActuation = StringHelper::parseBool(state);
 }
 
-void SerialHandler::hkey_rtus(HEKeyConfig &config, uint16_t value)
+void SerialHandler::hkey_rtus(HEKeyConfig &config, std::string_view str)
 {
+    // Parse the specified value.
+    const int32_t value = StringHelper::parseInt(str);
+
     // Check if the specified value is within the tolerance-TRAVEL_DISTANCE_IN_0_01MM boundary.
     if (value >= RAPID_TRIGGER_TOLERANCE && value <= TRAVEL_DISTANCE_IN_0_01MM)
         // Set the rapid trigger up sensitivity config value to the specified state.
         config.rapidTriggerUpSensitivity = value;
 }
 
-void SerialHandler::hkey_rtds(HEKeyConfig &config, uint16_t value)
+void SerialHandler::hkey_rtds(HEKeyConfig &config, std::string_view str)
 {
+    // Parse the specified value.
+    const int32_t value = StringHelper::parseInt(str);
+
     // Check if the specified value is within the tolerance-TRAVEL_DISTANCE_IN_0_01MM boundary.
     if (value >= RAPID_TRIGGER_TOLERANCE && value <= TRAVEL_DISTANCE_IN_0_01MM)
         // Set the rapid trigger down sensitivity config value to the specified state.
         config.rapidTriggerDownSensitivity = value;
 }
 
-void SerialHandler::hkey_lh(HEKeyConfig &config, uint16_t value)
+void SerialHandler::hkey_lh(HEKeyConfig &config, std::string_view str)
 {
-    // Check if the specified value is at least the hysteresis tolerance away from the upper hysteresis.
-    if (config.upperHysteresis - value >= HYSTERESIS_TOLERANCE)
+    // Parse the specified value.
+    const int32_t value = StringHelper::parseInt(str);
+
+    // Check if the specified value is positive and at least the hysteresis tolerance away from the upper hysteresis.
+    if (value >= 0 && config.upperHysteresis - value >= HYSTERESIS_TOLERANCE)
         // Set the lower hysteresis config value to the specified state.
         config.lowerHysteresis = value;
 }
 
-void SerialHandler::hkey_uh(HEKeyConfig &config, uint16_t value)
+void SerialHandler::hkey_uh(HEKeyConfig &config, std::string_view str)
 {
+    // Parse the specified value.
+    const int32_t value = StringHelper::parseInt(str);
+
     // Check if the specified value is at least the hysteresis tolerance away from the lower hysteresis.
     // Also make sure the upper hysteresis is at least said tolerance away from TRAVEL_DISTANCE_IN_0_01MM
     // to make sure the value can be reached and the key does not get stuck in an eternal pressed state.
@@ -265,14 +433,37 @@ void SerialHandler::hkey_uh(HEKeyConfig &config, uint16_t value)
         config.upperHysteresis = value;
 }
 
-void SerialHandler::key_char(KeyConfig &config, uint8_t keyChar)
+void SerialHandler::hkey_filter(HEKeyConfig &config, std::string_view str)
+{
+    // Parse the specified value.
+    const int32_t value = StringHelper::parseInt(str);
+
+    // Check if the specified value is a valid filter type.
+    if (value >= 0 && value < (int32_t)FilterType::Count)
+        // Set the filter type config value to the specified state.
+        config.filter = (FilterType)value;
+}
+
+void SerialHandler::hkey_curve(HEKeyConfig &config, std::string_view str)
+{
+    // Parse the specified value.
+    const int32_t value = StringHelper::parseInt(str);
+
+    // Check if the specified value is a valid curve type.
+    if (value >= 0 && value < (int32_t)AnalogCurveType::Count)
+        // Set the curve type config value to the specified state.
+        config.analogCurve = (AnalogCurveType)value;
+}
+
+void SerialHandler::key_char(KeyConfig &config, std::string_view keyChar)
 {
     // Set the key config value of the specified key to the specified state.
-    config.keyChar = keyChar;
+    // Allow for either the ASCII character or integer.
+    config.keyChar = keyChar.length() == 1 ? keyChar[0] : (uint8_t)StringHelper::parseInt(keyChar);
 }
 
-void SerialHandler::key_hid(KeyConfig &config, bool state)
+void SerialHandler::key_hid(KeyConfig &config, std::string_view state)
 {
     // Set the hid config value of the specified key to the specified state.
-    config.hidEnabled = state;
+    config.hidEnabled = StringHelper::parseBool(state);
 }
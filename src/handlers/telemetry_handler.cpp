@@ -0,0 +1,56 @@
+#include <Arduino.h>
+#include "handlers/telemetry_handler.hpp"
+#include "helpers/serial_writer.hpp"
+#include "definitions.hpp"
+
+void TelemetryHandler::start(uint16_t decimation)
+{
+    // Start capturing every n-th scan. A decimation of 0 stops the streaming.
+    this->decimation = decimation;
+}
+
+void TelemetryHandler::stop()
+{
+    // Stop capturing scans. Frames still in the queue are sent regardless.
+    decimation = 0;
+}
+
+void TelemetryHandler::capture(const HEKeyStates &states, const HEKey *keys)
+{
+    // Check whether the streaming is running and this scan is supposed to be captured.
+    const uint16_t decimation = this->decimation;
+    if (decimation == 0 || ++scans < decimation)
+        return;
+    scans = 0;
+
+    // Build the frame from the values of all Hall Effect keys.
+    TelemetryFrame frame;
+    frame.type = frameType;
+    frame.sequence = sequence++;
+    frame.timestamp = micros();
+    frame.keyCount = HE_KEYS;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        frame.keys[i].adcValue = states.adcValues[i];
+        frame.keys[i].rawValue = states.rawValues[i];
+        frame.keys[i].distance = states.distances[i];
+        frame.keys[i].rapidTriggerPeak = states.rapidTriggerPeaks[i];
+        frame.keys[i].flags = keys[i].pressed | states.inRapidTriggerZone[i] << 1;
+    }
+
+    // Queue the frame for the serial output. If the queue is full, the frame is dropped.
+    if (!frames.push(frame))
+        framesDropped++;
+}
+
+void TelemetryHandler::flush()
+{
+    // Move as many frames from the queue into the serial output as fit into it. Frames that do not fit
+    // remain in the queue, causing new frames to be dropped once it is full instead of blocking the scanning.
+    TelemetryFrame frame;
+    while (SerialWriter.getFreeSpace() >= sizeof(TelemetryFrame) + 5 && frames.pop(frame))
+    {
+        SerialWriter.writeFrame((const uint8_t *)&frame, sizeof(frame));
+        framesSent++;
+    }
+}
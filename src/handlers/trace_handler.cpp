@@ -0,0 +1,131 @@
+#include <Arduino.h>
+#include "handlers/trace_handler.hpp"
+#include "helpers/serial_writer.hpp"
+#include "definitions.hpp"
+
+#ifdef USE_TRACE
+void TraceHandler::start()
+{
+    // Only start a new recording once the previous one has been stopped. Discard the previously recorded blocks and any unfinished dump.
+    if (state != Stopped)
+        return;
+
+    dumping = false;
+    filledBlocks = 0;
+    state = Recording;
+}
+
+void TraceHandler::stop()
+{
+    // Request the scanning code to stop recording, which it acknowledges on the next scan.
+    uint8_t expected = Recording;
+    state.compare_exchange_strong(expected, StopRequested);
+}
+
+void TraceHandler::dump()
+{
+    // Stop the recording and send all recorded blocks, starting with the oldest one, once the recording has stopped.
+    stop();
+    dumping = true;
+    dumpedBlocks = 0;
+}
+
+void TraceHandler::capture(uint32_t timestamp, const uint16_t *values)
+{
+    // Check whether the recording is running, acknowledging a requested stop.
+    const uint8_t state = this->state;
+    if (state == StopRequested)
+        this->state = Stopped;
+    if (state != Recording)
+        return;
+
+    // Start the first block with a keyframe.
+    if (filledBlocks == 0)
+    {
+        startBlock(timestamp, values);
+        return;
+    }
+
+    // Encode the differences of the time and the values to the last frame. The time difference is never negative, being 0 if two scans
+    // read the same frame of the sampler, while the value
+    // differences are zigzag-encoded, mapping small negative and positive differences to small unsigned numbers.
+    uint8_t frame[maxFrameSize];
+    uint8_t length = writeVarInt(frame, timestamp - lastTimestamp);
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const int32_t delta = (int32_t)values[i] - lastValues[i];
+        length += writeVarInt(frame + length, delta >= 0 ? delta * 2 : -delta * 2 - 1);
+    }
+
+    // If the frame does not fit into the current block anymore, continue with a keyframe in the next block instead.
+    if (blockLengths[currentBlock] + length > blockSize)
+    {
+        currentBlock = (currentBlock + 1) % blockCount;
+        startBlock(timestamp, values);
+        return;
+    }
+
+    memcpy(blocks[currentBlock] + blockLengths[currentBlock], frame, length);
+    blockLengths[currentBlock] += length;
+    lastTimestamp = timestamp;
+    memcpy(lastValues, values, sizeof(lastValues));
+}
+
+void TraceHandler::flush()
+{
+    // Only send the blocks once the scanning code stopped recording into them.
+    if (!dumping || state != Stopped)
+        return;
+
+    // Move as many blocks into the serial output as fit into it, starting with the oldest block. The payload contains
+    // the index of the block in the dump, the amount of blocks in the dump and the amount of keys, followed by the block.
+    while (dumpedBlocks < filledBlocks)
+    {
+        const uint16_t block = (currentBlock + blockCount - filledBlocks + 1 + dumpedBlocks) % blockCount;
+        const uint16_t length = blockLengths[block];
+        if (SerialWriter.getFreeSpace() < 6u + length + 5u)
+            return;
+
+        uint8_t payload[6 + blockSize];
+        payload[0] = frameType;
+        payload[1] = dumpedBlocks;
+        payload[2] = dumpedBlocks >> 8;
+        payload[3] = filledBlocks;
+        payload[4] = filledBlocks >> 8;
+        payload[5] = HE_KEYS;
+        memcpy(payload + 6, blocks[block], length);
+        SerialWriter.writeFrame(payload, 6 + length);
+        dumpedBlocks++;
+    }
+
+    dumping = false;
+}
+
+void TraceHandler::startBlock(uint32_t timestamp, const uint16_t *values)
+{
+    // Write the keyframe with the absolute time and values into the current block, overwriting it if it was filled before.
+    uint8_t *block = blocks[currentBlock];
+    memcpy(block, &timestamp, sizeof(timestamp));
+    memcpy(block + sizeof(timestamp), values, HE_KEYS * sizeof(uint16_t));
+    blockLengths[currentBlock] = sizeof(timestamp) + HE_KEYS * sizeof(uint16_t);
+    if (filledBlocks < blockCount)
+        filledBlocks++;
+
+    lastTimestamp = timestamp;
+    memcpy(lastValues, values, sizeof(lastValues));
+}
+
+uint8_t TraceHandler::writeVarInt(uint8_t *data, uint32_t value)
+{
+    // Write the value in groups of 7 bits, starting with the lowest ones, with the highest bit of every byte indicating whether more follow.
+    uint8_t length = 0;
+    while (value >= 0x80)
+    {
+        data[length++] = value | 0x80;
+        value >>= 7;
+    }
+
+    data[length++] = value;
+    return length;
+}
+#endif
@@ -0,0 +1,223 @@
+#include <Arduino.h>
+#include "helpers/adc_sampler.hpp"
+#include "definitions.hpp"
+
+#ifdef USE_DMA_ADC_SAMPLING
+extern "C"
+{
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+}
+
+// Forward the interrupt of the DMA channels to the ADCSampler instance.
+static void onDMAInterrupt()
+{
+    ADCSampler.onDMAComplete();
+}
+#endif
+
+#ifdef USE_ANALOG_MULTIPLEXER
+extern "C"
+{
+#include "hardware/adc.h"
+#include "hardware/gpio.h"
+}
+#endif
+
+void ADCSampler::begin()
+{
+#if defined(USE_ANALOG_MULTIPLEXER)
+
+    // Initialize the ADC and the pins of all multiplexers for analog input, with the multiplexers being connected to A0 and upwards.
+    adc_init();
+    for (uint8_t i = 0; i < multiplexers; i++)
+        adc_gpio_init(A0 + i);
+
+    // Initialize the pins of the select lines as outputs and select the first channel.
+    gpio_init_mask(selectMask);
+    gpio_set_dir_out_masked(selectMask);
+    selectChannel(0);
+
+#elif defined(USE_DMA_ADC_SAMPLING)
+
+    // Initialize the ADC and the pins of all Hall Effect keys for analog input.
+    adc_init();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        adc_gpio_init(HE_PIN(i));
+
+    // Sample the ADC inputs of all Hall Effect keys in a round-robin, starting at the first input. Since the pins of the
+    // Hall Effect keys are A0 and upwards, these are the inputs 0 to HE_KEYS - 1. The FIFO requests a DMA transfer on every
+    // sample, with the samples not being shifted down to 8 bit. The clock divider results in the configured sample rate.
+    adc_select_input(0);
+    adc_set_round_robin((1 << HE_KEYS) - 1);
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(48000000 / DMA_ADC_SAMPLE_RATE - 1);
+
+    // Set up two DMA channels reading from the ADC FIFO, each filling one of the buffers and starting the other channel
+    // once finished. This way, the ADC is sampled continuously while the completed buffer can be read at any time.
+    dmaChannels[0] = dma_claim_unused_channel(true);
+    dmaChannels[1] = dma_claim_unused_channel(true);
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        dma_channel_config config = dma_channel_get_default_config(dmaChannels[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_chain_to(&config, dmaChannels[1 - i]);
+        dma_channel_configure(dmaChannels[i], &config, buffers[i], &adc_hw->fifo, bufferSize, false);
+        dma_channel_set_irq1_enabled(dmaChannels[i], true);
+    }
+
+    // Register the interrupt handler for completed buffers on the second DMA interrupt, as the first one might be used by the core.
+    irq_add_shared_handler(DMA_IRQ_1, onDMAInterrupt, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    // Start the first DMA channel and the free-running ADC.
+    dma_channel_start(dmaChannels[0]);
+    adc_run(true);
+    started = true;
+
+#endif
+}
+
+bool ADCSampler::read(uint16_t *values, uint32_t &sampledAt)
+{
+#if defined(USE_ANALOG_MULTIPLEXER)
+
+    // The values are sampled right now, while reading them.
+    sampledAt = micros();
+
+    // Go through all channels in use and read the sensors on that channel of every multiplexer.
+    uint16_t samples[multiplexers];
+    for (uint8_t channel = 0; channel < activeChannels; channel++)
+    {
+        // Wait for the multiplexers to settle. The time is measured in whole microseconds, so it has to exceed the settle time
+        // to guarantee that the settle time has fully passed. Since the first channel is already selected at the end of the
+        // previous read, its settle time usually has passed long before, while the keys were being processed.
+        while (micros() - channelSelectedAt <= ANALOG_MULTIPLEXER_SETTLE_TIME)
+            tight_loop_contents();
+
+        // Read the sensors of all multiplexers on this channel back-to-back, as they share the select lines and settle at once.
+        for (uint8_t i = 0; i < multiplexers && i * channels + channel < HE_KEYS; i++)
+        {
+            adc_select_input(i);
+            samples[i] = adc_read();
+        }
+
+        // Switch to the next channel right away, wrapping around to the first one for the next read, and
+        // store the samples while the multiplexers are settling, instead of waiting for the full settle time.
+        selectChannel((channel + 1) % activeChannels);
+        for (uint8_t i = 0; i < multiplexers && i * channels + channel < HE_KEYS; i++)
+            values[i * channels + channel] = samples[i];
+    }
+
+#elif defined(USE_DMA_ADC_SAMPLING)
+
+    // Report that no values could be read if the first buffer has not been filled yet, as the buffers contain no samples before.
+    if (!frameAvailable)
+        return false;
+
+    // Get the newest frame, being the last one in the most recently completed buffer. The frame contains the samples ordered
+    // by their ADC input, which is mapped back to the key index. The buffer is not written to again until the other buffer
+    // has been filled completely, giving plenty of time to read the frame.
+    // The time of the frame is the time the buffer was completed at, not the time it is read at, which can be up to a whole buffer later.
+    const uint8_t buffer = latestBuffer;
+    const uint16_t *frame = buffers[buffer] + bufferSize - HE_KEYS;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        values[i] = frame[HE_PIN(i) - A0];
+    sampledAt = completedAt[buffer];
+
+#else
+
+    // Read the value from the port of every Hall Effect key one after another, which happens right now.
+    sampledAt = micros();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        values[i] = analogRead(HE_PIN(i));
+
+#endif
+
+    return true;
+}
+
+void ADCSampler::pause()
+{
+#ifdef USE_DMA_ADC_SAMPLING
+
+    if (!started)
+        return;
+
+    // Stop the free-running ADC and wait for the conversion in progress to finish, so no more samples are put into the FIFO.
+    adc_run(false);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS))
+        tight_loop_contents();
+
+    // Abort both DMA channels, which does not start the chained channel. Aborting may raise the completion interrupt even though the
+    // buffer has not been filled, so the interrupt is disabled while aborting and cleared afterwards. Then throw away the samples
+    // left in the FIFO, as they would shift the inputs of the samples in the buffers after resuming.
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        dma_channel_set_irq1_enabled(dmaChannels[i], false);
+        dma_channel_abort(dmaChannels[i]);
+        dma_channel_acknowledge_irq1(dmaChannels[i]);
+        dma_channel_set_irq1_enabled(dmaChannels[i], true);
+    }
+
+    adc_fifo_drain();
+
+#endif
+}
+
+void ADCSampler::resume()
+{
+#ifdef USE_DMA_ADC_SAMPLING
+
+    if (!started)
+        return;
+
+    // Move both channels back to the start of their buffers, as the aborted channel stopped somewhere in the middle of its buffer.
+    // The transfer count is reloaded when a channel is started, so it does not have to be set again.
+    for (uint8_t i = 0; i < 2; i++)
+        dma_channel_set_write_addr(dmaChannels[i], buffers[i], false);
+
+    // Start the channel filling the buffer that does not contain the newest frame, so the frame sampled before pausing can still be read
+    // until the first buffer has been filled again. The round-robin restarts at the first input, so the frames start at the buffer starts.
+    dma_channel_start(dmaChannels[1 - latestBuffer]);
+    adc_select_input(0);
+    adc_run(true);
+
+#endif
+}
+
+#ifdef USE_DMA_ADC_SAMPLING
+void ADCSampler::onDMAComplete()
+{
+    // Go through both DMA channels and check which one has completed its buffer.
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (!dma_channel_get_irq1_status(dmaChannels[i]))
+            continue;
+
+        // Acknowledge the interrupt and remember the buffer as the newest completed one.
+        dma_channel_acknowledge_irq1(dmaChannels[i]);
+        completedAt[i] = time_us_32();
+        latestBuffer = i;
+        frameAvailable = true;
+
+        // Reset the write address of the channel to the start of its buffer without starting it. The channel
+        // is started by the other channel through chaining, with the transfer count being reloaded automatically.
+        dma_channel_set_write_addr(dmaChannels[i], buffers[i], false);
+    }
+}
+#endif
+
+#ifdef USE_ANALOG_MULTIPLEXER
+void ADCSampler::selectChannel(uint8_t channel)
+{
+    // Set all select lines at once and remember the time the multiplexers started settling.
+    gpio_put_masked(selectMask, (uint32_t)channel << ANALOG_MULTIPLEXER_SELECT_PIN_BASE);
+    channelSelectedAt = micros();
+}
+#endif
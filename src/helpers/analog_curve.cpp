@@ -0,0 +1,44 @@
+#include <algorithm>
+#include "helpers/analog_curve.hpp"
+
+uint16_t AnalogCurve::operator()(uint16_t distance) const
+{
+    // Convert the distance into the travel of the key, clamped to the travel distance in case the distance is out of range.
+    const uint32_t travel = TRAVEL_DISTANCE_IN_0_01MM - std::min(distance, (uint16_t)TRAVEL_DISTANCE_IN_0_01MM);
+
+    // Get the segment of the travel with 8 fractional bits using the fixed-point reciprocal of the travel distance,
+    // and interpolate between the two points of the segment.
+    const uint32_t position = (travel * positionScale) >> positionScaleShift;
+    const uint8_t segment = position >> 8;
+    if (segment >= segments)
+        return points[segments];
+
+    const uint32_t fraction = position & 0xFF;
+    return (points[segment] * (256 - fraction) + points[segment + 1] * fraction) >> 8;
+}
+
+void AnalogCurve::setType(AnalogCurveType type)
+{
+    this->type = type;
+
+    // Compute the axis value at every point, with x being the travel of the point from 0 to 1024.
+    for (uint8_t i = 0; i <= segments; i++)
+    {
+        const uint32_t x = i * 1024 / segments;
+        uint32_t value;
+        switch (type)
+        {
+        case AnalogCurveType::Progressive:
+            value = x * x / 1024;
+            break;
+        case AnalogCurveType::Aggressive:
+            value = 1024 - (1024 - x) * (1024 - x) / 1024;
+            break;
+        default:
+            value = x;
+            break;
+        }
+
+        points[i] = std::min(value, (uint32_t)maxValue);
+    }
+}
@@ -0,0 +1,15 @@
+#include "helpers/crc16.hpp"
+
+uint16_t CRC16::compute(const uint8_t *data, size_t length, uint16_t crc)
+{
+    // Calculate the CRC-16/CCITT-FALSE checksum (polynomial 0x1021) bit by bit. The initial value can be
+    // passed to continue the calculation over multiple data blocks, with 0xFFFF being the initial value of the algorithm.
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
@@ -0,0 +1,51 @@
+#include <Arduino.h>
+#include "helpers/digital_sampler.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/structs/sio.h"
+#include "hardware/timer.h"
+}
+
+// Forward the GPIO interrupt of the digital key pins to the DigitalSampler instance.
+static void onGPIOInterrupt()
+{
+    DigitalSampler.onEdge();
+}
+
+void DigitalSampler::begin()
+{
+    // Timestamp all edges on the digital key pins, with the interrupt running on the core calling this. The handler is added
+    // for the pins of the digital keys only, so it does not interfere with interrupts attached to other pins.
+    if (pinsMask() == 0)
+        return;
+
+    gpio_add_raw_irq_handler_masked(pinsMask(), &onGPIOInterrupt);
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+        gpio_set_irq_enabled(DIGITAL_PIN(i), GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+uint32_t DigitalSampler::read() const
+{
+    // Read the levels of all GPIO pins at once, instead of reading every pin separately.
+    return sio_hw->gpio_in;
+}
+
+void DigitalSampler::onEdge()
+{
+    // Save the time of the edge for all digital key pins with a pending edge, and acknowledge the edges.
+    const uint32_t now = time_us_32();
+    for (uint8_t i = 0; i < DIGITAL_KEYS; i++)
+    {
+        const uint32_t events = gpio_get_irq_event_mask(DIGITAL_PIN(i));
+        if (!events)
+            continue;
+
+        gpio_acknowledge_irq(DIGITAL_PIN(i), events);
+        lastEdges[i] = now;
+    }
+}
@@ -0,0 +1,17 @@
+#include "helpers/ema_filter.hpp"
+
+// On the call operator the next value is given into the filter, with the new average being returned.
+uint16_t EMAFilter::operator()(uint16_t value)
+{
+    // Move the average towards the new value by the smoothing factor, using bitshifting instead of a multiplication.
+    average += (((int32_t)value << 8) - average) >> EMA_FILTER_ALPHA_EXPONENT;
+
+    // Round the fixed-point average to the nearest whole number and return it.
+    return (average + (1 << 7)) >> 8;
+}
+
+void EMAFilter::reset(uint16_t value)
+{
+    // Set the average to the value in fixed-point.
+    average = (int32_t)value << 8;
+}
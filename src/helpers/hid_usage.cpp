@@ -0,0 +1,64 @@
+#include "helpers/hid_usage.hpp"
+
+HIDUsage::KeyCode HIDUsage::fromKeyChar(uint8_t keyChar)
+{
+    // Key chars from 136 upwards are HID usages offset by 136, and key chars from 128 to 135 are the modifier keys
+    // (left ctrl, shift, alt, gui, right ctrl, shift, alt, gui), whose usages are 0xE0 to 0xE7. This matches the Keyboard library.
+    if (keyChar >= 136)
+        return {(uint8_t)(keyChar - 136), 0};
+    if (keyChar >= 128)
+        return {(uint8_t)(0xE0 + keyChar - 128), 0};
+
+    // Map letters and digits to their keys on the US layout. Uppercase letters are typed with the shift modifier held.
+    if (keyChar >= 'a' && keyChar <= 'z')
+        return {(uint8_t)(0x04 + keyChar - 'a'), 0};
+    if (keyChar >= 'A' && keyChar <= 'Z')
+        return {(uint8_t)(0x04 + keyChar - 'A'), leftShift};
+    if (keyChar >= '1' && keyChar <= '9')
+        return {(uint8_t)(0x1E + keyChar - '1'), 0};
+
+    // Map the remaining printable characters and control characters to their keys on the US layout, with the characters
+    // on the upper half of a key being typed with the shift modifier held. Unknown characters are mapped to no key.
+    switch (keyChar)
+    {
+    case '0': return {0x27, 0};
+    case ')': return {0x27, leftShift};
+    case '!': return {0x1E, leftShift};
+    case '@': return {0x1F, leftShift};
+    case '#': return {0x20, leftShift};
+    case '$': return {0x21, leftShift};
+    case '%': return {0x22, leftShift};
+    case '^': return {0x23, leftShift};
+    case '&': return {0x24, leftShift};
+    case '*': return {0x25, leftShift};
+    case '(': return {0x26, leftShift};
+    case '\n': return {0x28, 0};
+    case 0x1B: return {0x29, 0};
+    case '\b': return {0x2A, 0};
+    case '\t': return {0x2B, 0};
+    case ' ': return {0x2C, 0};
+    case '-': return {0x2D, 0};
+    case '_': return {0x2D, leftShift};
+    case '=': return {0x2E, 0};
+    case '+': return {0x2E, leftShift};
+    case '[': return {0x2F, 0};
+    case '{': return {0x2F, leftShift};
+    case ']': return {0x30, 0};
+    case '}': return {0x30, leftShift};
+    case '\\': return {0x31, 0};
+    case '|': return {0x31, leftShift};
+    case ';': return {0x33, 0};
+    case ':': return {0x33, leftShift};
+    case '\'': return {0x34, 0};
+    case '"': return {0x34, leftShift};
+    case '`': return {0x35, 0};
+    case '~': return {0x35, leftShift};
+    case ',': return {0x36, 0};
+    case '<': return {0x36, leftShift};
+    case '.': return {0x37, 0};
+    case '>': return {0x37, leftShift};
+    case '/': return {0x38, 0};
+    case '?': return {0x38, leftShift};
+    default: return {0, 0};
+    }
+}
@@ -0,0 +1,67 @@
+#include "helpers/key_filter.hpp"
+#include "definitions.hpp"
+
+// On the call operator the next value is given into the selected filter, with the filtered value being returned.
+uint16_t KeyFilter::operator()(uint16_t value)
+{
+    // Pass the value through the filter of the selected type.
+    switch (type)
+    {
+    case FilterType::EMA:
+        lastValue = ema(value);
+        break;
+    case FilterType::OneEuro:
+        lastValue = oneEuro(value);
+        break;
+    case FilterType::Median:
+        lastValue = median(value);
+        break;
+    default:
+        lastValue = sma(value);
+        break;
+    }
+
+    // Consider the filter initialized once as many values have been passed through as the SMA filter needs to fill its buffer.
+    // Using the same amount for all filters guarantees that every filter has settled, independent of which one is selected.
+    if (!initialized && ++samples >= 1 << SMA_FILTER_SAMPLE_EXPONENT)
+        initialized = true;
+
+    return lastValue;
+}
+
+void KeyFilter::setType(FilterType type)
+{
+    // Reset the newly selected filter to the last value returned, so switching filters does not cause a jump in the filtered values.
+    this->type = type;
+    resetSelected(lastValue);
+}
+
+void KeyFilter::reset(uint16_t value)
+{
+    // Reset the selected filter to the specified value, considering it settled right away.
+    resetSelected(value);
+    samples = 1 << SMA_FILTER_SAMPLE_EXPONENT;
+    initialized = true;
+}
+
+void KeyFilter::resetSelected(uint16_t value)
+{
+    // Reset the filter of the selected type to the specified value.
+    switch (type)
+    {
+    case FilterType::EMA:
+        ema.reset(value);
+        break;
+    case FilterType::OneEuro:
+        oneEuro.reset(value);
+        break;
+    case FilterType::Median:
+        median.reset(value);
+        break;
+    default:
+        sma.reset(value);
+        break;
+    }
+
+    lastValue = value;
+}
@@ -0,0 +1,94 @@
+#include "helpers/keyboard_report.hpp"
+
+bool KeyboardReport::press(uint8_t usage, uint8_t modifiers)
+{
+    // Usage 0 means no key and is ignored, along with its modifiers.
+    if (usage == 0)
+        return false;
+
+    // Hold the modifiers required by the key, and set the bit of the usage. Return whether either changed what is reported.
+    const uint8_t previousModifiers = getModifiers();
+    for (uint8_t bit = 0; bit < 8; bit++)
+        if (modifiers & (1 << bit))
+            modifierHolds[bit]++;
+
+    // The modifier usages only change the report if the modifier is not held already.
+    const uint8_t mask = 1 << (usage % 8);
+    const bool changed = usage / 8 != modifierByte && !(usages[usage / 8] & mask);
+    usages[usage / 8] |= mask;
+    return changed || getModifiers() != previousModifiers;
+}
+
+bool KeyboardReport::release(uint8_t usage, uint8_t modifiers)
+{
+    if (usage == 0)
+        return false;
+
+    // Stop holding the modifiers required by the key, and clear the bit of the usage. Return whether either changed what is reported.
+    const uint8_t previousModifiers = getModifiers();
+    for (uint8_t bit = 0; bit < 8; bit++)
+        if (modifiers & (1 << bit) && modifierHolds[bit] > 0)
+            modifierHolds[bit]--;
+
+    // The modifier usages only change the report if the modifier is not held by another key requiring it.
+    const uint8_t mask = 1 << (usage % 8);
+    const bool changed = usage / 8 != modifierByte && usages[usage / 8] & mask;
+    usages[usage / 8] &= ~mask;
+    return changed || getModifiers() != previousModifiers;
+}
+
+uint8_t KeyboardReport::getModifiers() const
+{
+    // The modifiers are the ones pressed as keys, plus the ones held by keys requiring them.
+    uint8_t modifiers = usages[modifierByte];
+    for (uint8_t bit = 0; bit < 8; bit++)
+        if (modifierHolds[bit] > 0)
+            modifiers |= 1 << bit;
+
+    return modifiers;
+}
+
+void KeyboardReport::toNKROReport(uint8_t (&report)[nkroReportSize]) const
+{
+    // The bitmap up to the modifiers is sent as-is after the modifier byte, leaving out the usages 1 to 3 as they are error codes.
+    report[0] = getModifiers();
+    for (uint8_t i = 0; i < modifierByte; i++)
+        report[1 + i] = usages[i];
+
+    report[1] &= 0xF0;
+}
+
+void KeyboardReport::toBootReport(uint8_t &modifiers, uint8_t (&keys)[6]) const
+{
+    modifiers = getModifiers();
+
+    // Go through the bitmap up to the modifiers and add all pressed usages to the keys, skipping empty bytes as a whole.
+    // Usages 0 to 3 are reserved for the error codes of the boot protocol and can therefore not be pressed.
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < modifierByte; i++)
+    {
+        if (!usages[i])
+            continue;
+
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            const uint8_t usage = i * 8 + bit;
+            if (!(usages[i] & (1 << bit)) || usage < 4)
+                continue;
+
+            // If more than 6 keys are pressed, report the rollover error in all key slots as defined by the HID specification.
+            if (count == 6)
+            {
+                for (uint8_t &key : keys)
+                    key = 0x01;
+                return;
+            }
+
+            keys[count++] = usage;
+        }
+    }
+
+    // Clear the remaining key slots.
+    while (count < 6)
+        keys[count++] = 0;
+}
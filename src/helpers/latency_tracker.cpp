@@ -0,0 +1,30 @@
+#include "helpers/latency_tracker.hpp"
+
+void LatencyTracker::onChange(uint8_t key, uint32_t timestamp)
+{
+    // Remember the transition until the report is sent. If too many transitions are waiting, the transition is not measured.
+    if (pendingCount == KEY_EVENT_QUEUE_SIZE)
+    {
+        dropped++;
+        return;
+    }
+
+    pending[pendingCount++] = {key, timestamp};
+}
+
+void LatencyTracker::onSent(uint32_t now)
+{
+    // Add the latencies of all transitions carried by the sent report to the histograms of their keys.
+    for (uint8_t i = 0; i < pendingCount; i++)
+        histograms[pending[i].key].add(now - pending[i].timestamp);
+
+    pendingCount = 0;
+}
+
+void LatencyTracker::reset()
+{
+    for (LogHistogram &histogram : histograms)
+        histogram.reset();
+
+    dropped = 0;
+}
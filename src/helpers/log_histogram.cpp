@@ -0,0 +1,46 @@
+#include "helpers/log_histogram.hpp"
+
+void LogHistogram::add(uint32_t value)
+{
+    // Get the bucket from the position of the highest set bit, counting values beyond the last bucket in it.
+    uint8_t bucket = value == 0 ? 0 : 32 - __builtin_clz(value);
+    if (bucket >= bucketCount)
+        bucket = bucketCount - 1;
+
+    buckets[bucket]++;
+    count++;
+    sum += value;
+    if (value < min)
+        min = value;
+    if (value > max)
+        max = value;
+}
+
+void LogHistogram::reset()
+{
+    *this = LogHistogram();
+}
+
+uint32_t LogHistogram::getMean() const
+{
+    return count == 0 ? 0 : sum / count;
+}
+
+uint32_t LogHistogram::getPercentile(uint8_t percent) const
+{
+    // Go through the buckets until the specified percentage of values is reached, and return the upper bound of that bucket.
+    // As the bucket only bounds the value, the result is limited to the range of the actually added values.
+    const uint64_t target = ((uint64_t)count * percent + 99) / 100;
+    uint32_t counted = 0;
+    for (uint8_t i = 0; i < bucketCount; i++)
+    {
+        counted += buckets[i];
+        if (counted < target || counted == 0)
+            continue;
+
+        const uint32_t upperBound = i == 0 ? 0 : (i == bucketCount - 1 ? max : (1u << i) - 1);
+        return upperBound < min ? min : (upperBound > max ? max : upperBound);
+    }
+
+    return max;
+}
@@ -0,0 +1,29 @@
+#include "helpers/median_filter.hpp"
+
+// On the call operator the next value is given into the filter, with the new median being returned.
+uint16_t MedianFilter::operator()(uint16_t value)
+{
+    // Overwrite the oldest element in the circular buffer with the new one and move the index forward.
+    buffer[index] = value;
+    index = (index + 1) % samples;
+
+    // Sort a copy of the buffer using insertion sort, which is the fastest for such few elements.
+    uint16_t sorted[samples];
+    for (uint8_t i = 0; i < samples; i++)
+    {
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > buffer[i]; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = buffer[i];
+    }
+
+    // Return the element in the middle of the sorted values.
+    return sorted[samples / 2];
+}
+
+void MedianFilter::reset(uint16_t value)
+{
+    // Fill the whole buffer with the value.
+    for (uint16_t &element : buffer)
+        element = value;
+}
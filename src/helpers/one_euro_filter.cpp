@@ -0,0 +1,32 @@
+#include <cstdlib>
+#include "helpers/one_euro_filter.hpp"
+
+// On the call operator the next value is given into the filter, with the new filtered value being returned.
+uint16_t OneEuroFilter::operator()(uint16_t input)
+{
+    // Calculate the derivative as the difference to the previous input and low-pass filter it with the derivative cutoff, to not react to noise.
+    const int32_t difference = ((int32_t)input - previousInput) << 8;
+    derivative += (difference - derivative) >> ONE_EURO_FILTER_DERIVATIVE_EXPONENT;
+    previousInput = input;
+
+    // Increase the cutoff (2π times the cutoff frequency per sample, with 8 fractional bits) linearly with the speed, starting at the minimum at rest.
+    const int32_t cutoff = ONE_EURO_FILTER_MIN_CUTOFF + ((std::abs(derivative) * ONE_EURO_FILTER_BETA) >> 8);
+
+    // Get the smoothing factor (with 8 fractional bits) of the cutoff, which is cutoff / (1 + cutoff). The smoothing factor approaches 1 for
+    // high speeds, passing the value through with barely any delay. The division is done by the hardware divider of the RP2040.
+    const int32_t alpha = (cutoff << 8) / ((1 << 8) + cutoff);
+
+    // Move the filtered value towards the new value by the smoothing factor.
+    value += ((((int32_t)input << 8) - value) * alpha) >> 8;
+
+    // Round the fixed-point value to the nearest whole number and return it.
+    return (value + (1 << 7)) >> 8;
+}
+
+void OneEuroFilter::reset(uint16_t input)
+{
+    // Set the filtered value and the previous input to the value and reset the derivative.
+    value = (int32_t)input << 8;
+    previousInput = input;
+    derivative = 0;
+}
@@ -0,0 +1,83 @@
+#include <Arduino.h>
+#include "helpers/profiler.hpp"
+#include "definitions.hpp"
+
+#ifdef USE_PROFILER
+extern "C"
+{
+#include "hardware/structs/systick.h"
+}
+
+void Profiler::begin()
+{
+    // Let the SysTick timer of this core count down from its maximum 24-bit value once per CPU cycle, without triggering interrupts.
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0xFFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+uint32_t Profiler::now()
+{
+    return systick_hw->cvr;
+}
+
+void Profiler::record(ProfilerStage stage, uint32_t cycles)
+{
+    stages[(uint8_t)stage].add(cycles);
+}
+
+void Profiler::record(ProfilerStage stage, uint8_t key, uint32_t cycles)
+{
+    keys[(uint8_t)stage][key].add(cycles);
+}
+
+void Profiler::snapshot()
+{
+#ifdef USE_DUAL_CORE_SCANNING
+    // The stages of the key pipeline are measured on the scanning core, so their snapshot is taken by that core after its next scan, which is
+    // waited for here. This way, the histograms are never read or reset while a measurement is being recorded into them on the other core.
+    snapshotRequested.store(true, std::memory_order_release);
+    while (snapshotRequested.load(std::memory_order_acquire))
+        tight_loop_contents();
+
+    // The report stage is measured on this core, as the HID reports are sent from it.
+    moveToSnapshot(false, true);
+#else
+    // All stages are measured on this core, so no measurement can be recorded while the snapshot is taken.
+    moveToSnapshot(true, true);
+#endif
+}
+
+void Profiler::update()
+{
+    // Take the snapshot of the stages measured on the scanning core if it has been requested by the other core.
+    if (!snapshotRequested.load(std::memory_order_acquire))
+        return;
+
+    moveToSnapshot(true, false);
+    snapshotRequested.store(false, std::memory_order_release);
+}
+
+void Profiler::moveToSnapshot(bool scanningStages, bool reportStage)
+{
+    // Copy the histograms of the specified stages into the snapshot and reset them, so the next snapshot only covers the time since this one.
+    for (uint8_t stage = 0; stage < (uint8_t)ProfilerStage::Count; stage++)
+    {
+        const bool selected = stage == (uint8_t)ProfilerStage::Report ? reportStage : scanningStages;
+        if (!selected)
+            continue;
+
+        stageSnapshots[stage] = stages[stage];
+        stages[stage].reset();
+        if (stage >= perKeyStages)
+            continue;
+
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+        {
+            keySnapshots[stage][i] = keys[stage][i];
+            keys[stage][i].reset();
+        }
+    }
+}
+#endif
@@ -0,0 +1,42 @@
+#include "helpers/report_scheduler.hpp"
+
+void ReportScheduler::onFrame(uint16_t frame, uint32_t now)
+{
+    // Check whether a new frame has started.
+    if (frame == this->frame)
+        return;
+
+    // If no report was pending during the previous frame, the report of that frame has been skipped. Otherwise, the report
+    // missed its frame, e.g. because the HID interface was busy, and is sent as soon as possible instead of waiting for the next SOF.
+    if (pending)
+        overdue = true;
+    else
+        reportsSkipped++;
+
+    this->frame = frame;
+    frameStartedAt = now;
+}
+
+void ReportScheduler::onChange()
+{
+    // If a report is already pending, the change is merged into it.
+    if (pending)
+        reportsCoalesced++;
+
+    pending = true;
+}
+
+bool ReportScheduler::isDue(uint32_t now) const
+{
+    // A pending report is due once the next SOF is less than the lead time away, or right away if it missed its frame. If no SOF
+    // is received anymore, e.g. while the USB bus is suspended, the time since the last one exceeds the frame period and the report is due.
+    return pending && (overdue || now - frameStartedAt >= framePeriod - HID_REPORT_SOF_LEAD);
+}
+
+void ReportScheduler::onSent()
+{
+    // Reset the pending state after the report has been sent.
+    pending = false;
+    overdue = false;
+    reportsSent++;
+}
@@ -0,0 +1,51 @@
+#include "helpers/scan_scheduler.hpp"
+
+void ScanScheduler::setRate(uint16_t rate, uint32_t now)
+{
+    // Restart the schedule with the new rate, with the first scan being due right away.
+    this->rate = rate;
+    period = 1000000 / rate;
+    nextDue = now;
+    started = false;
+}
+
+void ScanScheduler::onScanStart(uint32_t now)
+{
+    // Measure the deviation of the time since the previous scan from the period.
+    if (started)
+    {
+        const uint32_t elapsed = now - lastStart;
+        const uint32_t jitter = elapsed > period ? elapsed - period : period - elapsed;
+        if (jitter > maxJitter)
+            maxJitter = jitter;
+    }
+
+    started = true;
+    lastStart = now;
+    scans++;
+
+    // Schedule the next scan relative to the due time of this one to not accumulate any drift. If the scan fell
+    // behind by a whole period or more, skip the missed scans instead of running them back-to-back.
+    nextDue += period;
+    if ((int32_t)(now - nextDue) >= 0)
+    {
+        nextDue = now + period;
+        overruns++;
+    }
+}
+
+void ScanScheduler::onScanEnd(uint32_t now)
+{
+    // Measure the duration of the scan.
+    const uint32_t duration = now - lastStart;
+    if (duration > maxDuration)
+        maxDuration = duration;
+}
+
+void ScanScheduler::resetStats()
+{
+    scans = 0;
+    overruns = 0;
+    maxJitter = 0;
+    maxDuration = 0;
+}
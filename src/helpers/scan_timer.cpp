@@ -0,0 +1,69 @@
+#include <Arduino.h>
+#include "helpers/scan_timer.hpp"
+#include "config/configuration_controller.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+}
+
+// Forward the interrupt of the hardware alarm to the ScanTimer instance.
+static void onAlarmInterrupt(unsigned int)
+{
+    ScanTimer.onAlarm();
+}
+
+void ScanTimer::begin()
+{
+    // Claim a hardware alarm, with its interrupt being enabled on this core, and start the schedule with the first scan being due right away.
+    alarm = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(alarm, &onAlarmInterrupt);
+    scheduler.setRate(ConfigController.config.scanRate, micros());
+    fired = true;
+}
+
+bool ScanTimer::poll()
+{
+    // Check whether the alarm of the next scan fired.
+    if (!fired)
+        return false;
+
+    // Restart the schedule if another rate has been set in the configuration.
+    if (scheduler.getRate() != ConfigController.config.scanRate)
+        scheduler.setRate(ConfigController.config.scanRate, micros());
+
+    // Start the scan and arm the alarm for the next one.
+    fired = false;
+    scheduler.onScanStart(micros());
+    arm();
+    return true;
+}
+
+void ScanTimer::wait()
+{
+    // Sleep until the alarm of the next scan fires, as the interrupt wakes the core up.
+    while (!poll())
+        __wfe();
+}
+
+void ScanTimer::finish()
+{
+    // Mark the scan as finished to record its duration.
+    scheduler.onScanEnd(micros());
+}
+
+void ScanTimer::arm()
+{
+    // Set the alarm to the due time of the next scan, converting it to the 64-bit time of the timer. If the due time already
+    // passed while the alarm was being set, the alarm does not fire, so the scan is started right away instead.
+    const uint64_t target = time_us_64() + (int32_t)(scheduler.getNextDue() - micros());
+    if (hardware_alarm_set_target(alarm, from_us_since_boot(target)))
+        fired = true;
+}
+
+void ScanTimer::onAlarm()
+{
+    // Signal the scanning code that the next scan is due.
+    fired = true;
+}
@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include "helpers/serial_reader.hpp"
+#include "helpers/crc16.hpp"
+
+SerialReader::Input SerialReader::feed(uint8_t byte)
+{
+    // If a binary frame is being read but no byte has been received for too long, discard it. This way, a truncated frame
+    // cannot swallow the following input. The byte is then handled as the start of a new line or binary frame.
+    if (state != State::Line && millis() - lastFrameByte >= BINARY_FRAME_TIMEOUT)
+        reset();
+
+    switch (state)
+    {
+    case State::Line:
+    {
+        // If the line starts with the magic byte, read a binary frame instead.
+        if (length == 0 && !overflowed && byte == BINARY_FRAME_MAGIC)
+        {
+            state = State::FrameLength;
+            frameLength = 0;
+            lastFrameByte = millis();
+            return Input::None;
+        }
+
+        // Check whether the character finishes the line.
+        if (byte == '\n')
+        {
+            // Terminate the line and reset the reader for the next line. If the line overflowed, it is discarded.
+            const bool complete = !overflowed;
+            buffer[length] = '\0';
+            reset();
+
+            return complete ? Input::Line : Input::None;
+        }
+
+        // Ignore carriage returns, allowing lines to be terminated with both \n and \r\n.
+        if (byte == '\r')
+            return Input::None;
+
+        // Append the character to the line if there is space left for it and the null-terminator, otherwise mark the line as overflowed.
+        if (length < SERIAL_INPUT_BUFFER_SIZE - 1)
+            buffer[length++] = byte;
+        else
+            overflowed = true;
+
+        return Input::None;
+    }
+
+    case State::FrameLength:
+    {
+        // Read the little-endian length of the payload.
+        lastFrameByte = millis();
+        frameLength |= byte << (8 * length++);
+        if (length < 2)
+            return Input::None;
+
+        // Start the checksum over the length and read the payload next. Payloads exceeding the buffer are read but discarded.
+        const uint8_t lengthBytes[2] = {(uint8_t)frameLength, (uint8_t)(frameLength >> 8)};
+        frameChecksum = CRC16::compute(lengthBytes, 2);
+        overflowed = frameLength > SERIAL_INPUT_BUFFER_SIZE;
+        state = State::FramePayload;
+        length = 0;
+
+        return Input::None;
+    }
+
+    case State::FramePayload:
+    {
+        // Append the byte to the payload and the checksum. The last two bytes are the little-endian checksum of the frame itself.
+        lastFrameByte = millis();
+        if (length < frameLength)
+        {
+            if (!overflowed)
+            {
+                buffer[length] = byte;
+                frameChecksum = CRC16::compute(&byte, 1, frameChecksum);
+            }
+        }
+        else
+            frameChecksum ^= byte << (8 * (length - frameLength));
+
+        // Check whether the frame is complete.
+        if (++length < frameLength + 2u)
+            return Input::None;
+
+        // The frame is only valid if it did not overflow and the checksum matches, leaving the xor-ed checksum at 0.
+        const bool valid = !overflowed && frameChecksum == 0;
+        const uint16_t payloadLength = frameLength;
+        reset();
+        frameLength = payloadLength;
+
+        return valid ? Input::Frame : Input::None;
+    }
+    }
+
+    return Input::None;
+}
+
+void SerialReader::reset()
+{
+    // Reset the reader to read a new line.
+    state = State::Line;
+    length = 0;
+    overflowed = false;
+    frameLength = 0;
+}
@@ -0,0 +1,99 @@
+#include <Arduino.h>
+#include "helpers/serial_writer.hpp"
+#include "helpers/crc16.hpp"
+
+bool SerialWriter::printf(const char *format, ...)
+{
+    // Format the message into a temporary buffer.
+    char message[SERIAL_OUTPUT_MAX_MESSAGE_SIZE];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (length < 0)
+        return false;
+
+    // Drop the message as a whole if it does not fit into the temporary buffer, as it would be cut off, losing its newline character.
+    if (length >= (int)sizeof(message))
+    {
+        bytesDropped += length;
+        return false;
+    }
+
+    // Queue the formatted message.
+    return write((const uint8_t *)message, length);
+}
+
+bool SerialWriter::println(const char *str)
+{
+    // Check whether the string and the newline character fit into the buffer together, as the message may not be split up.
+    const size_t length = strlen(str);
+    if (capacity - size < length + 1)
+    {
+        bytesDropped += length + 1;
+        return false;
+    }
+
+    // Queue the string and the newline character.
+    return write((const uint8_t *)str, length) && write((const uint8_t *)"\n", 1);
+}
+
+bool SerialWriter::write(const uint8_t *data, size_t length)
+{
+    // If the data does not fit into the buffer, drop it as a whole.
+    if (capacity - size < length)
+    {
+        bytesDropped += length;
+        return false;
+    }
+
+    // Copy the data into the circular buffer, in two parts if it wraps around the end of the buffer.
+    const size_t end = (start + size) % capacity;
+    const size_t firstPart = min(length, capacity - end);
+    memcpy(buffer + end, data, firstPart);
+    memcpy(buffer, data + firstPart, length - firstPart);
+
+    // Update the size and the statistics.
+    size += length;
+    bytesQueued += length;
+    if (size > maxDepth)
+        maxDepth = size;
+
+    return true;
+}
+
+bool SerialWriter::writeFrame(const uint8_t *payload, uint16_t length)
+{
+    // Check whether the whole frame fits into the buffer, as the frame may not be split up.
+    // The frame consists of the magic byte, the length, the payload and the checksum.
+    if (capacity - size < length + 5u)
+    {
+        bytesDropped += length + 5u;
+        return false;
+    }
+
+    // Build the header and the checksum, which is calculated over the length and the payload.
+    const uint8_t header[3] = {BINARY_FRAME_MAGIC, (uint8_t)length, (uint8_t)(length >> 8)};
+    const uint16_t crc = CRC16::compute(payload, length, CRC16::compute(header + 1, 2));
+    const uint8_t footer[2] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+
+    // Queue the whole frame.
+    return write(header, sizeof(header)) && write(payload, length) && write(footer, sizeof(footer));
+}
+
+void SerialWriter::flush()
+{
+    // Write as many bytes as the serial interface can take without blocking. This is done in two
+    // parts if the data wraps around the end of the buffer, as the bytes have to be passed contiguously.
+    size_t available = Serial.availableForWrite();
+    while (available > 0 && size > 0)
+    {
+        const size_t length = min(available, min((size_t)size, capacity - start));
+        Serial.write(buffer + start, length);
+
+        start = (start + length) % capacity;
+        size -= length;
+        available -= length;
+    }
+}
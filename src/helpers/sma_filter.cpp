@@ -1,4 +1,3 @@
-#include <Arduino.h>
 #include "helpers/sma_filter.hpp"
 
 // On the call operator the next value is given into the filter, with the new average being returned.
@@ -13,10 +12,14 @@ uint16_t SMAFilter::operator()(uint16_t value)
     // Move the index by 1 or restart at 0 if the end is reached.
     index = (index + 1) % samples;
 
-    // If the index is 0 here (meaning the circular index just reset), set the fully initialized state to true.
-    if(index == 0)
-        initialized = true;
-
     // Divide the number by the amount of samples using bitshifting and return it.
     return sum >> samplesExponent;
 }
+
+void SMAFilter::reset(uint16_t value)
+{
+    // Fill the whole buffer with the value and update the sum accordingly.
+    for (uint16_t &element : buffer)
+        element = value;
+    sum = (uint32_t)value << samplesExponent;
+}
@@ -1,50 +1,65 @@
-#include <Arduino.h>
+#include <cctype>
 #include "helpers/string_helper.hpp"
 
-void StringHelper::getArgumentAt(const char* input, char delimiter, uint8_t index, char* output)
+std::string_view StringHelper::nextToken(std::string_view &input, char delimiter)
 {
-    // Remember the amount of found elements, start and end index of the current one and the total length.
-    uint8_t found = 0;
-    size_t start = 0;
-    size_t length = strlen(input);
+    // Find the delimiter. If there is none, the whole input is the token and nothing remains.
+    const size_t position = input.find(delimiter);
+    if (position == std::string_view::npos)
+    {
+        const std::string_view token = input;
+        input = std::string_view();
+        return token;
+    }
+
+    // Split the input at the delimiter, with the input continuing after it. No characters are being copied.
+    const std::string_view token = input.substr(0, position);
+    input.remove_prefix(position + 1);
+    return token;
+}
 
-    // Go through all characters and count the delimiters until the desired index was reached.
-    for (size_t i = 0; i <= length; i++)
+int32_t StringHelper::parseInt(std::string_view str)
+{
+    // Parse the sign, if specified.
+    bool negative = false;
+    if (!str.empty() && (str[0] == '-' || str[0] == '+'))
     {
-        // Check if a delimiter was found.
-        if (i == length || input[i] == delimiter)
-        {
-           // If we found the desired index, fill the specified output buffer with the argument
-           // as the substring of the input if the element was found.
-            if (found == index) {
-                memcpy(output, input + start, i - start);
-                output[i - start] = '\0';
-                return;
-            }
-
-            // Otherwise, increment the found count and update the start index.
-            found++;
-            start = i + 1;
-        }
+        negative = str[0] == '-';
+        str.remove_prefix(1);
     }
 
-    // If not enough elements for the desired index were found, set the output buffer to an empty string.
-    output[0] = '\0';
+    // Parse the digits until the first non-digit character, like atoi does.
+    int32_t value = 0;
+    for (const char c : str)
+    {
+        if (c < '0' || c > '9')
+            break;
+
+        value = value * 10 + (c - '0');
+    }
+
+    return negative ? -value : value;
+}
+
+bool StringHelper::parseBool(std::string_view str)
+{
+    // Interpret "1" and "true" as true, everything else as false.
+    return str == "1" || str == "true";
 }
 
 void StringHelper::toLower(char *input)
 {
-    // Go through all characters and replace them with their lowercase version.
-    for (size_t i = 0; i < strlen(input); i++)
-        input[i] = tolower(input[i]);
+    // Go through all characters until the null-terminator and replace them with their lowercase version.
+    for (; *input; input++)
+        *input = std::tolower(*input);
 }
 
 void StringHelper::replace(char *input, char target, char replacement)
 {
-    // Go through all characters and replace it if it matches the target character.
-    for (size_t i = 0; i < strlen(input); i++)
-        if (input[i] == target)
-            input[i] = replacement;
+    // Go through all characters until the null-terminator and replace it if it matches the target character.
+    for (; *input; input++)
+        if (*input == target)
+            *input = replacement;
 }
 
 void StringHelper::makeSafename(char *str)
@@ -56,7 +71,7 @@ void StringHelper::makeSafename(char *str)
 
     // Skip all characters by moving the src pointer forward until the character array reached the end or
     // a non-whitespace character is encountered. This ignores all leading whitespaces of the character array.
-    while (*src && isspace(*src))
+    while (*src && std::isspace(*src))
         src++;
 
     // Go through the input char array with our separate pointer until it reached the zero terminator.
@@ -64,7 +79,7 @@ void StringHelper::makeSafename(char *str)
     {
         // If the current character is not a whitespace or a whitespace and different from the previous character,
         // put the character into the position our str pointer is currently pointing at, replacing the character array on the fly.
-        if (!isspace(*src) || *src != *(src - 1))
+        if (!std::isspace(*src) || *src != *(src - 1))
         {
             *str = *src;
 
@@ -77,7 +92,7 @@ void StringHelper::makeSafename(char *str)
     }
 
     // Remove a whitespace at the end if one exists. Only one at most can exist there as we compacted consecutive whitespaces before.
-    if (isspace(*(str - 1)))
+    if (std::isspace(*(str - 1)))
         str--;
 
     // Append the null terminator that finishes the string at that position. This is important since we are modifying the input
@@ -1,14 +1,32 @@
 #include <Arduino.h>
+#include <atomic>
 #include <EEPROM.h>
 #include <Keyboard.h>
 #include "config/configuration_controller.hpp"
 #include "handlers/serial_handler.hpp"
+#include "handlers/binary_handler.hpp"
 #include "handlers/key_handler.hpp"
+#include "handlers/analog_handler.hpp"
+#include "handlers/telemetry_handler.hpp"
+#include "handlers/trace_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/profiler.hpp"
+#include "helpers/serial_reader.hpp"
+#include "helpers/serial_writer.hpp"
 #include "definitions.hpp"
 
+// Bool whether the setup of the first core has finished. Used to hold back the scanning on the second core
+// until the configuration has been loaded and the ADC has been set up with the correct resolution.
+std::atomic<bool> setupFinished = false;
+
+// The reader assembling the serial input into lines and binary frames without blocking.
+SerialReader serialReader;
+
 void setup()
 {
-    // Initialize the EEPROM with 1024 bytes and load the configuration from it.
+    // Initialize the EEPROM with 1024 bytes and load the configuration from the journal, or the EEPROM if the journal is empty.
     EEPROM.begin(1024);
     ConfigController.loadConfig();
 
@@ -16,6 +34,10 @@ void setup()
     Serial.begin(115200);
     Keyboard.begin();
     Keyboard.setAutoReport(false);
+    KeyHandler.begin();
+#ifdef USE_ANALOG_HID
+    AnalogHandler.begin();
+#endif
 
     // Set the amount of bits for the ADC to the defined one for a better resolution on the analog readings.
     analogReadResolution(ANALOG_RESOLUTION);
@@ -24,27 +46,104 @@ void setup()
     for(int i = 0; i < DIGITAL_KEYS; i++)
         pinMode(DIGITAL_PIN(i), INPUT_PULLUP);
 
+#ifndef USE_DUAL_CORE_SCANNING
+    // Start sampling the Hall Effect and digital keys and the scan timer on this core, as it is the one scanning the keys.
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+#endif
+
+#ifdef USE_PROFILER
+    // Start the cycle counter of this core for the profiler.
+    Profiler.begin();
+#endif
+
     // Allows to boot into UF2 bootloader mode by pressing the reset button twice.
     rp2040.enableDoubleResetBootloader();
+
+    // Signal the second core that the setup has finished and scanning can begin.
+    setupFinished = true;
 }
 
 void loop()
 {
+#ifdef USE_DUAL_CORE_SCANNING
+    // Send the key transitions queued by the scanning core via the HID interface.
+    KeyHandler.report();
+#else
     // Run the keypad handler checks to handle the actual keypad functionality.
     KeyHandler.handle();
+#endif
+
+#ifdef USE_ANALOG_HID
+    // Report the distances of the Hall Effect keys as the axes of the gamepad, giving way to pending keyboard reports.
+    AnalogHandler.report(KeyHandler.heKeyStates.distances, KeyHandler.reportScheduler.isPending());
+#endif
+
+    // Save the calibration of the keys once it changed considerably, so it can be restored at the next bootup.
+    KeyHandler.storeCalibration();
+
+    // Commit a pending save of the configuration if no key is pressed, as the keys cannot be scanned while the flash is written.
+    ConfigController.update(KeyHandler.isIdle());
+
+    // Move the captured telemetry frames into the serial output.
+    TelemetryHandler.flush();
+
+#ifdef USE_TRACE
+    // Move the blocks of a trace being dumped into the serial output.
+    TraceHandler.flush();
+#endif
+
+    // Pass as much of the buffered serial output to the serial interface as it can take without blocking.
+    SerialWriter.flush();
+}
+
+#ifdef USE_DUAL_CORE_SCANNING
+void setup1()
+{
+    // Wait for the first core to finish the setup before starting to scan the keys.
+    while (!setupFinished)
+        tight_loop_contents();
+
+    // Start sampling the Hall Effect and digital keys and the scan timer on this core, as it is the one scanning the keys.
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+
+#ifdef USE_PROFILER
+    // Start the cycle counter of this core for the profiler.
+    Profiler.begin();
+#endif
+}
+
+void loop1()
+{
+    // Wait for the scan timer to start the next scan, keeping the scan rate fixed.
+    ScanTimer.wait();
+
+    // Run the keypad handler scans, queueing all key transitions for the first core.
+    KeyHandler.scan();
+    ScanTimer.finish();
 }
+#endif
 
 void serialEvent()
 {
-    // Handle incoming serial data.
-    while(Serial.available() > 0)
+    // Only read the serial data that is already available, never waiting for more to arrive, and limit the amount of bytes read per call.
+    int available = min(Serial.available(), SERIAL_INPUT_MAX_BYTES_PER_LOOP);
+    while (available-- > 0)
     {
-        // Read the incoming serial data until a newline into a buffer and terminate it with a null terminator.
-        char input[SERIAL_INPUT_BUFFER_SIZE];
-        const size_t length = Serial.readBytesUntil('\n', input, SERIAL_INPUT_BUFFER_SIZE);
-        input[length] = '\0';
+        // Feed the incoming serial data into the serial reader until a line or binary frame is complete.
+        const SerialReader::Input input = serialReader.feed(Serial.read());
+        if (input == SerialReader::Input::None)
+            continue;
 
-        // Pass the read input to the serial handler to handle it.
-        SerialHandler.handleSerialInput(input);
+        // Pass the read line to the serial handler or the binary frame to the binary handler. Only handle one input
+        // per call to limit the time spent, the remaining data is handled on the next call.
+        if (input == SerialReader::Input::Line)
+            SerialHandler.handleSerialInput(serialReader.getLine());
+        else
+            BinaryHandler.handleFrame(serialReader.getPayload(), serialReader.getPayloadLength());
+        break;
     }
 }
@@ -0,0 +1,275 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Keyboard.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/serial_reader.hpp"
+#include "helpers/serial_writer.hpp"
+#include "helpers/sma_filter.hpp"
+#include "helpers/gauss_lut.hpp"
+#include "helpers/string_helper.hpp"
+#include "definitions.hpp"
+
+// The benchmarks of the key pipeline and the serial parser, run on the host against the simulated hardware. Every benchmark runs
+// a fixed workload several times and reports the fastest run, which is the least affected by other processes on the host. The
+// results are printed as "BENCH <name> <nanoseconds> ns/<unit> keys=<HE_KEYS>", so runs of different commits can be compared line by line.
+// The per-key scaling is measured by running the suite in the native-bench-1k to native-bench-4k environments.
+
+// The amount of runs of every benchmark, and the amount of scans, commands and samples per run.
+static constexpr uint8_t runs = 7;
+static constexpr uint32_t scans = 20000;
+static constexpr uint32_t commands = 20000;
+static constexpr uint32_t samples = 1000000;
+
+// The sensor values of a key at rest and fully pressed, matching the default gauss correction parameters.
+static constexpr uint16_t restValue = 2040;
+static constexpr uint16_t downValue = 1150;
+
+// A deterministic pseudo-random number generator for the sensor noise, so every run sees the same input.
+static uint32_t noiseState = 1;
+static int8_t noise()
+{
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return (int8_t)((noiseState >> 24) % 9) - 4;
+}
+
+// Returns the sensor value of the specified key in the specified scan, with every key moving up and down at its own speed,
+// taking 100ms for a full press and release of the first key at the default scan rate, and a bit longer for every further key.
+static uint16_t keyValue(uint8_t key, uint32_t scan)
+{
+    const uint32_t period = 800 + key * 160;
+    const uint32_t phase = scan % period;
+    const uint32_t travel = phase < period / 2 ? phase : period - phase;
+    return restValue - (restValue - downValue) * travel / (period / 2) + noise();
+}
+
+// Runs the specified workload the configured amount of times and returns the time of the fastest run in nanoseconds.
+template <typename Workload>
+static double measure(Workload workload)
+{
+    double best = 0;
+    for (uint8_t i = 0; i < runs; i++)
+    {
+        noiseState = 1;
+        const double nanoseconds = workload();
+        if (i == 0 || nanoseconds < best)
+            best = nanoseconds;
+    }
+
+    return best;
+}
+
+// Prints the result of a benchmark in the format compared across commits.
+static void report(const char *name, const char *unit, double nanoseconds)
+{
+    printf("BENCH %s %.1f ns/%s keys=%d\n", name, nanoseconds, unit, HE_KEYS);
+}
+
+// The amount of keyboard reports sent during the last scans run, checked to make sure the keys actually actuate.
+static uint32_t sentReports = 0;
+
+// Returns the nanoseconds elapsed since the specified time point of the steady clock.
+static double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs the full handle path for the configured amount of scans, advancing the simulated time by one scan period in between.
+// Only the time spent in the firmware is measured, not the simulated hardware running the ADC and the alarm between the scans.
+static double runScans(bool moving)
+{
+    const uint32_t period = 1000000 / ConfigController.config.scanRate;
+    double nanoseconds = 0;
+    sentReports = 0;
+    for (uint32_t scan = 0; scan < scans; scan++)
+    {
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+            Simulator.setAnalogValue(HE_PIN(i), moving ? keyValue(i, scan) : restValue + noise());
+
+        Simulator.advance(period);
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        KeyHandler.handle();
+        nanoseconds += elapsed(start);
+
+        sentReports += Simulator.keyboardReports.size();
+        Simulator.keyboardReports.clear();
+    }
+
+    return nanoseconds;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_handle_idle()
+{
+    // Keys resting with sensor noise, which is the most common case.
+    const double nanoseconds = measure([] { return runScans(false); });
+    report("handle_idle", "scan", nanoseconds / scans);
+    report("handle_idle_per_key", "sample", nanoseconds / scans / HE_KEYS);
+    TEST_ASSERT_EQUAL(0, sentReports);
+}
+
+void test_handle_traditional()
+{
+    // Keys moving up and down continuously, actuating with the hysteresis.
+    for (HEKeyConfig &config : ConfigController.config.heKeys)
+        config.rapidTrigger = false;
+    KeyHandler.requestConfigSync();
+
+    const double nanoseconds = measure([] { return runScans(true); });
+    report("handle_traditional", "scan", nanoseconds / scans);
+    report("handle_traditional_per_key", "sample", nanoseconds / scans / HE_KEYS);
+    TEST_ASSERT_NOT_EQUAL(0, sentReports);
+}
+
+void test_handle_rapid_trigger()
+{
+    // Keys moving up and down continuously, actuating with continuous rapid trigger and predictive actuation.
+    for (HEKeyConfig &config : ConfigController.config.heKeys)
+    {
+        config.rapidTrigger = true;
+        config.continuousRapidTrigger = true;
+        config.predictiveActuation = true;
+    }
+    KeyHandler.requestConfigSync();
+
+    const double nanoseconds = measure([] { return runScans(true); });
+    report("handle_rapid_trigger", "scan", nanoseconds / scans);
+    report("handle_rapid_trigger_per_key", "sample", nanoseconds / scans / HE_KEYS);
+    TEST_ASSERT_NOT_EQUAL(0, sentReports);
+}
+
+void test_serial_commands()
+{
+    // A mix of commands as sent by the configuration software, each being fed byte by byte through the serial reader and handled.
+    static const char *const lines[] = {"hkey1.rt=1\n", "hkey.rtus=35\n", "hkey2.lh=220\n", "dkey.hid=1\n", "hkey1.filter=1\n", "echo ping\n"};
+    const double nanoseconds = measure([]
+    {
+        SerialReader reader;
+        double nanoseconds = 0;
+        for (uint32_t i = 0; i < commands; i++)
+        {
+            const char *line = lines[i % (sizeof(lines) / sizeof(*lines))];
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (const char *c = line; *c; c++)
+                if (reader.feed(*c) == SerialReader::Input::Line)
+                    SerialHandler.handleSerialInput(reader.getLine());
+            nanoseconds += elapsed(start);
+
+            // Drain the output of the echo command outside of the measurement.
+            SerialWriter.flush();
+            Simulator.readSerialOutput();
+        }
+
+        return nanoseconds;
+    });
+    report("serial_command", "command", nanoseconds / commands);
+}
+
+void test_sma_filter()
+{
+    const double nanoseconds = measure([]
+    {
+        SMAFilter filter;
+        filter.reset(restValue);
+        uint32_t sum = 0;
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < samples; i++)
+            sum += filter(keyValue(0, i));
+        const double nanoseconds = elapsed(start);
+
+        // Use the result, so the filter is not optimized away.
+        TEST_ASSERT_NOT_EQUAL(0, sum);
+        return nanoseconds;
+    });
+    report("sma_filter", "sample", nanoseconds / samples);
+}
+
+void test_gauss_lut()
+{
+    const double nanoseconds = measure([]
+    {
+        static constexpr GaussLUT lut = GaussLUT();
+        uint32_t sum = 0;
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < samples; i++)
+            sum += lut.adcToDistance(keyValue(0, i), restValue);
+        const double nanoseconds = elapsed(start);
+
+        TEST_ASSERT_NOT_EQUAL(0, sum);
+        return nanoseconds;
+    });
+    report("gauss_lut", "sample", nanoseconds / samples);
+}
+
+void test_string_helper()
+{
+    const double nanoseconds = measure([]
+    {
+        static const std::string_view values[] = {"0", "35", "220", "400", "-1", "12x"};
+        int64_t sum = 0;
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < samples; i++)
+            sum += StringHelper::parseInt(values[i % (sizeof(values) / sizeof(*values))]);
+        const double nanoseconds = elapsed(start);
+
+        TEST_ASSERT_NOT_EQUAL(0, sum);
+        return nanoseconds;
+    });
+    report("string_helper_parse_int", "call", nanoseconds / samples);
+}
+
+int main()
+{
+    // Boot the firmware like the setup of both cores does, with the scanning being driven by the benchmarks instead of the second core.
+    EEPROM.begin(1024);
+    ConfigController.loadConfig();
+    Keyboard.begin();
+    Keyboard.setAutoReport(false);
+    KeyHandler.begin();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        Simulator.setAnalogValue(HE_PIN(i), restValue);
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+
+    // Enable the HID output of all keys, so the benchmarks include building and sending the keyboard reports.
+    for (HEKeyConfig &config : ConfigController.config.heKeys)
+        config.hidEnabled = true;
+    KeyHandler.requestConfigSync();
+
+    // Calibrate the keys by pressing them down fully a few times, outside of the measurements.
+    // Let the keys come to rest afterwards, so the first benchmark does not start with pressed keys.
+    noiseState = 1;
+    runScans(true);
+    runScans(false);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_handle_idle);
+    RUN_TEST(test_handle_traditional);
+    RUN_TEST(test_handle_rapid_trigger);
+    RUN_TEST(test_serial_commands);
+    RUN_TEST(test_sma_filter);
+    RUN_TEST(test_gauss_lut);
+    RUN_TEST(test_string_helper);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include <unity.h>
+#include <cstdio>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests the sampling of the Hall Effect keys through the simulated analog multiplexers, checking that every key is read from its channel
+// only after the multiplexers settled, that switching the channel overlaps with storing the samples and processing the keys, and that the
+// keys work through the whole key pipeline. Also reports the time reading all keys takes, which limits the scan rate.
+
+// The amount of channels per multiplexer, the amount of multiplexers and the amount of channels in use.
+static constexpr uint8_t channels = 1 << ANALOG_MULTIPLEXER_SELECT_BITS;
+static constexpr uint8_t multiplexers = (HE_KEYS + channels - 1) / channels;
+static constexpr uint8_t activeChannels = HE_KEYS < channels ? HE_KEYS : channels;
+
+// The time one conversion of the ADC takes in microseconds.
+static constexpr uint32_t conversionTime = 2;
+
+// Sets the sensor value of the specified key on its multiplexer channel.
+static void setValue(uint8_t key, uint16_t value)
+{
+    Simulator.multiplexers.values[key / channels][key % channels] = value;
+}
+
+// Reads the sensors of all keys through the sampler, checking the values against the base value plus the index of the key.
+// Returns the time the read took in microseconds.
+static uint32_t readValues(uint16_t base)
+{
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        setValue(i, base + i);
+
+    uint16_t values[HE_KEYS];
+    uint32_t sampledAt;
+    const uint64_t start = Simulator.getTime();
+    TEST_ASSERT_TRUE(ADCSampler.read(values, sampledAt));
+    const uint32_t duration = Simulator.getTime() - start;
+
+    TEST_ASSERT_EQUAL_UINT32(start, sampledAt);
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        TEST_ASSERT_EQUAL_UINT16(base + i, values[i]);
+
+    return duration;
+}
+
+// Runs the key handler for the specified amount of scans, like the main loop does.
+static void runScans(uint32_t scans)
+{
+    for (uint32_t i = 0; i < scans; i++)
+    {
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+    }
+}
+
+void setUp()
+{
+    Simulator.multiplexers.unsettledReads = 0;
+}
+
+void tearDown()
+{
+}
+
+void test_keys_are_read_from_their_channels()
+{
+    // Every key is read from its channel once settled, with the first channel being selected again for the next read.
+    for (uint16_t base = 1000; base < 3000; base += 500)
+        readValues(base);
+
+    TEST_ASSERT_EQUAL(0, Simulator.multiplexers.unsettledReads);
+    TEST_ASSERT_EQUAL(0, Simulator.multiplexers.selectedChannel);
+}
+
+void test_settling_overlaps()
+{
+    // A read right after the previous one has to wait for the first channel to settle, while a later read does not, as the first channel
+    // settles while the keys are being processed. Reading all channels takes at most the settle time plus the conversions per channel.
+    const uint32_t readTime = activeChannels * (ANALOG_MULTIPLEXER_SETTLE_TIME + 1 + multiplexers * conversionTime);
+    readValues(1000);
+    const uint32_t immediate = readValues(1000);
+    Simulator.advance(100);
+    const uint32_t delayed = readValues(1000);
+
+    TEST_ASSERT_LESS_OR_EQUAL(readTime, immediate);
+    TEST_ASSERT_LESS_THAN(immediate, delayed);
+    TEST_ASSERT_EQUAL(0, Simulator.multiplexers.unsettledReads);
+    TEST_ASSERT_LESS_OR_EQUAL(1000000 / SCAN_RATE_MAX / 2, immediate);
+    printf("BENCH mux_read %lu us/read keys=%d multiplexers=%d\n", (unsigned long)immediate, HE_KEYS, multiplexers);
+}
+
+void test_keys_through_pipeline()
+{
+    // Pressing a key on each multiplexer presses exactly these keys, with the others staying at rest.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        setValue(i, 2040);
+    ScanTimer.begin();
+    runScans(100);
+
+    for (uint8_t i = 0; i < HE_KEYS; i += channels + 3)
+        setValue(i, 1150);
+    runScans(100);
+
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        TEST_ASSERT_EQUAL(i % (channels + 3) == 0, static_cast<const Key &>(KeyHandler.heKeys[i]).pressed);
+        TEST_ASSERT_UINT16_WITHIN(8, i % (channels + 3) == 0 ? 1150 : 2040, KeyHandler.heKeyStates.rawValues[i]);
+    }
+
+    TEST_ASSERT_EQUAL(0, Simulator.multiplexers.unsettledReads);
+}
+
+int main()
+{
+    // Set up the simulated multiplexers matching the firmware.
+    Simulator.multiplexers.enabled = true;
+    Simulator.multiplexers.selectBits = ANALOG_MULTIPLEXER_SELECT_BITS;
+    Simulator.multiplexers.selectPinBase = ANALOG_MULTIPLEXER_SELECT_PIN_BASE;
+    Simulator.multiplexers.settleTime = ANALOG_MULTIPLEXER_SETTLE_TIME;
+
+    ConfigController.loadConfig();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        ConfigController.config.heKeys[i].hidEnabled = true;
+    ADCSampler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_keys_are_read_from_their_channels);
+    RUN_TEST(test_settling_overlaps);
+    RUN_TEST(test_keys_through_pipeline);
+    return UNITY_END();
+}
@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <random>
+#include <string>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests the actuation checks selected per key when the configuration changes against a model checking the mode of the key on
+// every scan, like the keys were checked before the checks were selected. The keys are moved randomly while their modes are
+// switched through the serial commands, comparing the pressed state of every key on every scan.
+static_assert(HE_KEYS >= 2, "The test requires at least two Hall Effect keys.");
+
+// The model of a Hall Effect key, checking the traditional hysteresis or the rapid trigger logic depending on the configuration.
+struct KeyModel
+{
+    HEKeyConfig config;
+    bool pressed = false;
+    bool inRapidTriggerZone = false;
+    uint16_t rapidTriggerPeak = UINT16_MAX;
+
+    void setPressed(bool pressed)
+    {
+        if (!config.hidEnabled && pressed)
+            return;
+
+        this->pressed = pressed;
+    }
+
+    void check(uint16_t distance)
+    {
+        if (!config.rapidTrigger)
+        {
+            if (distance <= config.lowerHysteresis)
+                setPressed(true);
+            else if (distance >= config.upperHysteresis)
+                setPressed(false);
+
+            return;
+        }
+
+        if (distance >= config.upperHysteresis && !config.continuousRapidTrigger)
+            inRapidTriggerZone = false;
+        else if (distance >= TRAVEL_DISTANCE_IN_0_01MM - CONTINUOUS_RAPID_TRIGGER_THRESHOLD && config.continuousRapidTrigger)
+            inRapidTriggerZone = false;
+
+        if (distance <= config.lowerHysteresis && !inRapidTriggerZone)
+        {
+            setPressed(true);
+            inRapidTriggerZone = true;
+        }
+        else if (!pressed && inRapidTriggerZone && distance + config.rapidTriggerDownSensitivity <= rapidTriggerPeak)
+            setPressed(true);
+        else if (pressed && (!inRapidTriggerZone || distance >= rapidTriggerPeak + config.rapidTriggerUpSensitivity))
+            setPressed(false);
+
+        if ((pressed && distance < rapidTriggerPeak) || (!pressed && distance > rapidTriggerPeak))
+            rapidTriggerPeak = distance;
+    }
+};
+
+static KeyModel models[HE_KEYS];
+
+// The random number generator moving the keys, seeded with a constant so every run moves the keys the same way.
+static std::mt19937 generator(5678);
+
+// The current sensor values, the values the keys are moving to and the speed they are moving at, per key.
+static int32_t values[HE_KEYS];
+static int32_t targets[HE_KEYS];
+static int32_t speeds[HE_KEYS];
+
+// Moves every key towards its target, picking a new target and speed once it has been reached. The targets are often close
+// to the current value, changing the direction of the key within the rapid trigger zone.
+static void moveKeys()
+{
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        if (values[i] == targets[i])
+        {
+            if (std::uniform_int_distribution<int32_t>(0, 1)(generator))
+                targets[i] = std::uniform_int_distribution<int32_t>(1100, 2100)(generator);
+            else
+                targets[i] = constrain(values[i] + std::uniform_int_distribution<int32_t>(-100, 100)(generator), 1100, 2100);
+            speeds[i] = std::uniform_int_distribution<int32_t>(1, 40)(generator);
+        }
+
+        values[i] += constrain(targets[i] - values[i], -speeds[i], speeds[i]);
+        Simulator.setAnalogValue(HE_PIN(i), values[i]);
+    }
+}
+
+// Runs the key handler for the specified amount of scans at the configured scan rate while moving the keys, comparing the pressed
+// state of every key with the model after every scan. Returns the amount of transitions of all keys.
+static uint32_t runScans(uint32_t scans)
+{
+    uint32_t transitions = 0;
+    for (uint32_t scan = 0; scan < scans; scan++)
+    {
+        moveKeys();
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+        {
+            const bool pressed = models[i].pressed;
+            models[i].check(KeyHandler.heKeyStates.distances[i]);
+            transitions += pressed != models[i].pressed;
+            TEST_ASSERT_EQUAL(models[i].pressed, KeyHandler.heKeys[i].pressed);
+        }
+    }
+
+    return transitions;
+}
+
+// Handles the specified serial command, updating the configurations of the models afterwards.
+static void handleCommand(const std::string &command)
+{
+    std::string line = command;
+    SerialHandler.handleSerialInput(line.data());
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        models[i].config = ConfigController.config.heKeys[i];
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_rapid_trigger_matches_model()
+{
+    // Enable rapid trigger on all keys, with different sensitivities per key.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        const std::string key = "hkey" + std::to_string(i + 1);
+        handleCommand(key + ".rt 1");
+        handleCommand(key + ".rtus " + std::to_string(10 + 15 * i));
+        handleCommand(key + ".rtds " + std::to_string(30 - 10 * i));
+    }
+
+    TEST_ASSERT_GREATER_THAN(100 * HE_KEYS, runScans(50000));
+}
+
+void test_continuous_rapid_trigger_matches_model()
+{
+    // Enable continuous rapid trigger on every other key.
+    for (uint8_t i = 0; i < HE_KEYS; i += 2)
+        handleCommand("hkey" + std::to_string(i + 1) + ".crt 1");
+
+    TEST_ASSERT_GREATER_THAN(100 * HE_KEYS, runScans(50000));
+}
+
+void test_switching_modes_matches_model()
+{
+    // Switch the mode of a random key every few scans while the keys are moving, including while they are pressed or inside the
+    // rapid trigger zone. The new check has to take over the state of the key at the next scan, like the mode was checked on every scan.
+    static const char *const settings[] = {".rt 0", ".rt 1", ".crt 0", ".crt 1"};
+    uint32_t transitions = 0;
+    for (uint16_t i = 0; i < 2000; i++)
+    {
+        const uint8_t key = std::uniform_int_distribution<int32_t>(1, HE_KEYS)(generator);
+        handleCommand("hkey" + std::to_string(key) + settings[std::uniform_int_distribution<int32_t>(0, 3)(generator)]);
+        transitions += runScans(std::uniform_int_distribution<int32_t>(1, 50)(generator));
+    }
+
+    TEST_ASSERT_GREATER_THAN(100 * HE_KEYS, transitions);
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of all Hall Effect keys enabled and the keys resting.
+    ConfigController.loadConfig();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        ConfigController.config.heKeys[i].hidEnabled = true;
+        models[i].config = ConfigController.config.heKeys[i];
+        values[i] = targets[i] = 2040;
+        Simulator.setAnalogValue(HE_PIN(i), values[i]);
+    }
+
+    KeyHandler.requestConfigSync();
+    ADCSampler.begin();
+    ScanTimer.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rapid_trigger_matches_model);
+    RUN_TEST(test_continuous_rapid_trigger_matches_model);
+    RUN_TEST(test_switching_modes_matches_model);
+    return UNITY_END();
+}
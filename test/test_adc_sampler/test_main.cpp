@@ -0,0 +1,170 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "definitions.hpp"
+
+// Tests the DMA sampling of the ADCSampler against the simulated ADC, which samples the inputs of all keys in a round-robin at the
+// configured sample rate and writes the samples into the buffers through the two chained DMA channels, like the hardware does.
+// Committing the configuration holds back the interrupts for as long as writing the flash takes, which the sampling has to survive.
+
+// The time it takes the simulated ADC to fill one buffer of the ring, in microseconds, rounded up.
+static constexpr uint32_t bufferTime = (1000000 * DMA_ADC_FRAMES_PER_BUFFER * HE_KEYS + DMA_ADC_SAMPLE_RATE - 1) / DMA_ADC_SAMPLE_RATE;
+
+// The time it takes the simulated ADC to sample one frame, in microseconds, rounded up.
+static constexpr uint32_t frameTime = (1000000 * HE_KEYS + DMA_ADC_SAMPLE_RATE - 1) / DMA_ADC_SAMPLE_RATE;
+
+// Sets the sensor values of all keys to the specified base value plus the index of the key, so every key has a distinct value.
+static void setValues(uint16_t base)
+{
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        Simulator.setAnalogValue(HE_PIN(i), base + i);
+}
+
+// Returns the time the newest completely filled buffer was completed at. The ADC has been started at the time 0, taking
+// a sample every sample period of the 48MHz ADC clock, with a buffer being completed by every DMA_ADC_FRAMES_PER_BUFFER frames.
+static uint32_t getLastCompletion()
+{
+    const uint64_t samplePeriod = 48000000 / DMA_ADC_SAMPLE_RATE;
+    const uint64_t bufferSamples = DMA_ADC_FRAMES_PER_BUFFER * HE_KEYS;
+    const uint64_t samples = Simulator.getTime() * 48 / samplePeriod / bufferSamples * bufferSamples;
+    return samples * samplePeriod / 48;
+}
+
+// Checks that the values read from the sampler are the ones set with the specified base value, sampled at the completion of the newest buffer.
+static void assertValues(uint16_t base)
+{
+    uint16_t values[HE_KEYS];
+    uint32_t sampledAt;
+    TEST_ASSERT_TRUE(ADCSampler.read(values, sampledAt));
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        TEST_ASSERT_EQUAL_UINT16(base + i, values[i]);
+
+    TEST_ASSERT_EQUAL_UINT32(getLastCompletion(), sampledAt);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_no_frame_before_first_buffer()
+{
+    // No values are available until the first buffer has been filled completely, as the buffers contain no samples before.
+    uint16_t values[HE_KEYS];
+    uint32_t sampledAt;
+    TEST_ASSERT_FALSE(ADCSampler.read(values, sampledAt));
+
+    Simulator.advance(bufferTime - frameTime);
+    TEST_ASSERT_FALSE(ADCSampler.read(values, sampledAt));
+}
+
+void test_first_buffer_completes_frame()
+{
+    // Once the first buffer has been filled, the frame maps the samples of every ADC input back to the index of its key.
+    Simulator.advance(frameTime);
+    assertValues(1000);
+}
+
+void test_completed_buffer_not_overwritten()
+{
+    // While the other buffer is being filled, the values of the completed buffer are read, even if the sensor values changed.
+    setValues(2000);
+    Simulator.advance(bufferTime - frameTime * 2);
+    assertValues(1000);
+
+    // Once the other buffer has been filled, its newest frame is read.
+    Simulator.advance(frameTime * 2);
+    assertValues(2000);
+}
+
+void test_newest_frame_is_read()
+{
+    // Only the last frame of a buffer is read, even if the sensor values changed in between the frames of the buffer.
+    setValues(3000);
+    Simulator.advance(bufferTime - frameTime * 2);
+    setValues(3100);
+    Simulator.advance(frameTime * 2);
+    assertValues(3100);
+}
+
+void test_buffers_keep_alternating()
+{
+    // The DMA channels keep starting each other, so new frames keep being read over a long time. Advancing by two buffers guarantees
+    // that a whole buffer has been sampled after the values changed, as the buffers do not start at whole microseconds.
+    for (uint16_t i = 0; i < 1000; i++)
+    {
+        setValues(i);
+        Simulator.advance(bufferTime * 2);
+        assertValues(i);
+    }
+}
+
+void test_frame_time_is_buffer_completion()
+{
+    // The time of the frame is the time its buffer was completed at, even if it is read long after that.
+    setValues(4000);
+    Simulator.advance(bufferTime * 3 / 2);
+    assertValues(4000);
+
+    uint16_t values[HE_KEYS];
+    uint32_t sampledAt;
+    ADCSampler.read(values, sampledAt);
+    TEST_ASSERT_LESS_THAN(Simulator.getTime(), sampledAt);
+}
+
+void test_config_commit_while_sampling()
+{
+    // Commit the configuration a few times while sampling, with the first commit erasing a sector, which takes far longer than a buffer.
+    // The commits start in the middle of a frame, so the sampling is paused at different inputs of the round-robin.
+    const uint32_t erases = Simulator.flashErases;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        setValues(5000 + i * 100);
+        Simulator.advance(bufferTime * 2);
+        ConfigController.saveConfig();
+        Simulator.advance(CONFIG_COMMIT_DELAY * 1000 + frameTime * i / HE_KEYS + 6);
+        const uint64_t start = Simulator.getTime();
+        ConfigController.update(true);
+        const uint64_t end = Simulator.getTime();
+        TEST_ASSERT_GREATER_THAN(bufferTime * 2, end - start);
+
+        // The frame sampled right before the commit can still be read afterwards, and new frames keep being sampled with the inputs of
+        // the samples mapped to the correct keys, completed after the sampling was resumed.
+        uint16_t values[HE_KEYS];
+        uint32_t sampledAt;
+        TEST_ASSERT_TRUE(ADCSampler.read(values, sampledAt));
+        for (uint8_t key = 0; key < HE_KEYS; key++)
+            TEST_ASSERT_EQUAL_UINT16(5000 + i * 100 + key, values[key]);
+
+        setValues(5050 + i * 100);
+        Simulator.advance(bufferTime * 2);
+        TEST_ASSERT_TRUE(ADCSampler.read(values, sampledAt));
+        for (uint8_t key = 0; key < HE_KEYS; key++)
+            TEST_ASSERT_EQUAL_UINT16(5050 + i * 100 + key, values[key]);
+        TEST_ASSERT_GREATER_THAN((uint32_t)end, sampledAt);
+    }
+
+    TEST_ASSERT_GREATER_THAN(erases, Simulator.flashErases);
+}
+
+int main()
+{
+    // Start the sampling with all keys having distinct values.
+    ConfigController.loadConfig();
+    setValues(1000);
+    ADCSampler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_no_frame_before_first_buffer);
+    RUN_TEST(test_first_buffer_completes_frame);
+    RUN_TEST(test_completed_buffer_not_overwritten);
+    RUN_TEST(test_newest_frame_is_read);
+    RUN_TEST(test_buffers_keep_alternating);
+    RUN_TEST(test_frame_time_is_buffer_completion);
+    RUN_TEST(test_config_commit_while_sampling);
+    return UNITY_END();
+}
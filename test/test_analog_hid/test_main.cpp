@@ -0,0 +1,230 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdlib>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/analog_handler.hpp"
+#include "helpers/analog_curve.hpp"
+#include "definitions.hpp"
+
+// Tests the analog HID interface, both the curves mapping the distances of the Hall Effect keys to the axis values and the handler
+// sending the axis values as gamepad reports, which are recorded by the simulator. The reports have to be limited to the changes
+// exceeding the threshold and to the polling rate, and must never get in the way of the keyboard reports.
+#ifndef USE_ANALOG_HID
+#error "The test requires the analog HID interface to be enabled."
+#endif
+static_assert(HE_KEYS >= 2, "The test requires at least two Hall Effect keys.");
+
+// The time between two HID reports at the polling rate in microseconds.
+static constexpr uint32_t pollingPeriod = 1000000 / HID_POLLING_RATE;
+
+// The distances of the Hall Effect keys passed to the handler, starting fully released.
+static uint16_t distances[HE_KEYS];
+
+// The linear curve the axis values reported by the handler are compared against.
+static const AnalogCurve linear;
+
+// Returns the exact value of the specified type of curve for the specified distance.
+static double getCurveValue(AnalogCurveType type, uint16_t distance)
+{
+    const double x = 1024.0 * (TRAVEL_DISTANCE_IN_0_01MM - distance) / TRAVEL_DISTANCE_IN_0_01MM;
+    switch (type)
+    {
+    case AnalogCurveType::Progressive:
+        return std::min(x * x / 1024, (double)AnalogCurve::maxValue);
+    case AnalogCurveType::Aggressive:
+        return std::min(1024 - (1024 - x) * (1024 - x) / 1024, (double)AnalogCurve::maxValue);
+    default:
+        return std::min(x, (double)AnalogCurve::maxValue);
+    }
+}
+
+// Advances the time to the next HID report and lets the handler report the distances, returning whether a report has been sent.
+static bool report(bool keyboardPending = false)
+{
+    Simulator.advance(pollingPeriod);
+    const uint32_t reports = Simulator.gamepadReports;
+    AnalogHandler.report(distances, keyboardPending);
+    return Simulator.gamepadReports != reports;
+}
+
+void setUp()
+{
+    // Release all keys, select the linear curve and report the released keys.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        distances[i] = TRAVEL_DISTANCE_IN_0_01MM;
+        ConfigController.config.heKeys[i].analogCurve = AnalogCurveType::Linear;
+    }
+
+    Simulator.hidReady = true;
+    report();
+}
+
+void tearDown()
+{
+}
+
+void test_curve_matches_formula()
+{
+    // Every curve stays within 3 of its exact value, which covers the error of interpolating between the points and of truncating the
+    // position on the curve and the value, and reaches both ends of the axis. Distances beyond the travel distance count as fully released.
+    for (uint8_t type = 0; type < (uint8_t)AnalogCurveType::Count; type++)
+    {
+        AnalogCurve curve;
+        curve.setType((AnalogCurveType)type);
+        TEST_ASSERT_EQUAL(type, (uint8_t)curve.getType());
+        for (uint16_t distance = 0; distance <= TRAVEL_DISTANCE_IN_0_01MM; distance++)
+        {
+            const uint16_t value = curve(distance);
+            const double expected = getCurveValue((AnalogCurveType)type, distance);
+            TEST_ASSERT_TRUE(std::abs(value - expected) <= 3);
+        }
+
+        TEST_ASSERT_EQUAL(AnalogCurve::maxValue, curve(0));
+        TEST_ASSERT_EQUAL(0, curve(TRAVEL_DISTANCE_IN_0_01MM));
+        TEST_ASSERT_EQUAL(0, curve(UINT16_MAX));
+    }
+}
+
+void test_curve_shapes()
+{
+    // Every curve rises with the travel of the key, with the progressive curve staying below the linear one and the aggressive curve above.
+    AnalogCurve linear;
+    AnalogCurve progressive;
+    AnalogCurve aggressive;
+    progressive.setType(AnalogCurveType::Progressive);
+    aggressive.setType(AnalogCurveType::Aggressive);
+    for (uint16_t distance = TRAVEL_DISTANCE_IN_0_01MM; distance > 0; distance--)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL(linear(distance - 1), linear(distance));
+        TEST_ASSERT_LESS_OR_EQUAL(progressive(distance - 1), progressive(distance));
+        TEST_ASSERT_LESS_OR_EQUAL(aggressive(distance - 1), aggressive(distance));
+        TEST_ASSERT_LESS_OR_EQUAL(linear(distance), progressive(distance));
+        TEST_ASSERT_GREATER_OR_EQUAL(linear(distance), aggressive(distance));
+    }
+
+    // Half of the travel maps to a quarter of the axis on the progressive curve and to three quarters on the aggressive curve.
+    TEST_ASSERT_EQUAL(512, linear(TRAVEL_DISTANCE_IN_0_01MM / 2));
+    TEST_ASSERT_EQUAL(256, progressive(TRAVEL_DISTANCE_IN_0_01MM / 2));
+    TEST_ASSERT_EQUAL(768, aggressive(TRAVEL_DISTANCE_IN_0_01MM / 2));
+}
+
+void test_keys_mapped_to_axes()
+{
+    // Every Hall Effect key is reported on its own axis, in the order of the keys.
+    for (uint8_t i = 0; i < HE_KEYS && i < 6; i++)
+        distances[i] = TRAVEL_DISTANCE_IN_0_01MM - (i + 1) * 40;
+
+    TEST_ASSERT_TRUE(report());
+    for (uint8_t i = 0; i < HE_KEYS && i < 6; i++)
+        TEST_ASSERT_EQUAL(linear(distances[i]), Simulator.gamepadAxes[i]);
+}
+
+void test_small_changes_not_reported()
+{
+    // Changes smaller than the threshold, like the noise of the sensors, are not reported, while changes reaching it are.
+    distances[0] = TRAVEL_DISTANCE_IN_0_01MM / 2;
+    TEST_ASSERT_TRUE(report());
+    const uint16_t value = Simulator.gamepadAxes[0];
+    for (int8_t offset : {1, -1, 1, -1})
+    {
+        distances[0] = TRAVEL_DISTANCE_IN_0_01MM / 2 + offset;
+        TEST_ASSERT_FALSE(report());
+    }
+
+    TEST_ASSERT_EQUAL(value, Simulator.gamepadAxes[0]);
+    distances[0] = TRAVEL_DISTANCE_IN_0_01MM / 2 - 2;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_GREATER_OR_EQUAL(value + ANALOG_HID_CHANGE_THRESHOLD, Simulator.gamepadAxes[0]);
+
+    // A small change of one key is sent along with a big change of another, as all axes are sent in every report.
+    distances[0]--;
+    distances[1] = 0;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(AnalogCurve::maxValue, Simulator.gamepadAxes[1]);
+    TEST_ASSERT_EQUAL(linear(distances[0]), Simulator.gamepadAxes[0]);
+}
+
+void test_ends_always_reported()
+{
+    // Reaching either end of the axis is always reported, even if the change is smaller than the threshold.
+    distances[0] = 1;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(linear(1), Simulator.gamepadAxes[0]);
+    distances[0] = 0;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(AnalogCurve::maxValue, Simulator.gamepadAxes[0]);
+    TEST_ASSERT_FALSE(report());
+
+    distances[0] = TRAVEL_DISTANCE_IN_0_01MM - 1;
+    TEST_ASSERT_TRUE(report());
+    distances[0] = TRAVEL_DISTANCE_IN_0_01MM;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(0, Simulator.gamepadAxes[0]);
+    TEST_ASSERT_FALSE(report());
+}
+
+void test_reports_limited_to_polling_rate()
+{
+    // The reports are sent at most at the polling rate while the key is pressed slowly, changing the distance ten times per report,
+    // with the changes in between being sent with the next report.
+    uint32_t reports = 0;
+    while (distances[0] > 0)
+    {
+        Simulator.advance(pollingPeriod / 10);
+        distances[0]--;
+        const uint32_t sent = Simulator.gamepadReports;
+        AnalogHandler.report(distances, false);
+        reports += Simulator.gamepadReports - sent;
+    }
+
+    TEST_ASSERT_UINT32_WITHIN(1, TRAVEL_DISTANCE_IN_0_01MM / 10, reports);
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(AnalogCurve::maxValue, Simulator.gamepadAxes[0]);
+}
+
+void test_held_back_for_keyboard()
+{
+    // The analog report is held back while a keyboard report is pending or the HID interface is busy, and sent once that is not the case.
+    distances[0] = 0;
+    TEST_ASSERT_FALSE(report(true));
+    TEST_ASSERT_FALSE(report(true));
+    Simulator.hidReady = false;
+    TEST_ASSERT_FALSE(report());
+    Simulator.hidReady = true;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(AnalogCurve::maxValue, Simulator.gamepadAxes[0]);
+}
+
+void test_curve_changes_applied()
+{
+    // Selecting another curve in the configuration applies it to the next report.
+    distances[0] = TRAVEL_DISTANCE_IN_0_01MM / 2;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(512, Simulator.gamepadAxes[0]);
+    ConfigController.config.heKeys[0].analogCurve = AnalogCurveType::Progressive;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(256, Simulator.gamepadAxes[0]);
+    ConfigController.config.heKeys[0].analogCurve = AnalogCurveType::Aggressive;
+    TEST_ASSERT_TRUE(report());
+    TEST_ASSERT_EQUAL(768, Simulator.gamepadAxes[0]);
+}
+
+int main()
+{
+    // Boot the firmware with the analog HID interface.
+    ConfigController.loadConfig();
+    AnalogHandler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_curve_matches_formula);
+    RUN_TEST(test_curve_shapes);
+    RUN_TEST(test_keys_mapped_to_axes);
+    RUN_TEST(test_small_changes_not_reported);
+    RUN_TEST(test_ends_always_reported);
+    RUN_TEST(test_reports_limited_to_polling_rate);
+    RUN_TEST(test_held_back_for_keyboard);
+    RUN_TEST(test_curve_changes_applied);
+    return UNITY_END();
+}
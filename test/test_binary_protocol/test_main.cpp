@@ -0,0 +1,238 @@
+#include <unity.h>
+#include <string>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/binary_handler.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/serial_reader.hpp"
+#include "helpers/serial_writer.hpp"
+#include "config_protocol.hpp"
+#include "frame_parser.hpp"
+#include "definitions.hpp"
+
+// Tests the binary configuration protocol end to end, sending the requests encoded by the host-side encoder written against the
+// documented format through the serial input and decoding the responses from the serial output.
+
+// The reader assembling the serial input, like the one of the main loop.
+static SerialReader serialReader;
+
+// Reads the serial input and handles the completed lines and frames, like the main loop of the first core does.
+static void handleSerialInput()
+{
+    for (uint16_t i = 0; i < 1000 && Serial.available() > 0; i++)
+    {
+        int available = min(Serial.available(), SERIAL_INPUT_MAX_BYTES_PER_LOOP);
+        while (available-- > 0)
+        {
+            const SerialReader::Input input = serialReader.feed(Serial.read());
+            if (input == SerialReader::Input::None)
+                continue;
+
+            if (input == SerialReader::Input::Line)
+                SerialHandler.handleSerialInput(serialReader.getLine());
+            else
+                BinaryHandler.handleFrame(serialReader.getPayload(), serialReader.getPayloadLength());
+            break;
+        }
+
+        SerialWriter.flush();
+    }
+}
+
+// Sends the specified request and returns the responses to it.
+static std::vector<ConfigProtocol::Response> sendRequest(const std::vector<uint8_t> &payload)
+{
+    const std::vector<uint8_t> frame = ConfigProtocol::encodeFrame(payload);
+    Simulator.writeSerialInput(std::string(frame.begin(), frame.end()));
+    handleSerialInput();
+
+    const std::string output = Simulator.readSerialOutput();
+    FrameParser parser;
+    parser.feed((const uint8_t *)output.data(), output.size());
+    TEST_ASSERT_EQUAL(0, parser.invalidFrames);
+
+    std::vector<ConfigProtocol::Response> responses(parser.payloads.size());
+    for (size_t i = 0; i < responses.size(); i++)
+        TEST_ASSERT_TRUE(ConfigProtocol::decodeResponse(parser.payloads[i], responses[i]));
+
+    return responses;
+}
+
+// Sends the specified request and checks that it is answered by a single response of the specified status, which is returned.
+static ConfigProtocol::Response request(const std::vector<uint8_t> &payload, uint8_t status)
+{
+    const std::vector<ConfigProtocol::Response> responses = sendRequest(payload);
+    TEST_ASSERT_EQUAL(1, responses.size());
+    TEST_ASSERT_EQUAL_UINT8(payload[0], responses[0].type);
+    TEST_ASSERT_EQUAL_UINT8(status, responses[0].status);
+    return responses[0];
+}
+
+// Returns the bytes of the specified value.
+template <typename T>
+static std::vector<uint8_t> toBytes(const T &value)
+{
+    return std::vector<uint8_t>((const uint8_t *)&value, (const uint8_t *)&value + sizeof(T));
+}
+
+// Returns the offset of the specified field of the configuration of the config controller.
+static uint16_t getOffset(const void *field)
+{
+    return (const uint8_t *)field - (const uint8_t *)&ConfigController.config;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_schema()
+{
+    ConfigProtocol::Schema schema;
+    TEST_ASSERT_TRUE(ConfigProtocol::decodeSchema(request({ConfigProtocol::schemaType}, BinaryHandler::Ok), schema));
+    TEST_ASSERT_EQUAL_UINT32(Configuration::getVersion(), schema.version);
+    TEST_ASSERT_EQUAL_UINT16(sizeof(Configuration), schema.size);
+    TEST_ASSERT_EQUAL_UINT8(HE_KEYS, schema.heKeys);
+    TEST_ASSERT_EQUAL_UINT8(DIGITAL_KEYS, schema.digitalKeys);
+}
+
+void test_read_config()
+{
+    const ConfigProtocol::Response response = request({ConfigProtocol::readConfigType}, BinaryHandler::Ok);
+    TEST_ASSERT_TRUE(toBytes(ConfigController.config) == response.data);
+}
+
+void test_read_fields()
+{
+    // The fields are returned in the requested order.
+    const uint16_t upperHysteresis = getOffset(&ConfigController.config.heKeys[0].upperHysteresis);
+    const uint16_t name = getOffset(&ConfigController.config.name);
+    const ConfigProtocol::Response response = request(ConfigProtocol::readFields({{upperHysteresis, 2}, {name, 8}}), BinaryHandler::Ok);
+
+    std::vector<uint8_t> expected = toBytes(ConfigController.config.heKeys[0].upperHysteresis);
+    expected.insert(expected.end(), ConfigController.config.name, ConfigController.config.name + 8);
+    TEST_ASSERT_TRUE(expected == response.data);
+
+    // Fields outside of the configuration are rejected.
+    request(ConfigProtocol::readFields({{(uint16_t)(sizeof(Configuration) - 1), 2}}), BinaryHandler::OutOfRange);
+}
+
+void test_write_fields()
+{
+    // Write both hysteresis values of the first key at once, which are applied to the keys right away.
+    const uint16_t lowerHysteresis = 150;
+    const uint16_t upperHysteresis = 200;
+    request(ConfigProtocol::writeFields({{getOffset(&ConfigController.config.heKeys[0].lowerHysteresis), toBytes(lowerHysteresis)},
+                                         {getOffset(&ConfigController.config.heKeys[0].upperHysteresis), toBytes(upperHysteresis)}}),
+            BinaryHandler::Ok);
+    TEST_ASSERT_EQUAL_UINT16(lowerHysteresis, ConfigController.config.heKeys[0].lowerHysteresis);
+    TEST_ASSERT_EQUAL_UINT16(upperHysteresis, ConfigController.config.heKeys[0].upperHysteresis);
+
+    KeyHandler.scan();
+    TEST_ASSERT_EQUAL_UINT16(lowerHysteresis, KeyHandler.heKeyStates.lowerHysteresis[0]);
+    TEST_ASSERT_EQUAL_UINT16(upperHysteresis, KeyHandler.heKeyStates.upperHysteresis[0]);
+}
+
+void test_invalid_writes_rejected()
+{
+    // Writes resulting in an invalid configuration are rejected as a whole, including the fields that would have been valid.
+    const Configuration config = ConfigController.config;
+    const uint16_t upperHysteresis = 300;
+    const uint16_t lowerHysteresis = 350;
+    request(ConfigProtocol::writeFields({{getOffset(&ConfigController.config.heKeys[0].upperHysteresis), toBytes(upperHysteresis)},
+                                         {getOffset(&ConfigController.config.heKeys[0].lowerHysteresis), toBytes(lowerHysteresis)}}),
+            BinaryHandler::Invalid);
+
+    // The version cannot be written, as it identifies the layout.
+    const uint32_t version = 0;
+    request(ConfigProtocol::writeFields({{getOffset(&ConfigController.config.version), toBytes(version)}}), BinaryHandler::Invalid);
+
+    // Malformed requests and fields outside of the configuration are rejected.
+    std::vector<uint8_t> trailing = ConfigProtocol::writeFields({{getOffset(&ConfigController.config.heKeys[0].upperHysteresis), toBytes(upperHysteresis)}});
+    trailing.push_back(0);
+    request(trailing, BinaryHandler::Malformed);
+    request(ConfigProtocol::writeFields({{(uint16_t)sizeof(Configuration), {0}}}), BinaryHandler::OutOfRange);
+    request(ConfigProtocol::writeConfig(std::vector<uint8_t>(sizeof(Configuration) - 1)), BinaryHandler::Malformed);
+    TEST_ASSERT_EQUAL_MEMORY(&config, &ConfigController.config, sizeof(Configuration));
+}
+
+void test_write_config()
+{
+    // Write the whole configuration with a changed name and rapid trigger enabled on the first key.
+    Configuration config = ConfigController.config;
+    strcpy(config.name, "protocol");
+    config.heKeys[0].rapidTrigger = true;
+    request(ConfigProtocol::writeConfig(toBytes(config)), BinaryHandler::Ok);
+    TEST_ASSERT_EQUAL_MEMORY(&config, &ConfigController.config, sizeof(Configuration));
+}
+
+void test_save()
+{
+    // Saving writes the configuration into the flash once the commit delay has passed and no key is pressed.
+    const uint32_t flashPrograms = Simulator.flashPrograms;
+    request({ConfigProtocol::saveType}, BinaryHandler::Ok);
+    ConfigController.update(true);
+    TEST_ASSERT_EQUAL_UINT32(flashPrograms, Simulator.flashPrograms);
+
+    Simulator.advance(CONFIG_COMMIT_DELAY * 1000);
+    ConfigController.update(true);
+    TEST_ASSERT_GREATER_THAN(flashPrograms, Simulator.flashPrograms);
+}
+
+void test_unknown_type()
+{
+    request({0x7E}, BinaryHandler::UnknownType);
+    request({ConfigProtocol::schemaType, 0}, BinaryHandler::Malformed);
+}
+
+void test_corrupted_frame_ignored()
+{
+    // Frames with an invalid checksum are discarded without a response, while the following frames are handled again.
+    std::vector<uint8_t> frame = ConfigProtocol::encodeFrame({ConfigProtocol::schemaType});
+    frame.back() ^= 0xFF;
+    Simulator.writeSerialInput(std::string(frame.begin(), frame.end()));
+    handleSerialInput();
+    TEST_ASSERT_EQUAL(0, Simulator.readSerialOutput().size());
+
+    request({ConfigProtocol::schemaType}, BinaryHandler::Ok);
+}
+
+void test_frames_between_lines()
+{
+    // Binary frames and text commands can be mixed, with both being handled in order.
+    const std::vector<uint8_t> frame = ConfigProtocol::encodeFrame({ConfigProtocol::schemaType});
+    Simulator.writeSerialInput("name binary\n" + std::string(frame.begin(), frame.end()) + "rate 4000\n");
+    handleSerialInput();
+    TEST_ASSERT_EQUAL_STRING("binary", ConfigController.config.name);
+    TEST_ASSERT_EQUAL_UINT16(4000, ConfigController.config.scanRate);
+
+    const std::string output = Simulator.readSerialOutput();
+    FrameParser parser;
+    parser.feed((const uint8_t *)output.data(), output.size());
+    TEST_ASSERT_EQUAL(1, parser.payloads.size());
+}
+
+int main()
+{
+    // Boot the firmware without scanning the keys, which are only scanned manually to apply the configuration.
+    EEPROM.begin(1024);
+    ConfigController.loadConfig();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_schema);
+    RUN_TEST(test_read_config);
+    RUN_TEST(test_read_fields);
+    RUN_TEST(test_write_fields);
+    RUN_TEST(test_invalid_writes_rejected);
+    RUN_TEST(test_write_config);
+    RUN_TEST(test_save);
+    RUN_TEST(test_unknown_type);
+    RUN_TEST(test_corrupted_frame_ignored);
+    RUN_TEST(test_frames_between_lines);
+    return UNITY_END();
+}
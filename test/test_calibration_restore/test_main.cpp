@@ -0,0 +1,89 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests restoring the saved calibration of the Hall Effect keys at bootup. The calibration is saved into the journal in the simulated
+// flash and loaded again, like after a reboot. The first key rests at its saved rest position and is restored, the second key is held
+// down at bootup and calibrated from scratch instead, and the third key has no saved calibration.
+static_assert(HE_KEYS >= 3, "The test requires at least three Hall Effect keys.");
+
+// The saved rest and down position of the first two keys, and the sensor value matching the rest position, which has the deadzone applied.
+static constexpr uint16_t restPosition = 2030;
+static constexpr uint16_t downPosition = 1200;
+static constexpr uint16_t restValue = restPosition + SENSOR_BOUNDARY_DEADZONE;
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_calibration_saved()
+{
+    // Save the calibration of the first two keys, which is committed to the flash once the delay has passed while the keys are idle.
+    ConfigController.loadConfig();
+    ConfigController.storeCalibration(0, restPosition, downPosition);
+    ConfigController.storeCalibration(1, restPosition, downPosition);
+    Simulator.advance(CONFIG_COMMIT_DELAY * 1000);
+    ConfigController.update(true);
+    TEST_ASSERT_NOT_EQUAL(0, Simulator.flashPrograms);
+
+    // Load the configuration again like after a reboot, with the calibration being read from the journal.
+    for (HEKeyConfig &config : ConfigController.config.heKeys)
+        config.restPosition = config.downPosition = 0;
+    ConfigController.loadConfig();
+    TEST_ASSERT_EQUAL_UINT16(restPosition, ConfigController.config.heKeys[0].restPosition);
+    TEST_ASSERT_EQUAL_UINT16(downPosition, ConfigController.config.heKeys[1].downPosition);
+}
+
+void test_no_restore_before_first_frame()
+{
+    // Scan the keys right after the sampling started, before the first frame has been completed. The keys are not processed
+    // yet, so the restore is not attempted on the zero-filled buffers, which would never match the saved rest position.
+    Simulator.setAnalogValue(HE_PIN(0), restValue);
+    Simulator.setAnalogValue(HE_PIN(1), downPosition);
+    Simulator.setAnalogValue(HE_PIN(2), restValue);
+    ADCSampler.begin();
+    ScanTimer.begin();
+    KeyHandler.handle();
+
+    for (const HEKey &key : KeyHandler.heKeys)
+    {
+        TEST_ASSERT_FALSE(key.calibrationRestoreAttempted);
+        TEST_ASSERT_FALSE(key.calibrated);
+    }
+}
+
+void test_restore_on_first_frame()
+{
+    // Scan the keys again once the first frame has been completed, restoring the calibration of the first key only.
+    Simulator.advance(1000000 / ConfigController.config.scanRate);
+    KeyHandler.handle();
+
+    for (const HEKey &key : KeyHandler.heKeys)
+        TEST_ASSERT_TRUE(key.calibrationRestoreAttempted);
+
+    TEST_ASSERT_TRUE(KeyHandler.heKeys[0].calibrated);
+    TEST_ASSERT_EQUAL_UINT16(restPosition, KeyHandler.heKeys[0].restPosition);
+    TEST_ASSERT_EQUAL_UINT16(downPosition, KeyHandler.heKeys[0].downPosition);
+    TEST_ASSERT_EQUAL_UINT16(TRAVEL_DISTANCE_IN_0_01MM, KeyHandler.heKeyStates.distances[0]);
+
+    // The held down key and the key without a saved calibration are calibrated from scratch.
+    TEST_ASSERT_FALSE(KeyHandler.heKeys[1].calibrated);
+    TEST_ASSERT_FALSE(KeyHandler.heKeys[2].calibrated);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_calibration_saved);
+    RUN_TEST(test_no_restore_before_first_frame);
+    RUN_TEST(test_restore_on_first_frame);
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+#include <unity.h>
+#include <pthread.h>
+#include <cstring>
+#include <string>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/serial_writer.hpp"
+#include "helpers/string_helper.hpp"
+#include "definitions.hpp"
+
+// Tests the dispatch of the serial commands through the hashed command tables, including the validation of the values, and the
+// stack used for handling a command, which has to stay small as the input is only tokenized into views instead of being copied.
+
+// The hashes are calculated at compile time and match the reference values of the 32-bit FNV-1a hash.
+static_assert(StringHelper::hash("") == 2166136261u, "The hash of an empty string is the FNV-1a offset basis.");
+static_assert(StringHelper::hash("a") == 0xe40c292cu, "The hash of \"a\" matches the FNV-1a reference.");
+static_assert(StringHelper::hash("foobar") == 0xbf9cf968u, "The hash of \"foobar\" matches the FNV-1a reference.");
+
+// The buffer the commands are copied into before being handled, as the serial handler modifies the input in place.
+static char input[SERIAL_INPUT_BUFFER_SIZE];
+
+// Handles the specified command like the serial reader passes it on, returning the serial output written by it.
+static std::string handle(const std::string &command)
+{
+    strcpy(input, command.c_str());
+    SerialHandler.handleSerialInput(input);
+    SerialWriter.flush();
+    return Simulator.readSerialOutput();
+}
+
+// The configuration after bootup, which is the default configuration as nothing has been saved yet.
+static Configuration defaults;
+
+// The stack memory of the thread the stack use is measured on, and the byte it is filled with.
+alignas(64) static uint8_t stack[256 * 1024];
+static constexpr uint8_t stackPattern = 0xA5;
+
+// Runs the specified function on a thread using the stack memory and returns the amount of stack bytes it used.
+static size_t measureStack(void (*function)())
+{
+    memset(stack, stackPattern, sizeof(stack));
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstack(&attributes, stack, sizeof(stack));
+    pthread_t thread;
+    pthread_create(&thread, &attributes, [](void *function) -> void *
+                   { ((void (*)())function)(); return nullptr; }, (void *)function);
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attributes);
+
+    // The stack grows downwards, so the used part ends at the lowest byte that has been overwritten.
+    size_t untouched = 0;
+    while (untouched < sizeof(stack) && stack[untouched] == stackPattern)
+        untouched++;
+
+    return sizeof(stack) - untouched;
+}
+
+void setUp()
+{
+    // Start every test with the default configuration and no pending output.
+    ConfigController.config = defaults;
+    SerialWriter.flush();
+    Simulator.readSerialOutput();
+}
+
+void tearDown()
+{
+}
+
+void test_global_commands()
+{
+    // Global commands are found by name, case-insensitively, with the rest of the line being passed as the parameters.
+    TEST_ASSERT_EQUAL_STRING("hello  world\n", handle("echo hello  World").c_str());
+    TEST_ASSERT_EQUAL_STRING("hello\n", handle("ECHO Hello").c_str());
+
+    handle("name my keypad");
+    TEST_ASSERT_EQUAL_STRING("my keypad", ConfigController.config.name);
+
+    const std::string output = handle("get");
+    TEST_ASSERT_TRUE(output.find("GET name=my keypad\n") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("GET END\n") != std::string::npos);
+
+    // Unknown commands, prefixes of commands and empty input are ignored.
+    TEST_ASSERT_EQUAL_STRING("", handle("ge").c_str());
+    TEST_ASSERT_EQUAL_STRING("", handle("gets").c_str());
+    TEST_ASSERT_EQUAL_STRING("", handle("").c_str());
+    TEST_ASSERT_EQUAL_STRING("", handle(" echo x").c_str());
+}
+
+void test_key_settings()
+{
+    // Settings are applied to the specified key, or to all keys of the type if no index is specified.
+    handle("hkey2.rt 1");
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        TEST_ASSERT_EQUAL(i == 1, ConfigController.config.heKeys[i].rapidTrigger);
+
+    handle("HKEY.RTUS 55");
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        TEST_ASSERT_EQUAL(55, ConfigController.config.heKeys[i].rapidTriggerUpSensitivity);
+
+    // The settings shared by all keys are available for both types of keys, while the Hall Effect key settings are not for digital keys.
+    handle("hkey1.char x");
+    handle("dkey1.char 122");
+    TEST_ASSERT_EQUAL('x', ConfigController.config.heKeys[0].keyChar);
+    TEST_ASSERT_EQUAL('z', ConfigController.config.digitalKeys[0].keyChar);
+
+    // Keys outside of the valid range and unknown settings are ignored.
+    const Configuration before = ConfigController.config;
+    handle("dkey1.rt 1");
+    handle("hkey0.rt 1");
+    handle("hkey" + std::to_string(HE_KEYS + 1) + ".rt 1");
+    handle("hkey" + std::to_string(HE_KEYS + 1) + ".rtus 77");
+    handle("hkey" + std::to_string(HE_KEYS + 1) + ".char q");
+    handle("dkey" + std::to_string(DIGITAL_KEYS + 1) + ".char a");
+    handle("hkey1.r 1");
+    handle("hkey1.rtx 1");
+    handle("hkey1");
+    TEST_ASSERT_EQUAL_MEMORY(&before, &ConfigController.config, sizeof(Configuration));
+}
+
+void test_values_are_validated()
+{
+    // Values outside of the valid range of a setting are rejected, leaving the setting unchanged.
+    const HEKeyConfig &config = ConfigController.config.heKeys[0];
+    handle("hkey1.rtds " + std::to_string(RAPID_TRIGGER_TOLERANCE - 1));
+    handle("hkey1.rtds " + std::to_string(TRAVEL_DISTANCE_IN_0_01MM + 1));
+    TEST_ASSERT_EQUAL(defaults.heKeys[0].rapidTriggerDownSensitivity, config.rapidTriggerDownSensitivity);
+    handle("hkey1.rtds " + std::to_string(TRAVEL_DISTANCE_IN_0_01MM));
+    TEST_ASSERT_EQUAL(TRAVEL_DISTANCE_IN_0_01MM, config.rapidTriggerDownSensitivity);
+
+    const uint16_t lowerHysteresis = config.lowerHysteresis;
+    handle("hkey1.lh -5");
+    handle("hkey1.lh " + std::to_string(config.upperHysteresis - HYSTERESIS_TOLERANCE + 1));
+    TEST_ASSERT_EQUAL(lowerHysteresis, config.lowerHysteresis);
+
+    handle("hkey1.filter " + std::to_string((uint8_t)FilterType::Count));
+    handle("hkey1.filter -1");
+    TEST_ASSERT_EQUAL((uint8_t)defaults.heKeys[0].filter, (uint8_t)config.filter);
+    handle("hkey1.filter " + std::to_string((uint8_t)FilterType::Median));
+    TEST_ASSERT_EQUAL((uint8_t)FilterType::Median, (uint8_t)config.filter);
+
+    const uint16_t scanRate = ConfigController.config.scanRate;
+    handle("rate 999");
+    TEST_ASSERT_EQUAL(scanRate, ConfigController.config.scanRate);
+
+    // Names have to fit into the name buffer, including the null-terminator.
+    const std::string longest(sizeof(ConfigController.config.name) - 1, 'n');
+    handle("name " + longest + "n");
+    TEST_ASSERT_EQUAL_STRING(defaults.name, ConfigController.config.name);
+    handle("name " + longest);
+    TEST_ASSERT_EQUAL_STRING(longest.c_str(), ConfigController.config.name);
+}
+
+void test_stack_use()
+{
+    // Handling a command uses less stack than a single copy of the input buffer would, measured against a thread doing nothing.
+    // Before the input was tokenized into views, every command copied it into up to five buffers of that size.
+    const size_t baseline = measureStack([] {});
+    const size_t settings = measureStack([]
+                                         {
+                                             for (const char *command : {"hkey1.rtus 50", "hkey.rt 1", "dkey1.char a", "name keypad", "rate 1000"})
+                                             {
+                                                 strcpy(input, command);
+                                                 SerialHandler.handleSerialInput(input);
+                                             } });
+    printf("STACK command=%zu\n", settings - baseline);
+    TEST_ASSERT_LESS_THAN(SERIAL_INPUT_BUFFER_SIZE, settings - baseline);
+}
+
+int main()
+{
+    ConfigController.loadConfig();
+    defaults = ConfigController.config;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_global_commands);
+    RUN_TEST(test_key_settings);
+    RUN_TEST(test_values_are_validated);
+    RUN_TEST(test_stack_use);
+    return UNITY_END();
+}
@@ -0,0 +1,216 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "config/configuration_journal.hpp"
+#include "definitions.hpp"
+extern "C"
+{
+#include "hardware/flash.h"
+}
+
+// Tests the configuration journal on the simulated flash, checking that the newest record is found at bootup, that the wear is spread
+// across all sectors, that a power loss at any point while writing never loses the previously saved configuration and that the
+// configuration controller only commits saves once the keypad is idle.
+
+// The size of a slot containing a single record, being the header and the configuration rounded up to whole flash pages.
+static constexpr size_t slotSize = (12 + sizeof(Configuration) + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+static constexpr uint32_t slotsPerSector = FLASH_SECTOR_SIZE / slotSize;
+static constexpr uint32_t sectors = Simulator.filesystemSize / FLASH_SECTOR_SIZE;
+static constexpr uint32_t slotCount = sectors * slotsPerSector;
+
+// The offset of the filesystem region in the simulated flash.
+static constexpr size_t filesystemOffset = Simulator.flashSize - Simulator.filesystemSize;
+
+// Returns a configuration distinguishable by the specified number.
+static Configuration getConfig(uint32_t number)
+{
+    Configuration config;
+    snprintf(config.name, sizeof(config.name), "config %lu", (unsigned long)number);
+    config.heKeys[0].rapidTriggerUpSensitivity = number % 400;
+    return config;
+}
+
+// Loads the configuration from the journal like at bootup, returning the number of the loaded configuration or -1 if none was loaded.
+static int32_t load()
+{
+    ConfigurationJournal journal;
+    Configuration config;
+    if (!journal.load(config))
+        return -1;
+
+    unsigned long number;
+    TEST_ASSERT_EQUAL(1, sscanf(config.name, "config %lu", &number));
+    TEST_ASSERT_EQUAL(number % 400, config.heKeys[0].rapidTriggerUpSensitivity);
+    return number;
+}
+
+void setUp()
+{
+    // Start every test with an erased flash.
+    Simulator.reset();
+}
+
+void tearDown()
+{
+}
+
+void test_newest_record_is_loaded()
+{
+    // An empty journal loads nothing. Afterwards, the newest record is loaded after every append, also after wrapping around the journal.
+    TEST_ASSERT_EQUAL(-1, load());
+
+    ConfigurationJournal journal;
+    Configuration config;
+    TEST_ASSERT_FALSE(journal.load(config));
+    for (uint32_t i = 0; i < slotCount * 3 + 5; i++)
+    {
+        TEST_ASSERT_TRUE(journal.append(getConfig(i)));
+        TEST_ASSERT_EQUAL(i, load());
+    }
+}
+
+void test_wear_is_spread()
+{
+    // Every append programs a single slot, erasing a sector only when entering it. Every sector is erased equally often this way.
+    ConfigurationJournal journal;
+    Configuration config;
+    journal.load(config);
+
+    std::vector<uint32_t> sectorErases(sectors);
+    const uint32_t appends = slotCount * 4;
+    for (uint32_t i = 0; i < appends; i++)
+    {
+        const uint32_t erases = Simulator.flashErases;
+        const uint32_t programs = Simulator.flashPrograms;
+        std::vector<uint8_t> before(native_flash + filesystemOffset, native_flash + Simulator.flashSize);
+        journal.append(getConfig(i));
+        TEST_ASSERT_EQUAL(slotSize / FLASH_PAGE_SIZE, Simulator.flashPrograms - programs);
+
+        // Find the sector that has been written to, which is erased if the flash was erased.
+        size_t changed = 0;
+        while (before[changed] == native_flash[filesystemOffset + changed])
+            changed++;
+        if (Simulator.flashErases != erases)
+            sectorErases[changed / FLASH_SECTOR_SIZE]++;
+        TEST_ASSERT_LESS_OR_EQUAL(1, Simulator.flashErases - erases);
+    }
+
+    TEST_ASSERT_EQUAL(appends / slotsPerSector, Simulator.flashErases);
+    for (uint32_t erases : sectorErases)
+        TEST_ASSERT_EQUAL(appends / slotCount, erases);
+}
+
+void test_power_loss_while_appending()
+{
+    // The flash is cut off at a random point while erasing the sector or programming the slot of a new record. The journal loads either
+    // the previous or, if it was written completely, the new configuration, and continues to append and load correctly afterwards.
+    std::mt19937 generator(42);
+    for (uint32_t trial = 0; trial < 300; trial++)
+    {
+        Simulator.reset();
+        ConfigurationJournal journal;
+        Configuration config;
+        journal.load(config);
+        const uint32_t previous = generator() % (slotCount * 2);
+        for (uint32_t i = 0; i <= previous; i++)
+            journal.append(getConfig(i));
+
+        const uint32_t erases = Simulator.flashErases;
+        std::vector<uint8_t> before(native_flash, native_flash + Simulator.flashSize);
+        journal.append(getConfig(previous + 1));
+        const std::vector<uint8_t> after(native_flash, native_flash + Simulator.flashSize);
+
+        // Find the slot that has been written.
+        size_t slot = filesystemOffset;
+        while (before[slot] == after[slot])
+            slot++;
+        slot -= (slot - filesystemOffset) % FLASH_SECTOR_SIZE % slotSize;
+        const size_t sector = slot - (slot - filesystemOffset) % FLASH_SECTOR_SIZE;
+
+        // Cut the power either while erasing the sector, or while programming the slot after it was erased.
+        const bool erasing = Simulator.flashErases != erases && generator() % 2;
+        if (erasing)
+        {
+            memcpy(native_flash, before.data(), before.size());
+            memset(native_flash + sector, 0xFF, generator() % FLASH_SECTOR_SIZE);
+        }
+        else
+        {
+            const size_t programmed = generator() % slotSize;
+            memset(native_flash + slot + programmed, 0xFF, slotSize - programmed);
+        }
+
+        const int32_t loaded = load();
+        TEST_ASSERT_TRUE(loaded == (int32_t)previous || (!erasing && loaded == (int32_t)previous + 1 && memcmp(native_flash, after.data(), after.size()) == 0));
+
+        // After the reboot, the journal continues appending normally.
+        ConfigurationJournal rebooted;
+        rebooted.load(config);
+        for (uint32_t i = 2; i < 2 + slotsPerSector * 2; i++)
+        {
+            TEST_ASSERT_TRUE(rebooted.append(getConfig(previous + i)));
+            TEST_ASSERT_EQUAL(previous + i, load());
+        }
+    }
+}
+
+void test_boot_time()
+{
+    // Loading a full journal only reads the headers of the records. The time is reported for comparison, as it depends on the host.
+    ConfigurationJournal journal;
+    Configuration config;
+    journal.load(config);
+    for (uint32_t i = 0; i < slotCount * 2 + slotCount / 2; i++)
+        journal.append(getConfig(i));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        ConfigurationJournal rebooted;
+        TEST_ASSERT_TRUE(rebooted.load(config));
+    }
+    const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 1000;
+    printf("BENCH journal_load %.1f ns/load slots=%lu\n", nanoseconds, (unsigned long)slotCount);
+}
+
+void test_save_is_deferred_until_idle()
+{
+    // Saving only schedules the commit, which happens once the delay since the last save passed while no key is pressed. Multiple
+    // saves in a short time result in a single commit of the last configuration.
+    ConfigController.loadConfig();
+    const uint32_t programs = Simulator.flashPrograms;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        ConfigController.config = getConfig(i);
+        ConfigController.saveConfig();
+        Simulator.advance(CONFIG_COMMIT_DELAY * 500);
+        ConfigController.update(true);
+    }
+
+    TEST_ASSERT_EQUAL(programs, Simulator.flashPrograms);
+    Simulator.advance(CONFIG_COMMIT_DELAY * 500);
+    ConfigController.update(false);
+    TEST_ASSERT_EQUAL(programs, Simulator.flashPrograms);
+    ConfigController.update(true);
+    TEST_ASSERT_EQUAL(programs + slotSize / FLASH_PAGE_SIZE, Simulator.flashPrograms);
+    TEST_ASSERT_EQUAL(4, load());
+
+    ConfigController.update(true);
+    TEST_ASSERT_EQUAL(programs + slotSize / FLASH_PAGE_SIZE, Simulator.flashPrograms);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_newest_record_is_loaded);
+    RUN_TEST(test_wear_is_spread);
+    RUN_TEST(test_power_loss_while_appending);
+    RUN_TEST(test_boot_time);
+    RUN_TEST(test_save_is_deferred_until_idle);
+    return UNITY_END();
+}
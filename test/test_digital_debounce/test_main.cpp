@@ -0,0 +1,177 @@
+#include <unity.h>
+#include <random>
+#include <vector>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/hid_usage.hpp"
+#include "helpers/scan_timer.hpp"
+#include "hardware/structs/sio.h"
+#include "definitions.hpp"
+
+// Tests the eager debouncing of the digital keys with bouncing contacts, checking that every press is reported right away and every
+// release once the contacts stopped bouncing for the debounce time, with no bounce ever causing additional transitions.
+// The firmware runs like the main loop, reporting continuously in between the scans, so the time of every report is exact.
+static_assert(DIGITAL_KEYS >= 1, "The test requires at least one digital key.");
+
+// The duration of a USB frame in microseconds.
+static constexpr uint32_t framePeriod = 1000;
+
+// The generator for the random bounces.
+static std::mt19937 generator(42);
+
+// The time of the first scan that read the first digital key as pressed since it was last released, or 0 if there was none.
+static uint64_t pressScannedAt = 0;
+
+// Runs the firmware until the specified simulated time, like the main loop of the first core does. Checks that every scan reading
+// the first digital key as pressed presses the key right away, without waiting for the contacts to settle.
+static void runUntil(uint64_t time)
+{
+    const Key &key = KeyHandler.digitalKeys[0];
+    while (Simulator.getTime() < time)
+    {
+        const uint32_t scans = ScanTimer.scheduler.scans;
+        Simulator.advance(1);
+        KeyHandler.handle();
+        if (ScanTimer.scheduler.scans == scans || (sio_hw->gpio_in & DigitalSampler.getPinMask(0)))
+            continue;
+
+        TEST_ASSERT_TRUE(key.pressed);
+        if (!pressScannedAt)
+            pressScannedAt = Simulator.getTime();
+    }
+}
+
+// Moves the contacts of the first digital key to the specified state, bouncing for up to the specified time with random edges in between.
+// Returns the time of the first edge.
+static uint64_t bounce(bool pressed, uint32_t duration)
+{
+    const uint64_t firstEdge = Simulator.getTime();
+    Simulator.setDigitalLevel(DIGITAL_PIN(0), !pressed);
+    const uint32_t bounces = duration ? generator() % 8 : 0;
+    for (uint32_t i = 0; i < bounces; i++)
+    {
+        runUntil(Simulator.getTime() + 1 + generator() % (duration / (bounces * 2)));
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), pressed);
+        runUntil(Simulator.getTime() + 1 + generator() % (duration / (bounces * 2)));
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), !pressed);
+    }
+
+    return firstEdge;
+}
+
+// Returns the changes of the state of the first digital key in the sent reports, with the time of the report they were sent in.
+static std::vector<std::pair<uint64_t, bool>> getTransitions()
+{
+    const uint8_t usage = HIDUsage::fromKeyChar(ConfigController.config.digitalKeys[0].keyChar).usage;
+    std::vector<std::pair<uint64_t, bool>> transitions;
+    bool pressed = false;
+    for (const Simulator::KeyboardReport &report : Simulator.keyboardReports)
+    {
+        const bool contained = report.contains(usage);
+        if (contained != pressed)
+            transitions.push_back({report.time, contained});
+        pressed = contained;
+    }
+
+    return transitions;
+}
+
+void setUp()
+{
+    Simulator.keyboardReports.clear();
+}
+
+void tearDown()
+{
+}
+
+void test_bouncy_presses_and_releases()
+{
+    // Random presses and releases with up to 2ms of bouncing each. Every press is reported in the USB frame after the first scan reading
+    // it, and every release once the contacts stopped bouncing for the debounce time, with no bounce causing additional transitions.
+    const uint32_t scanPeriod = 1000000 / ConfigController.config.scanRate;
+    std::vector<uint64_t> pressedAt;
+    std::vector<uint64_t> scannedAt;
+    std::vector<uint64_t> settledAt;
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        pressScannedAt = 0;
+        pressedAt.push_back(bounce(true, 2000));
+        runUntil(Simulator.getTime() + DIGITAL_DEBOUNCE_TIME + generator() % 20000);
+        scannedAt.push_back(pressScannedAt);
+        bounce(false, 2000);
+        settledAt.push_back(Simulator.getTime());
+        runUntil(Simulator.getTime() + DIGITAL_DEBOUNCE_TIME + scanPeriod + 2 * framePeriod + generator() % 20000);
+    }
+
+    const std::vector<std::pair<uint64_t, bool>> transitions = getTransitions();
+    TEST_ASSERT_EQUAL(pressedAt.size() * 2, transitions.size());
+    uint32_t withinScan = 0;
+    for (size_t i = 0; i < pressedAt.size(); i++)
+    {
+        TEST_ASSERT_TRUE(transitions[i * 2].second);
+        TEST_ASSERT_FALSE(transitions[i * 2 + 1].second);
+        TEST_ASSERT_GREATER_THAN(pressedAt[i], scannedAt[i]);
+        TEST_ASSERT_LESS_OR_EQUAL(framePeriod, transitions[i * 2].first - scannedAt[i]);
+        TEST_ASSERT_GREATER_OR_EQUAL(DIGITAL_DEBOUNCE_TIME, transitions[i * 2 + 1].first - settledAt[i]);
+        TEST_ASSERT_LESS_OR_EQUAL(DIGITAL_DEBOUNCE_TIME + scanPeriod + framePeriod, transitions[i * 2 + 1].first - settledAt[i]);
+        withinScan += scannedAt[i] - pressedAt[i] <= scanPeriod;
+    }
+
+    // Most presses are read by the first scan after the first edge, the others hit a bounce of the contacts.
+    TEST_ASSERT_GREATER_THAN(pressedAt.size() / 2, withinScan);
+}
+
+void test_glitches_while_held()
+{
+    // Short glitches of the contacts while the key is held down do not release the key.
+    bounce(true, 0);
+    runUntil(Simulator.getTime() + 10000);
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), true);
+        runUntil(Simulator.getTime() + 1 + generator() % (DIGITAL_DEBOUNCE_TIME / 2));
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), false);
+        runUntil(Simulator.getTime() + 1 + generator() % 5000);
+    }
+
+    bounce(false, 0);
+    runUntil(Simulator.getTime() + DIGITAL_DEBOUNCE_TIME + 10000);
+    const std::vector<std::pair<uint64_t, bool>> transitions = getTransitions();
+    TEST_ASSERT_EQUAL(2, transitions.size());
+}
+
+void test_release_timed_from_last_edge()
+{
+    // The release is timed from the last edge as timestamped by the interrupt, even if that edge happened in between two scans.
+    bounce(true, 0);
+    runUntil(Simulator.getTime() + 10000);
+    Simulator.advance(1000000 / ConfigController.config.scanRate / 2);
+    const uint64_t releasedAt = bounce(false, 0);
+    runUntil(releasedAt + DIGITAL_DEBOUNCE_TIME - 1);
+    TEST_ASSERT_EQUAL_UINT32(releasedAt, KeyHandler.digitalKeys[0].lastEdge);
+    TEST_ASSERT_TRUE(static_cast<const Key &>(KeyHandler.digitalKeys[0]).pressed);
+    runUntil(releasedAt + DIGITAL_DEBOUNCE_TIME + 1000000 / ConfigController.config.scanRate);
+    TEST_ASSERT_FALSE(static_cast<const Key &>(KeyHandler.digitalKeys[0]).pressed);
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of the first digital key enabled.
+    ConfigController.loadConfig();
+    ConfigController.config.digitalKeys[0].hidEnabled = true;
+    KeyHandler.begin();
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+    runUntil(100000);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bouncy_presses_and_releases);
+    RUN_TEST(test_glitches_while_held);
+    RUN_TEST(test_release_timed_from_last_edge);
+    return UNITY_END();
+}
@@ -0,0 +1,143 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/gauss_lut.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests the distances mapped with the cached fixed-point scale of every key against the division by the distance of the
+// down position, which was calculated on every scan before the scale was cached. The keys are swept over their whole range
+// with different boundaries, comparing the distance of every scan with the one calculated from the filtered sensor value.
+#ifndef USE_GAUSS_CORRECTION_LUT
+#error "The test requires the gauss correction to be enabled."
+#endif
+
+// The lookup table for the gauss correction, being the same as the one of the key handler.
+static constexpr GaussLUT gaussLUT = GaussLUT();
+
+// Returns the distance of the specified key calculated with the division, like the distances were calculated before.
+static uint16_t getExpectedDistance(uint8_t index)
+{
+    const HEKey &key = KeyHandler.heKeys[index];
+    uint16_t distance = gaussLUT.adcToDistance(KeyHandler.heKeyStates.rawValues[index], key.restPosition);
+    distance = distance * TRAVEL_DISTANCE_IN_0_01MM / gaussLUT.adcToDistance(key.downPosition, key.restPosition);
+    return constrain(TRAVEL_DISTANCE_IN_0_01MM - distance, 0, TRAVEL_DISTANCE_IN_0_01MM);
+}
+
+// Runs the key handler for one scan at the configured scan rate with the specified sensor values of all keys, checking the distance
+// of every calibrated key against the division. Returns the amount of keys checked.
+static uint8_t runScan(const uint16_t *values)
+{
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        Simulator.setAnalogValue(HE_PIN(i), values[i]);
+
+    Simulator.advance(1000000 / ConfigController.config.scanRate);
+    KeyHandler.handle();
+
+    uint8_t checked = 0;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        if (!KeyHandler.heKeys[i].calibrated)
+            continue;
+
+        TEST_ASSERT_EQUAL_UINT16(getExpectedDistance(i), KeyHandler.heKeyStates.distances[i]);
+        checked++;
+    }
+
+    return checked;
+}
+
+// Sweeps all keys from the specified start values to the end values and back in steps of 1, returning the amount of keys checked.
+static uint32_t sweep(const uint16_t *start, const uint16_t *end)
+{
+    uint32_t checked = 0;
+    uint16_t values[HE_KEYS];
+    for (uint16_t step = 0; step <= 2 * 1200; step++)
+    {
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+        {
+            const uint16_t range = abs(start[i] - end[i]);
+            const uint16_t offset = step <= range ? step : step <= 2 * range ? 2 * range - step : 0;
+            values[i] = start[i] < end[i] ? start[i] + offset : start[i] - offset;
+        }
+
+        checked += runScan(values);
+    }
+
+    return checked;
+}
+
+// The rest positions of the keys, being different for every key.
+static uint16_t restValues[HE_KEYS];
+
+// The down positions of the keys, being different for every key.
+static uint16_t downValues[HE_KEYS];
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_calibrating_sweep_matches_division()
+{
+    // Press all keys to their down position, calibrating them during the sweep. Every scale is only valid for the boundaries it has
+    // been cached for, so the boundaries changing during the sweep also checks that the scale is updated with them.
+    TEST_ASSERT_GREATER_THAN(0, sweep(restValues, downValues));
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        TEST_ASSERT_TRUE(KeyHandler.heKeys[i].calibrated);
+}
+
+void test_calibrated_sweep_matches_division()
+{
+    // Sweep over the whole range beyond the boundaries of the keys, covering distances clamped at both ends.
+    uint16_t start[HE_KEYS];
+    uint16_t end[HE_KEYS];
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        start[i] = restValues[i] + 50;
+        end[i] = downValues[i] - 50;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32((2 * 1200 + 1) * HE_KEYS, sweep(start, end));
+}
+
+void test_narrow_range_matches_division()
+{
+    // Restart the calibration of the keys with a range barely above the minimum distance, resulting in big scales.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        KeyHandler.heKeys[i].restPosition = 0;
+        KeyHandler.heKeys[i].downPosition = (1 << ANALOG_RESOLUTION) - 1;
+        KeyHandler.heKeys[i].calibrated = false;
+        downValues[i] = restValues[i] - SENSOR_BOUNDARY_MIN_DISTANCE - 2 * SENSOR_BOUNDARY_DEADZONE - 10 * i;
+    }
+
+    sweep(restValues, downValues);
+    TEST_ASSERT_EQUAL_UINT32((2 * 1200 + 1) * HE_KEYS, sweep(restValues, downValues));
+}
+
+int main()
+{
+    // Boot the firmware with every key resting at a different position.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        restValues[i] = 1900 + 100 * i;
+        downValues[i] = 1300 - 100 * i;
+        Simulator.setAnalogValue(HE_PIN(i), restValues[i]);
+    }
+
+    ConfigController.loadConfig();
+    ADCSampler.begin();
+    ScanTimer.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_calibrating_sweep_matches_division);
+    RUN_TEST(test_calibrated_sweep_matches_division);
+    RUN_TEST(test_narrow_range_matches_division);
+    return UNITY_END();
+}
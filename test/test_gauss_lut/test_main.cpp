@@ -0,0 +1,92 @@
+#include <unity.h>
+#include <cmath>
+#include "helpers/gauss_lut.hpp"
+#include "definitions.hpp"
+
+// Tests the lookup table generated at compile time against the equation calculated at runtime with the math functions of the
+// standard library, like the table was filled at bootup before it was generated at compile time.
+
+// The table generated at compile time, which fails to compile if the generation is not a constant expression.
+static constexpr GaussLUT gaussLUT = GaussLUT();
+
+// The parameters of the equation, taken from the definitions.
+static constexpr double a = GAUSS_CORRECTION_PARAM_A;
+static constexpr double b = GAUSS_CORRECTION_PARAM_B;
+static constexpr double c = GAUSS_CORRECTION_PARAM_C;
+static constexpr double d = GAUSS_CORRECTION_PARAM_D;
+
+// Returns the distance at the specified index of the table, calculated at runtime like the table was filled before.
+static uint16_t getDistance(uint16_t index)
+{
+    const double distance = (std::log(1 - ((index + d) / a)) / -b) - c;
+    return distance < 0 ? 0 : distance > TRAVEL_DISTANCE_IN_0_01MM ? TRAVEL_DISTANCE_IN_0_01MM : distance;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_table_matches_equation()
+{
+    // Every entry has to match the equation exactly. The truncation to whole numbers may only differ if the exact distance is
+    // so close to a whole number that the approximations of the logarithm differ in the last bits.
+    uint16_t mismatches = 0;
+    for (uint16_t i = 0; i < a - d; i++)
+    {
+        const uint16_t expected = getDistance(i);
+        const uint16_t actual = gaussLUT.lookup(i);
+        if (actual != expected)
+        {
+            const double distance = (std::log(1 - ((i + d) / a)) / -b) - c;
+            TEST_ASSERT_TRUE(std::fabs(distance - std::round(distance)) < 1e-9);
+            TEST_ASSERT_UINT16_WITHIN(1, expected, actual);
+            mismatches++;
+        }
+    }
+
+    TEST_ASSERT_LESS_OR_EQUAL(2, mismatches);
+}
+
+void test_rest_position_matches_equation()
+{
+    // The offset to a rest position of 0 is the rest position of the table itself.
+    const uint16_t expected = a * (1 - std::exp(-b * c)) - d;
+    TEST_ASSERT_EQUAL_INT16(expected, gaussLUT.getOffset(0));
+    TEST_ASSERT_EQUAL_INT16(expected - 2000, gaussLUT.getOffset(2000));
+}
+
+void test_lookup_clamps_indices()
+{
+    // Indices above the table equal to a distance of 0, indices below it to the first entry.
+    const uint16_t size = (uint16_t)std::ceil(a - d);
+    TEST_ASSERT_EQUAL_UINT16(0, gaussLUT.lookup(size));
+    TEST_ASSERT_EQUAL_UINT16(0, gaussLUT.lookup(1 << ANALOG_RESOLUTION));
+    TEST_ASSERT_EQUAL_UINT16(gaussLUT.lookup(0), gaussLUT.lookup(-1));
+    TEST_ASSERT_EQUAL_UINT16(gaussLUT.lookup(0), gaussLUT.lookup(-1000));
+}
+
+void test_adc_to_distance_shifts_by_rest_position()
+{
+    // A sensor resting at a different position than the table is shifted onto the table, reading the distance at the same offset.
+    const int16_t offset = gaussLUT.getOffset(0);
+    for (uint16_t restPosition = 1800; restPosition <= 2200; restPosition += 100)
+        for (uint16_t adc = restPosition - 1000; adc <= restPosition; adc += 50)
+            TEST_ASSERT_EQUAL_UINT16(gaussLUT.lookup(adc - restPosition + offset), gaussLUT.adcToDistance(adc, restPosition));
+
+    // The rest position always maps to the same distance, regardless of where the sensor rests.
+    TEST_ASSERT_EQUAL_UINT16(gaussLUT.adcToDistance(1900, 1900), gaussLUT.adcToDistance(2100, 2100));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_table_matches_equation);
+    RUN_TEST(test_rest_position_matches_equation);
+    RUN_TEST(test_lookup_clamps_indices);
+    RUN_TEST(test_adc_to_distance_shifts_by_rest_position);
+    return UNITY_END();
+}
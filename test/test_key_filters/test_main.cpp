@@ -0,0 +1,270 @@
+#include <unity.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+#include "helpers/key_filter.hpp"
+#include "definitions.hpp"
+
+// Tests the filters selectable per Hall Effect key against floating-point reference implementations, and the switching between them.
+
+// The amount of heap allocations made, counted by replacing the global operator new.
+static uint32_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    if (void *pointer = std::malloc(size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+// Returns a signal of a key resting with noise, being pressed quickly, held and released slowly, with random noise on top.
+static std::vector<uint16_t> getSignal()
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int32_t> noise(-8, 8);
+    std::vector<uint16_t> signal;
+    for (uint16_t i = 0; i < 4000; i++)
+    {
+        int32_t value = 2040;
+        if (i >= 1000 && i < 1020)
+            value = 2040 - (i - 1000) * 45;
+        else if (i >= 1020 && i < 2000)
+            value = 1140;
+        else if (i >= 2000 && i < 3000)
+            value = 1140 + (i - 2000) * 9 / 10;
+
+        signal.push_back(value + noise(generator));
+    }
+
+    return signal;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_sma_matches_average()
+{
+    // Once the buffer has been filled, the output is the truncated average of the last values.
+    constexpr uint8_t samples = 1 << SMA_FILTER_SAMPLE_EXPONENT;
+    const std::vector<uint16_t> signal = getSignal();
+    SMAFilter filter;
+    for (size_t i = 0; i < signal.size(); i++)
+    {
+        const uint16_t value = filter(signal[i]);
+        if (i + 1 < samples)
+            continue;
+
+        uint32_t sum = 0;
+        for (size_t j = i + 1 - samples; j <= i; j++)
+            sum += signal[j];
+        TEST_ASSERT_EQUAL_UINT16(sum / samples, value);
+    }
+}
+
+void test_ema_matches_reference()
+{
+    // The fixed-point average stays within rounding of the floating-point one.
+    const std::vector<uint16_t> signal = getSignal();
+    EMAFilter filter;
+    filter.reset(signal[0]);
+    double average = signal[0];
+    for (uint16_t value : signal)
+    {
+        average += (value - average) / (1 << EMA_FILTER_ALPHA_EXPONENT);
+        const uint16_t filtered = filter(value);
+        TEST_ASSERT_INT_WITHIN(1, (int32_t)std::round(average), filtered);
+    }
+}
+
+void test_median_matches_reference()
+{
+    // The output is the median of the last values, rejecting single spikes completely.
+    std::vector<uint16_t> signal = getSignal();
+    for (size_t i = 50; i < signal.size(); i += 100)
+        signal[i] = i % 200 ? 0 : 4095;
+
+    MedianFilter filter;
+    filter.reset(signal[0]);
+    for (size_t i = 0; i < signal.size(); i++)
+    {
+        std::vector<uint16_t> window;
+        for (size_t j = i + 1 - std::min<size_t>(i + 1, MEDIAN_FILTER_SAMPLES); j <= i; j++)
+            window.push_back(signal[j]);
+        while (window.size() < MEDIAN_FILTER_SAMPLES)
+            window.push_back(signal[0]);
+
+        std::nth_element(window.begin(), window.begin() + MEDIAN_FILTER_SAMPLES / 2, window.end());
+        const uint16_t value = filter(signal[i]);
+        TEST_ASSERT_EQUAL_UINT16(window[MEDIAN_FILTER_SAMPLES / 2], value);
+        TEST_ASSERT_TRUE(value > 0 && value < 4095);
+    }
+}
+
+void test_one_euro_matches_reference()
+{
+    // The fixed-point filter stays close to the floating-point One-Euro filter with the same parameters, given per scan.
+    const std::vector<uint16_t> signal = getSignal();
+    OneEuroFilter filter;
+    filter.reset(signal[0]);
+    double value = signal[0];
+    double previousInput = signal[0];
+    double derivative = 0;
+    for (uint16_t input : signal)
+    {
+        derivative += (input - previousInput - derivative) / (1 << ONE_EURO_FILTER_DERIVATIVE_EXPONENT);
+        previousInput = input;
+        const double cutoff = (ONE_EURO_FILTER_MIN_CUTOFF + std::abs(derivative) * ONE_EURO_FILTER_BETA) / 256;
+        value += (input - value) * cutoff / (1 + cutoff);
+        const uint16_t filtered = filter(input);
+        TEST_ASSERT_INT_WITHIN(3, (int32_t)std::round(value), filtered);
+    }
+}
+
+void test_one_euro_adapts_to_speed()
+{
+    // At rest, the noise is smoothed considerably more than by the EMA filter, while the fast press is followed with less delay.
+    const std::vector<uint16_t> signal = getSignal();
+    OneEuroFilter oneEuro;
+    EMAFilter ema;
+    oneEuro.reset(signal[0]);
+    ema.reset(signal[0]);
+    int32_t oneEuroNoise = 0;
+    int32_t emaNoise = 0;
+    int32_t oneEuroLag = 0;
+    int32_t emaLag = 0;
+    for (size_t i = 0; i < signal.size(); i++)
+    {
+        const int32_t oneEuroValue = oneEuro(signal[i]);
+        const int32_t emaValue = ema(signal[i]);
+        if (i < 1000)
+        {
+            oneEuroNoise = std::max(oneEuroNoise, std::abs(oneEuroValue - 2040));
+            emaNoise = std::max(emaNoise, std::abs(emaValue - 2040));
+        }
+        else if (i < 1030)
+        {
+            oneEuroLag = std::max(oneEuroLag, oneEuroValue - (int32_t)signal[i]);
+            emaLag = std::max(emaLag, emaValue - (int32_t)signal[i]);
+        }
+    }
+
+    TEST_ASSERT_LESS_THAN(emaNoise, oneEuroNoise);
+    TEST_ASSERT_LESS_OR_EQUAL(emaLag * 2, oneEuroLag);
+}
+
+void test_key_filter_passes_selected_filter()
+{
+    // The key filter returns the output of the selected filter, for every type of filter.
+    const std::vector<uint16_t> signal = getSignal();
+    for (uint8_t type = 0; type < (uint8_t)FilterType::Count; type++)
+    {
+        KeyFilter keyFilter;
+        keyFilter.setType((FilterType)type);
+        keyFilter.reset(signal[0]);
+        SMAFilter sma;
+        EMAFilter ema;
+        OneEuroFilter oneEuro;
+        MedianFilter median;
+        sma.reset(signal[0]);
+        ema.reset(signal[0]);
+        oneEuro.reset(signal[0]);
+        median.reset(signal[0]);
+        for (uint16_t value : signal)
+        {
+            const uint16_t expected = type == (uint8_t)FilterType::EMA       ? ema(value)
+                                      : type == (uint8_t)FilterType::OneEuro ? oneEuro(value)
+                                      : type == (uint8_t)FilterType::Median  ? median(value)
+                                                                             : sma(value);
+            const uint16_t filtered = keyFilter(value);
+            TEST_ASSERT_EQUAL_UINT16(expected, filtered);
+        }
+    }
+}
+
+void test_key_filter_initialization()
+{
+    // The key filter is initialized once the SMA filter has filled its buffer, regardless of the type, or right away if reset.
+    for (uint8_t type = 0; type < (uint8_t)FilterType::Count; type++)
+    {
+        KeyFilter keyFilter;
+        keyFilter.setType((FilterType)type);
+        for (uint8_t i = 0; i < (1 << SMA_FILTER_SAMPLE_EXPONENT); i++)
+        {
+            TEST_ASSERT_FALSE(keyFilter.initialized);
+            keyFilter(2040);
+        }
+
+        TEST_ASSERT_TRUE(keyFilter.initialized);
+    }
+
+    KeyFilter keyFilter;
+    keyFilter.reset(2040);
+    TEST_ASSERT_TRUE(keyFilter.initialized);
+    const uint16_t filtered = keyFilter(2040);
+    TEST_ASSERT_EQUAL_UINT16(2040, filtered);
+}
+
+void test_switching_filters_does_not_jump()
+{
+    // Switching the filter continues from the last filtered value, instead of starting from an empty state.
+    KeyFilter keyFilter;
+    keyFilter.reset(2040);
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        const uint8_t type = i % (uint8_t)FilterType::Count;
+        keyFilter.setType((FilterType)type);
+        TEST_ASSERT_EQUAL(type, (uint8_t)keyFilter.getType());
+        const uint16_t filtered = keyFilter(2040);
+        TEST_ASSERT_UINT16_WITHIN(1, 2040, filtered);
+    }
+}
+
+void test_no_heap_allocations()
+{
+    // Neither creating, filtering with nor switching the filters allocates memory on the heap.
+    const uint32_t before = allocations;
+    KeyFilter keyFilters[4];
+    for (uint16_t i = 0; i < 1000; i++)
+        for (uint8_t type = 0; type < (uint8_t)FilterType::Count; type++)
+        {
+            keyFilters[type].setType((FilterType)((type + i) % (uint8_t)FilterType::Count));
+            keyFilters[type](2040 - i);
+        }
+
+    TEST_ASSERT_EQUAL_UINT32(before, allocations);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sma_matches_average);
+    RUN_TEST(test_ema_matches_reference);
+    RUN_TEST(test_median_matches_reference);
+    RUN_TEST(test_one_euro_matches_reference);
+    RUN_TEST(test_one_euro_adapts_to_speed);
+    RUN_TEST(test_key_filter_passes_selected_filter);
+    RUN_TEST(test_key_filter_initialization);
+    RUN_TEST(test_switching_filters_does_not_jump);
+    RUN_TEST(test_no_heap_allocations);
+    return UNITY_END();
+}
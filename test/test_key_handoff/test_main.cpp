@@ -0,0 +1,175 @@
+#include <unity.h>
+#include <thread>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/hid_usage.hpp"
+#include "helpers/spsc_queue.hpp"
+#include "definitions.hpp"
+
+// Tests the handoff of the key transitions from the scanning core to the core sending the HID reports through the lock-free queue.
+static_assert(DIGITAL_KEYS >= 1, "The test requires at least one digital key.");
+
+// Returns the pressed state of the digital key as sent via the HID interface, not the level of its pin.
+static bool getPressed()
+{
+    return static_cast<const Key &>(KeyHandler.digitalKeys[0]).pressed;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_queue_keeps_order()
+{
+    // Items are popped in the order they were pushed, until the queue is empty.
+    SPSCQueue<uint32_t, 8> queue;
+    uint32_t item;
+    TEST_ASSERT_FALSE(queue.pop(item));
+    for (uint32_t i = 0; i < 5; i++)
+        TEST_ASSERT_TRUE(queue.push(i));
+
+    TEST_ASSERT_EQUAL(5, queue.size());
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item);
+    }
+
+    TEST_ASSERT_FALSE(queue.pop(item));
+}
+
+void test_full_queue_rejects_items()
+{
+    // A full queue rejects further items without overwriting the queued ones, taking items again once one has been popped.
+    SPSCQueue<uint32_t, 4> queue;
+    for (uint32_t i = 0; i < 4; i++)
+        TEST_ASSERT_TRUE(queue.push(i));
+
+    TEST_ASSERT_FALSE(queue.push(4));
+    uint32_t item;
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_UINT32(0, item);
+    TEST_ASSERT_TRUE(queue.push(4));
+
+    for (uint32_t i = 1; i <= 4; i++)
+    {
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item);
+    }
+}
+
+void test_indices_wrap_around()
+{
+    // The free-running indices overflow after 65536 items, which must neither lose items nor make the queue appear full or empty.
+    SPSCQueue<uint32_t, 4> queue;
+    uint32_t item;
+    for (uint32_t i = 0; i < 70000; i++)
+    {
+        TEST_ASSERT_TRUE(queue.push(i));
+        TEST_ASSERT_TRUE(queue.push(i + 1));
+        TEST_ASSERT_EQUAL(2, queue.size());
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item);
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i + 1, item);
+    }
+}
+
+void test_concurrent_producer_and_consumer()
+{
+    // Push items from one thread and pop them from another, like the two cores do. Every item has to arrive once and in order.
+    static SPSCQueue<KeyEvent, KEY_EVENT_QUEUE_SIZE> queue;
+    constexpr uint32_t items = 1000000;
+    std::thread producer([]
+    {
+        for (uint32_t i = 0; i < items; i++)
+            while (!queue.push({(uint8_t)i, 0, (i & 1) != 0, (uint8_t)(i >> 8), i}))
+                std::this_thread::yield();
+    });
+
+    uint32_t received = 0;
+    uint32_t mismatches = 0;
+    KeyEvent event;
+    while (received < items)
+    {
+        if (!queue.pop(event))
+            continue;
+
+        mismatches += event.timestamp != received || event.usage != (uint8_t)received || event.pressed != ((received & 1) != 0) || event.key != (uint8_t)(received >> 8);
+        received++;
+    }
+
+    producer.join();
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+void test_transitions_held_back_while_queue_full()
+{
+    // Press and release the digital key repeatedly while only scanning, without sending the HID reports, like the HID core being busy.
+    // Once the queue is full, the transitions are held back, with the key keeping its state until the transition could be queued.
+    const uint32_t scanPeriod = 1000000 / ConfigController.config.scanRate;
+    for (uint16_t i = 0; i < KEY_EVENT_QUEUE_SIZE; i++)
+    {
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), false);
+        for (uint16_t scan = 0; scan < 2; scan++)
+        {
+            Simulator.advance(scanPeriod);
+            KeyHandler.scan();
+        }
+
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), true);
+        for (uint32_t scan = 0; scan < DIGITAL_DEBOUNCE_TIME / scanPeriod + 2; scan++)
+        {
+            Simulator.advance(scanPeriod);
+            KeyHandler.scan();
+        }
+    }
+
+    Simulator.setDigitalLevel(DIGITAL_PIN(0), false);
+    for (uint16_t scan = 0; scan < 10; scan++)
+    {
+        Simulator.advance(scanPeriod);
+        KeyHandler.scan();
+    }
+
+    TEST_ASSERT_FALSE(getPressed());
+    TEST_ASSERT_EQUAL(0, Simulator.keyboardReports.size());
+
+    // Once the HID core drains the queue, the press held back is queued on the next scan and sent in the following report.
+    for (uint16_t i = 0; i < 40; i++)
+    {
+        Simulator.advance(scanPeriod);
+        KeyHandler.scan();
+        KeyHandler.report();
+    }
+
+    TEST_ASSERT_TRUE(getPressed());
+    TEST_ASSERT_GREATER_THAN(0, Simulator.keyboardReports.size());
+    TEST_ASSERT_TRUE(Simulator.keyboardReports.back().contains(HIDUsage::fromKeyChar(ConfigController.config.digitalKeys[0].keyChar).usage));
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of the digital key enabled, without starting the scan timer, as the scans are run manually.
+    ConfigController.loadConfig();
+    ConfigController.config.digitalKeys[0].hidEnabled = true;
+    KeyHandler.begin();
+    ADCSampler.begin();
+    DigitalSampler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_keeps_order);
+    RUN_TEST(test_full_queue_rejects_items);
+    RUN_TEST(test_indices_wrap_around);
+    RUN_TEST(test_concurrent_producer_and_consumer);
+    RUN_TEST(test_transitions_held_back_while_queue_full);
+    return UNITY_END();
+}
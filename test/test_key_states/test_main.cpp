@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <random>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests the Hall Effect keys processed in batched passes over the key states against a model processing every key on its own,
+// reading the settings through the configuration of the key, like the keys were processed before the key states were introduced.
+// All keys are moved randomly and independently with different settings, comparing the pressed state of every key on every scan.
+static_assert(HE_KEYS >= 2, "The test requires at least two Hall Effect keys.");
+
+// The model of a Hall Effect key in traditional mode, checking the distance against the hysteresis of the configuration.
+struct KeyModel
+{
+    HEKeyConfig config;
+    bool pressed = false;
+
+    void check(uint16_t distance)
+    {
+        if (distance <= config.lowerHysteresis && config.hidEnabled)
+            pressed = true;
+        else if (distance >= config.upperHysteresis)
+            pressed = false;
+    }
+};
+
+static KeyModel models[HE_KEYS];
+
+// The random number generator moving the keys, seeded with a constant so every run moves the keys the same way.
+static std::mt19937 generator(1234);
+
+// The current sensor values, the values the keys are moving to and the speed they are moving at, per key.
+static int32_t values[HE_KEYS];
+static int32_t targets[HE_KEYS];
+static int32_t speeds[HE_KEYS];
+
+// Moves every key towards its target, picking a new target and speed once it has been reached.
+static void moveKeys()
+{
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        if (values[i] == targets[i])
+        {
+            targets[i] = std::uniform_int_distribution<int32_t>(1100, 2100)(generator);
+            speeds[i] = std::uniform_int_distribution<int32_t>(1, 60)(generator);
+        }
+
+        values[i] += constrain(targets[i] - values[i], -speeds[i], speeds[i]);
+        Simulator.setAnalogValue(HE_PIN(i), values[i]);
+    }
+}
+
+// Runs the key handler for the specified amount of scans at the configured scan rate while moving the keys, comparing the pressed
+// state of every key with the model after every scan. Returns the amount of transitions of all keys.
+static uint32_t runScans(uint32_t scans)
+{
+    uint32_t transitions = 0;
+    for (uint32_t scan = 0; scan < scans; scan++)
+    {
+        moveKeys();
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+        {
+            const bool pressed = models[i].pressed;
+            models[i].check(KeyHandler.heKeyStates.distances[i]);
+            transitions += pressed != models[i].pressed;
+            TEST_ASSERT_EQUAL(models[i].pressed, KeyHandler.heKeys[i].pressed);
+        }
+    }
+
+    return transitions;
+}
+
+// Applies the specified hysteresis to the specified key in the configuration and the model, requesting the key states to be updated.
+static void setHysteresis(uint8_t index, uint16_t lower, uint16_t upper)
+{
+    ConfigController.config.heKeys[index].lowerHysteresis = lower;
+    ConfigController.config.heKeys[index].upperHysteresis = upper;
+    models[index].config = ConfigController.config.heKeys[index];
+    KeyHandler.requestConfigSync();
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_keys_match_model()
+{
+    // Give every key a different hysteresis, so keys reading the settings of another key are noticed.
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        setHysteresis(i, 100 + 60 * i, 150 + 70 * i);
+
+    TEST_ASSERT_GREATER_THAN(100 * HE_KEYS, runScans(50000));
+}
+
+void test_settings_only_change_on_sync()
+{
+    // Changing the configuration without requesting the key states to be updated keeps the keys on the previous settings.
+    const uint16_t lowerHysteresis = ConfigController.config.heKeys[0].lowerHysteresis;
+    ConfigController.config.heKeys[0].lowerHysteresis = 50;
+    runScans(1000);
+    TEST_ASSERT_EQUAL_UINT16(lowerHysteresis, KeyHandler.heKeyStates.lowerHysteresis[0]);
+
+    // Once requested, the settings of the changed key are updated before the next scan, leaving the other keys untouched.
+    setHysteresis(0, 50, ConfigController.config.heKeys[0].upperHysteresis);
+    runScans(1);
+    TEST_ASSERT_EQUAL_UINT16(50, KeyHandler.heKeyStates.lowerHysteresis[0]);
+    for (uint8_t i = 1; i < HE_KEYS; i++)
+        TEST_ASSERT_EQUAL_UINT16(100 + 60 * i, KeyHandler.heKeyStates.lowerHysteresis[i]);
+
+    TEST_ASSERT_GREATER_THAN(100 * HE_KEYS, runScans(50000));
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of all Hall Effect keys enabled and the keys resting.
+    ConfigController.loadConfig();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        ConfigController.config.heKeys[i].hidEnabled = true;
+        models[i].config = ConfigController.config.heKeys[i];
+        values[i] = targets[i] = 2040;
+        Simulator.setAnalogValue(HE_PIN(i), values[i]);
+    }
+
+    ADCSampler.begin();
+    ScanTimer.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_keys_match_model);
+    RUN_TEST(test_settings_only_change_on_sync);
+    return UNITY_END();
+}
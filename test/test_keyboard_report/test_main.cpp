@@ -0,0 +1,422 @@
+#include <unity.h>
+#include <cstring>
+#include <random>
+#include <set>
+#include <Arduino.h>
+#include <tusb.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/hid_usage.hpp"
+#include "helpers/keyboard_report.hpp"
+#include "definitions.hpp"
+
+// Tests the keyboard state tracking the pressed HID usages as a bitmap, and its conversion into NKRO and boot protocol reports. The
+// conversions are compared against a reference built from a set of the pressed usages, which is what the host device should see from
+// the report. The key handler has to send the NKRO report while the host device uses the report protocol and the boot protocol report
+// otherwise, with the keys typing shifted characters holding the shift modifier.
+static_assert(DIGITAL_KEYS >= 1, "The test requires at least one digital key.");
+
+// The generator for the usages, seeded with a constant so every run uses the same usages.
+static std::mt19937 generator(42);
+
+// Converts the specified keyboard state into a boot protocol report, with the key slots being filled with garbage beforehand.
+static void toBootReport(const KeyboardReport &report, uint8_t &modifiers, uint8_t (&keys)[6])
+{
+    modifiers = 0xAA;
+    memset(keys, 0xAA, sizeof(keys));
+    report.toBootReport(modifiers, keys);
+}
+
+// Checks the boot protocol report of the specified keyboard state against the reference built from the specified pressed usages.
+// The modifiers are the bits of the usages 0xE0 to 0xE7, and the keys are the other pressed usages in ascending order, leaving
+// out the reserved ones. If more than 6 keys are pressed, all key slots contain the rollover error.
+static void checkBootReport(const KeyboardReport &report, const std::set<uint8_t> &pressed, uint8_t heldModifiers = 0)
+{
+    uint8_t expectedModifiers = heldModifiers;
+    uint8_t expectedKeys[6] = {0};
+    uint8_t count = 0;
+    for (uint8_t usage : pressed)
+    {
+        if (usage >= 0xE0 && usage <= 0xE7)
+            expectedModifiers |= 1 << (usage - 0xE0);
+        else if (usage >= 4 && usage < 0xE0)
+        {
+            if (count == 6)
+                memset(expectedKeys, 0x01, sizeof(expectedKeys));
+            else if (count < 6)
+                expectedKeys[count] = usage;
+
+            count++;
+        }
+    }
+
+    uint8_t modifiers;
+    uint8_t keys[6];
+    toBootReport(report, modifiers, keys);
+    TEST_ASSERT_EQUAL_UINT8(expectedModifiers, modifiers);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expectedKeys, keys, 6);
+}
+
+// Checks the NKRO report of the specified keyboard state against the reference built from the specified pressed usages. The modifiers
+// are the bits of the usages 0xE0 to 0xE7, followed by the bitmap of all other pressed usages up to 0xDF, leaving out the reserved ones.
+static void checkNKROReport(const KeyboardReport &report, const std::set<uint8_t> &pressed, uint8_t heldModifiers = 0)
+{
+    uint8_t expected[KeyboardReport::nkroReportSize] = {heldModifiers};
+    for (uint8_t usage : pressed)
+    {
+        if (usage >= 0xE0 && usage <= 0xE7)
+            expected[0] |= 1 << (usage - 0xE0);
+        else if (usage >= 4 && usage < 0xE0)
+            expected[1 + usage / 8] |= 1 << (usage % 8);
+    }
+
+    uint8_t actual[KeyboardReport::nkroReportSize];
+    memset(actual, 0xAA, sizeof(actual));
+    report.toNKROReport(actual);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, KeyboardReport::nkroReportSize);
+}
+
+// Lets the key handler scan and report until it sent a new keyboard report, returning it.
+static const Simulator::KeyboardReport &sendReport()
+{
+    const size_t reports = Simulator.keyboardReports.size();
+    for (uint32_t i = 0; i < 1000 && Simulator.keyboardReports.size() == reports; i++)
+    {
+        Simulator.advance(100);
+        KeyHandler.scan();
+        KeyHandler.report();
+    }
+
+    TEST_ASSERT_EQUAL(reports + 1, Simulator.keyboardReports.size());
+    return Simulator.keyboardReports.back();
+}
+
+// Binds the digital key to the specified key char and presses or releases it, letting the key handler send the resulting report.
+static const Simulator::KeyboardReport &pressKey(char keyChar, bool pressed)
+{
+    ConfigController.config.digitalKeys[0].keyChar = keyChar;
+    KeyHandler.requestConfigSync();
+    Simulator.setDigitalLevel(DIGITAL_PIN(0), !pressed);
+    return sendReport();
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_press_and_release()
+{
+    // Pressing and releasing a usage returns whether the state changed, so a usage pressed twice, or released while not being
+    // pressed, does not change anything. Usage 0 means no key and can never be pressed.
+    KeyboardReport report;
+    TEST_ASSERT_TRUE(report.press(0x04));
+    TEST_ASSERT_FALSE(report.press(0x04));
+    TEST_ASSERT_TRUE(report.release(0x04));
+    TEST_ASSERT_FALSE(report.release(0x04));
+    TEST_ASSERT_FALSE(report.press(0x00));
+    TEST_ASSERT_FALSE(report.release(0x00));
+    TEST_ASSERT_TRUE(report.press(0xFF));
+    TEST_ASSERT_TRUE(report.release(0xFF));
+    checkBootReport(report, {});
+}
+
+void test_modifiers()
+{
+    // The modifier usages end up in the modifier byte instead of the key slots, in the order of their bits.
+    KeyboardReport report;
+    report.press(0xE0);
+    report.press(0xE5);
+    report.press(0x1D);
+    checkBootReport(report, {0xE0, 0xE5, 0x1D});
+
+    uint8_t modifiers;
+    uint8_t keys[6];
+    toBootReport(report, modifiers, keys);
+    TEST_ASSERT_EQUAL_UINT8(0x21, modifiers);
+    TEST_ASSERT_EQUAL_UINT8(0x1D, keys[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x00, keys[1]);
+}
+
+void test_six_keys_and_rollover()
+{
+    // Up to 6 keys are reported in ascending order of their usages, no matter the order they have been pressed in. With a 7th key, all
+    // key slots report the rollover error while the modifiers are still reported, until a key is released again.
+    KeyboardReport report;
+    const uint8_t usages[] = {0xDF, 0x2C, 0x04, 0x9A, 0x1E, 0x65};
+    std::set<uint8_t> pressed;
+    for (uint8_t usage : usages)
+    {
+        report.press(usage);
+        pressed.insert(usage);
+        checkBootReport(report, pressed);
+    }
+
+    report.press(0xE1);
+    report.press(0x50);
+    pressed.insert({0xE1, 0x50});
+    checkBootReport(report, pressed);
+
+    uint8_t modifiers;
+    uint8_t keys[6];
+    toBootReport(report, modifiers, keys);
+    TEST_ASSERT_EQUAL_UINT8(0x02, modifiers);
+    for (uint8_t key : keys)
+        TEST_ASSERT_EQUAL_UINT8(0x01, key);
+
+    report.release(0x9A);
+    pressed.erase(0x9A);
+    checkBootReport(report, pressed);
+
+    // Pressing all usages sharing a byte of the bitmap is a rollover as well.
+    KeyboardReport fullByte;
+    for (uint8_t usage = 0x08; usage <= 0x0F; usage++)
+        fullByte.press(usage);
+
+    toBootReport(fullByte, modifiers, keys);
+    for (uint8_t key : keys)
+        TEST_ASSERT_EQUAL_UINT8(0x01, key);
+}
+
+void test_reserved_usages_not_reported()
+{
+    // The usages 1 to 3 are the error codes of the boot protocol and are never reported as keys, and do not count towards the rollover.
+    KeyboardReport report;
+    std::set<uint8_t> pressed;
+    for (uint8_t usage = 1; usage <= 9; usage++)
+    {
+        report.press(usage);
+        pressed.insert(usage);
+    }
+
+    checkBootReport(report, pressed);
+    uint8_t modifiers;
+    uint8_t keys[6];
+    toBootReport(report, modifiers, keys);
+    TEST_ASSERT_EQUAL_UINT8(0x04, keys[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x09, keys[5]);
+}
+
+void test_random_presses()
+{
+    // Random presses and releases across all usages always result in the report of the reference, with the return values matching
+    // whether the set of the pressed usages changed. Mostly keeping few keys pressed covers both the normal and the rollover reports.
+    KeyboardReport report;
+    std::set<uint8_t> pressed;
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        const uint8_t usage = generator() % 4 ? 0xD8 + generator() % 16 : generator() % 256;
+        if (generator() % 2)
+        {
+            const bool changed = report.press(usage);
+            const bool inserted = usage != 0 && pressed.insert(usage).second;
+            TEST_ASSERT_EQUAL(inserted, changed);
+        }
+        else
+        {
+            const bool changed = report.release(usage);
+            const bool erased = pressed.erase(usage) == 1;
+            TEST_ASSERT_EQUAL(erased, changed);
+        }
+
+        checkBootReport(report, pressed);
+        checkNKROReport(report, pressed);
+    }
+}
+
+void test_nkro_report_holds_all_keys()
+{
+    // The NKRO report contains all pressed keys at once, also beyond the 6 keys of the boot protocol, while the usages 1 to 3 and the
+    // usages above the modifiers are left out. The modifiers are reported in the first byte like in the boot protocol report.
+    KeyboardReport report;
+    std::set<uint8_t> pressed;
+    for (uint8_t usage = 1; usage < 0xE0; usage += 3)
+    {
+        report.press(usage);
+        pressed.insert(usage);
+    }
+
+    for (uint8_t usage : {0xE2, 0xE7, 0xE8, 0xFF})
+    {
+        report.press(usage);
+        pressed.insert(usage);
+    }
+
+    checkNKROReport(report, pressed);
+    uint8_t nkro[KeyboardReport::nkroReportSize];
+    report.toNKROReport(nkro);
+    TEST_ASSERT_EQUAL_UINT8(0x84, nkro[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x90, nkro[1]);
+
+    uint8_t modifiers;
+    uint8_t keys[6];
+    toBootReport(report, modifiers, keys);
+    TEST_ASSERT_EQUAL_UINT8(0x01, keys[0]);
+}
+
+void test_nkro_descriptor_matches_report()
+{
+    // The input items of the report descriptor add up to the size of the NKRO report, with one bit for every modifier and usage.
+    uint32_t reportSize = 0;
+    uint32_t reportCount = 0;
+    uint32_t bits = 0;
+    const uint8_t *descriptor = KeyboardReport::nkroDescriptor;
+    for (size_t i = 0; i < sizeof(KeyboardReport::nkroDescriptor);)
+    {
+        const uint8_t prefix = descriptor[i];
+        const uint8_t size = (prefix & 0x03) == 3 ? 4 : prefix & 0x03;
+        uint32_t value = 0;
+        for (uint8_t byte = 0; byte < size; byte++)
+            value |= descriptor[i + 1 + byte] << (byte * 8);
+
+        if ((prefix & 0xFC) == 0x74)
+            reportSize = value;
+        else if ((prefix & 0xFC) == 0x94)
+            reportCount = value;
+        else if ((prefix & 0xFC) == 0x80)
+            bits += reportSize * reportCount;
+
+        i += 1 + size;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(KeyboardReport::nkroReportSize * 8, bits);
+}
+
+void test_shifted_keys_hold_modifier()
+{
+    // Keys requiring a modifier hold it while pressed, until the last of them is released, with the modifier being reported along with
+    // the modifiers pressed as keys. Pressing or releasing the modifier key while it is held by another key does not change the report.
+    KeyboardReport report;
+    TEST_ASSERT_TRUE(report.press(0x04, HIDUsage::leftShift));
+    checkNKROReport(report, {0x04}, HIDUsage::leftShift);
+    checkBootReport(report, {0x04}, HIDUsage::leftShift);
+
+    TEST_ASSERT_TRUE(report.press(0x1E, HIDUsage::leftShift));
+    TEST_ASSERT_FALSE(report.press(0xE1));
+    TEST_ASSERT_TRUE(report.press(0xE0));
+    TEST_ASSERT_EQUAL_UINT8(0x03, report.getModifiers());
+
+    TEST_ASSERT_FALSE(report.release(0xE1));
+    TEST_ASSERT_TRUE(report.release(0x04, HIDUsage::leftShift));
+    checkNKROReport(report, {0x1E, 0xE0}, HIDUsage::leftShift);
+    TEST_ASSERT_TRUE(report.release(0x1E, HIDUsage::leftShift));
+    checkNKROReport(report, {0xE0});
+
+    // A shifted key pressed along with the plain key of the same usage only changes the modifiers.
+    TEST_ASSERT_TRUE(report.press(0x05));
+    TEST_ASSERT_TRUE(report.press(0x05, HIDUsage::leftShift));
+    TEST_ASSERT_EQUAL_UINT8(0x03, report.getModifiers());
+    TEST_ASSERT_TRUE(report.release(0x05, HIDUsage::leftShift));
+    TEST_ASSERT_EQUAL_UINT8(0x01, report.getModifiers());
+}
+
+void test_key_chars_resolved()
+{
+    // Every character on the upper half of a key on the US layout is resolved to the same usage as the character on its lower half,
+    // with the shift modifier. Modifier keys and usages passed directly never require a modifier.
+    const char *lower = "abcdefghijklmnopqrstuvwxyz1234567890-=[]\\;',./`";
+    const char *upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ!@#$%^&*()_+{}|:\"<>?~";
+    TEST_ASSERT_EQUAL(strlen(lower), strlen(upper));
+    for (size_t i = 0; i < strlen(lower); i++)
+    {
+        const HIDUsage::KeyCode plain = HIDUsage::fromKeyChar(lower[i]);
+        const HIDUsage::KeyCode shifted = HIDUsage::fromKeyChar(upper[i]);
+        TEST_ASSERT_NOT_EQUAL(0, plain.usage);
+        TEST_ASSERT_EQUAL_UINT8(plain.usage, shifted.usage);
+        TEST_ASSERT_EQUAL_UINT8(0, plain.modifiers);
+        TEST_ASSERT_EQUAL_UINT8(HIDUsage::leftShift, shifted.modifiers);
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(0x04, HIDUsage::fromKeyChar('A').usage);
+    TEST_ASSERT_EQUAL_UINT8(0x1F, HIDUsage::fromKeyChar('@').usage);
+    TEST_ASSERT_EQUAL_UINT8(0x27, HIDUsage::fromKeyChar(')').usage);
+    for (uint16_t keyChar = 128; keyChar < 256; keyChar++)
+    {
+        const HIDUsage::KeyCode keyCode = HIDUsage::fromKeyChar(keyChar);
+        TEST_ASSERT_EQUAL_UINT8(keyChar < 136 ? 0xE0 + keyChar - 128 : keyChar - 136, keyCode.usage);
+        TEST_ASSERT_EQUAL_UINT8(0, keyCode.modifiers);
+    }
+}
+
+void test_report_protocol_sends_nkro()
+{
+    // With the report protocol, the key handler sends the NKRO report.
+    const Simulator::KeyboardReport &pressed = pressKey('a', true);
+    TEST_ASSERT_TRUE(pressed.nkro);
+    TEST_ASSERT_TRUE(pressed.contains(0x04));
+
+    const Simulator::KeyboardReport &released = pressKey('a', false);
+    TEST_ASSERT_TRUE(released.nkro);
+    TEST_ASSERT_FALSE(released.contains(0x04));
+}
+
+void test_boot_protocol_fallback()
+{
+    // Once the host device selects the boot protocol, the current state is sent right away as a boot protocol report, and the following
+    // reports use the boot protocol as well. Selecting the report protocol again sends the NKRO report right away.
+    TEST_ASSERT_TRUE(pressKey('b', true).nkro);
+
+    Simulator.hidProtocol = HID_PROTOCOL_BOOT;
+    const Simulator::KeyboardReport &boot = sendReport();
+    TEST_ASSERT_FALSE(boot.nkro);
+    TEST_ASSERT_EQUAL_UINT8(0x05, boot.keys[0]);
+
+    const Simulator::KeyboardReport &released = pressKey('b', false);
+    TEST_ASSERT_FALSE(released.nkro);
+    TEST_ASSERT_EQUAL_UINT8(0x00, released.keys[0]);
+
+    Simulator.hidProtocol = HID_PROTOCOL_REPORT;
+    const Simulator::KeyboardReport &nkro = sendReport();
+    TEST_ASSERT_TRUE(nkro.nkro);
+    TEST_ASSERT_FALSE(nkro.contains(0x05));
+}
+
+void test_shifted_key_char_pressed_with_shift()
+{
+    // A key bound to a shifted character holds the shift modifier in the reports while it is pressed, in both protocols.
+    for (uint8_t protocol : {HID_PROTOCOL_REPORT, HID_PROTOCOL_BOOT})
+    {
+        Simulator.hidProtocol = protocol;
+        const Simulator::KeyboardReport &pressed = pressKey('!', true);
+        TEST_ASSERT_TRUE(pressed.contains(0x1E));
+        TEST_ASSERT_EQUAL_UINT8(HIDUsage::leftShift, pressed.modifiers);
+
+        // Rebinding the key to the plain character while it is pressed releases the shift modifier along with the old usage, with the
+        // key being pressed again with the new usage.
+        const Simulator::KeyboardReport &rebound = pressKey('1', true);
+        TEST_ASSERT_EQUAL_UINT8(0, rebound.modifiers);
+
+        const Simulator::KeyboardReport &released = pressKey('1', false);
+        TEST_ASSERT_FALSE(released.contains(0x1E));
+        TEST_ASSERT_EQUAL_UINT8(0, released.modifiers);
+    }
+}
+
+int main()
+{
+    // Boot the firmware with the NKRO report registered and the HID output of the digital key enabled, as the reports are also sent
+    // through the key handler.
+    ConfigController.loadConfig();
+    ConfigController.config.digitalKeys[0].hidEnabled = true;
+    KeyHandler.begin();
+    ADCSampler.begin();
+    DigitalSampler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_press_and_release);
+    RUN_TEST(test_modifiers);
+    RUN_TEST(test_six_keys_and_rollover);
+    RUN_TEST(test_reserved_usages_not_reported);
+    RUN_TEST(test_random_presses);
+    RUN_TEST(test_nkro_report_holds_all_keys);
+    RUN_TEST(test_nkro_descriptor_matches_report);
+    RUN_TEST(test_shifted_keys_hold_modifier);
+    RUN_TEST(test_key_chars_resolved);
+    RUN_TEST(test_report_protocol_sends_nkro);
+    RUN_TEST(test_boot_protocol_fallback);
+    RUN_TEST(test_shifted_key_char_pressed_with_shift);
+    return UNITY_END();
+}
@@ -0,0 +1,86 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests the latency measured for the digital keys, which starts at the edge on the pin as timestamped by the interrupt,
+// instead of the time of the scan noticing the changed level.
+static_assert(DIGITAL_KEYS >= 1, "The test requires at least one digital key.");
+
+// Runs the key handler for the specified amount of scans at the configured scan rate.
+static void runScans(uint32_t scans)
+{
+    for (uint32_t i = 0; i < scans; i++)
+    {
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+    }
+}
+
+// Changes the level of the first digital key in between two scans, returning the time of the edge.
+static uint32_t setLevel(bool high)
+{
+    Simulator.advance(1000000 / ConfigController.config.scanRate / 3);
+    Simulator.setDigitalLevel(DIGITAL_PIN(0), high);
+    return Simulator.getTime();
+}
+
+// Returns the latency histogram of the first digital key.
+static const LogHistogram &getHistogram()
+{
+    return KeyHandler.latencyTracker.histograms[HE_KEYS];
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_press_latency_starts_at_edge()
+{
+    // Press the key in between two scans. The latency covers the time until the next scan as well.
+    const uint32_t edgeAt = setLevel(false);
+    runScans(20);
+
+    TEST_ASSERT_EQUAL(1, Simulator.keyboardReports.size());
+    TEST_ASSERT_EQUAL_UINT32(1, getHistogram().count);
+    TEST_ASSERT_EQUAL_UINT32(Simulator.keyboardReports[0].time - edgeAt, getHistogram().max);
+}
+
+void test_release_latency_starts_at_edge()
+{
+    // Release the key in between two scans. The release is only reported once the pin has not changed for the debounce time,
+    // which is included in the latency, as the release has physically happened at the edge.
+    KeyHandler.latencyTracker.reset();
+    const uint32_t edgeAt = setLevel(true);
+    runScans(DIGITAL_DEBOUNCE_TIME * ConfigController.config.scanRate / 1000000 + 20);
+
+    TEST_ASSERT_EQUAL(2, Simulator.keyboardReports.size());
+    TEST_ASSERT_EQUAL_UINT32(1, getHistogram().count);
+    TEST_ASSERT_EQUAL_UINT32(Simulator.keyboardReports[1].time - edgeAt, getHistogram().max);
+    TEST_ASSERT_GREATER_OR_EQUAL(DIGITAL_DEBOUNCE_TIME, getHistogram().max);
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of the first digital key enabled.
+    ConfigController.loadConfig();
+    ConfigController.config.digitalKeys[0].hidEnabled = true;
+    KeyHandler.begin();
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+    runScans(20);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_press_latency_starts_at_edge);
+    RUN_TEST(test_release_latency_starts_at_edge);
+    return UNITY_END();
+}
@@ -0,0 +1,254 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests predictive actuation by replaying the same sensor trace on two keys with rapid trigger, one of them with predictive actuation.
+// The transitions of both keys are compared, measuring how many scans earlier the predicted key actuates and how many of its transitions
+// are false triggers without a matching transition on the other key. The movements accelerate and decelerate smoothly like a finger,
+// with noise on top.
+static_assert(HE_KEYS >= 2, "The test requires at least two Hall Effect keys.");
+
+// The generator for the movements and the noise, seeded with a constant so every run replays the same traces.
+static std::mt19937 generator(42);
+
+// The transitions of a key, with the scan they happened on and whether the key got pressed.
+using Transitions = std::vector<std::pair<uint32_t, bool>>;
+
+// The result of comparing the transitions of the predicted key with the ones of the reference key.
+struct Comparison
+{
+    // The amount of transitions of the reference key and the amount of them the predicted key performed earlier, in total and presses only.
+    uint32_t transitions = 0;
+    uint32_t earlier = 0;
+    uint32_t earlierPresses = 0;
+
+    // The total amount of scans the predicted transitions happened earlier.
+    uint32_t scansEarlier = 0;
+
+    // The amount of transitions of the predicted key without a matching transition of the reference key.
+    uint32_t falseTriggers = 0;
+};
+
+// Replays the specified trace of sensor values on the first two keys, returning the transitions of both.
+static std::pair<Transitions, Transitions> replay(const std::vector<uint16_t> &trace)
+{
+    std::pair<Transitions, Transitions> transitions;
+    for (uint32_t scan = 0; scan < trace.size(); scan++)
+    {
+        const bool reference = KeyHandler.heKeys[0].pressed;
+        const bool predicted = KeyHandler.heKeys[1].pressed;
+        Simulator.setAnalogValue(HE_PIN(0), trace[scan]);
+        Simulator.setAnalogValue(HE_PIN(1), trace[scan]);
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+
+        if (KeyHandler.heKeys[0].pressed != reference)
+            transitions.first.push_back({scan, !reference});
+        if (KeyHandler.heKeys[1].pressed != predicted)
+            transitions.second.push_back({scan, !predicted});
+    }
+
+    return transitions;
+}
+
+// Compares the transitions of the predicted key with the ones of the reference key. Every reference transition is matched by the next
+// predicted transition of the same direction that happens at most at the same scan and after the previous reference transition.
+static Comparison compare(const std::pair<Transitions, Transitions> &transitions)
+{
+    Comparison comparison;
+    const Transitions &reference = transitions.first;
+    const Transitions &predicted = transitions.second;
+    size_t next = 0;
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        const uint32_t previous = i > 0 ? reference[i - 1].first : 0;
+        while (next < predicted.size() && predicted[next].first <= reference[i].first)
+        {
+            if (predicted[next].second == reference[i].second && predicted[next].first >= previous && (next + 1 == predicted.size() || predicted[next + 1].first > reference[i].first))
+            {
+                comparison.earlier += predicted[next].first < reference[i].first;
+                comparison.earlierPresses += predicted[next].first < reference[i].first && reference[i].second;
+                comparison.scansEarlier += reference[i].first - predicted[next].first;
+                next++;
+                break;
+            }
+
+            comparison.falseTriggers++;
+            next++;
+        }
+    }
+
+    comparison.transitions = reference.size();
+    comparison.falseTriggers += predicted.size() - next;
+    return comparison;
+}
+
+// Returns a trace of smooth movements between random targets at random peak speeds in sensor units per scan, holding still for a random
+// time in between and with noise of up to the specified amplitude on top. Every movement accelerates and decelerates with a sine profile.
+// The direction of the movements is random, or alternating between pressing the key further down and returning to the start position.
+static std::vector<uint16_t> getTrace(uint32_t movements, int32_t minTravel, int32_t maxTravel, double maxSpeed, int32_t noise, double value = 2040, bool alternating = false)
+{
+    std::vector<uint16_t> trace;
+    std::uniform_int_distribution<int32_t> noiseDistribution(-noise, noise);
+    const double origin = value;
+    for (uint32_t i = 0; i < movements; i++)
+    {
+        // Pick a target within the travel distance, in a random direction as long as it stays within the range of the sensor.
+        const int32_t travel = std::uniform_int_distribution<int32_t>(minTravel, maxTravel)(generator);
+        double target = value + (!alternating && generator() % 2 ? travel : -travel);
+        if (target < 1150 || target > 2040)
+            target = value + (target < 1150 ? travel : -travel);
+        target = alternating && i % 2 ? origin : constrain(target, 1150.0, 2040.0);
+
+        // Move there with a sine-shaped speed profile, which takes pi / 2 times the time of moving at the peak speed constantly.
+        const double speed = std::uniform_real_distribution<double>(0.5, maxSpeed)(generator);
+        const uint32_t scans = std::max<uint32_t>(2, std::abs(target - value) / speed * M_PI / 2);
+        const double start = value;
+        for (uint32_t scan = 1; scan <= scans; scan++)
+        {
+            value = start + (target - start) * (1 - std::cos(M_PI * scan / scans)) / 2;
+            trace.push_back(value + noiseDistribution(generator));
+        }
+
+        for (uint32_t scan = generator() % 200; scan > 0; scan--)
+            trace.push_back(value + noiseDistribution(generator));
+    }
+
+    return trace;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_fast_movements_actuate_earlier()
+{
+    // Fast movements over large parts of the travel distance are often actuated earlier, both presses and releases, without any false
+    // triggers. The transitions
+    // entering and leaving the rapid trigger zone through the hysteresis, and the ones of slower movements, are not predicted.
+    const uint32_t predicted = KeyHandler.predictedTransitions;
+    const Comparison comparison = compare(replay(getTrace(500, 300, 900, 30, 2)));
+    printf("PREDICT fast transitions=%lu earlier=%lu scans_earlier=%lu false=%lu\n", (unsigned long)comparison.transitions,
+           (unsigned long)comparison.earlier, (unsigned long)comparison.scansEarlier, (unsigned long)comparison.falseTriggers);
+
+    TEST_ASSERT_GREATER_THAN(400, comparison.transitions);
+    TEST_ASSERT_GREATER_THAN(comparison.transitions / 4, comparison.earlier);
+    TEST_ASSERT_GREATER_THAN(comparison.earlier / 4, comparison.earlierPresses);
+    TEST_ASSERT_LESS_THAN(comparison.earlier * 3 / 4, comparison.earlierPresses);
+    TEST_ASSERT_EQUAL(0, comparison.falseTriggers);
+    TEST_ASSERT_EQUAL(comparison.earlier, KeyHandler.predictedTransitions - predicted);
+}
+
+void test_noise_does_not_trigger()
+{
+    // Holding the key still with noise, or moving it too slowly to be predicted, never causes a predicted transition.
+    const uint32_t predicted = KeyHandler.predictedTransitions;
+    const Comparison comparison = compare(replay(getTrace(300, 0, 100, 1, 6)));
+    TEST_ASSERT_EQUAL(0, comparison.falseTriggers);
+    TEST_ASSERT_EQUAL(predicted, KeyHandler.predictedTransitions);
+}
+
+void test_movements_stopping_short()
+{
+    // Fast presses deep inside the rapid trigger zone that stop before the sensitivity has been travelled, and the releases back to where
+    // they started, never trigger the key, as it slows down before stopping. The travel is converted from the distance into sensor values
+    // with the steepest part of the sensor curve the presses cover, which is the one right below the position the key is held at.
+    const std::vector<uint16_t> hold(100, 1450);
+    replay(hold);
+    const uint16_t distance = KeyHandler.heKeyStates.distances[0];
+    replay(std::vector<uint16_t>(100, 1350));
+    const double valuesPerDistance = 100.0 / (distance - KeyHandler.heKeyStates.distances[0]);
+    replay(hold);
+
+    const uint16_t sensitivity = ConfigController.config.heKeys[1].rapidTriggerDownSensitivity;
+    const uint32_t predicted = KeyHandler.predictedTransitions;
+    Comparison comparison = compare(replay(getTrace(3000, sensitivity * 0.8 * valuesPerDistance, sensitivity * 0.99 * valuesPerDistance, 80, 0, 1450, true)));
+    TEST_ASSERT_EQUAL(0, comparison.transitions);
+    TEST_ASSERT_EQUAL(0, comparison.falseTriggers);
+
+    // Presses at a constant speed that brake hard over the last few scans right before the sensitivity are not predicted either, even
+    // though the smoothed velocity lags behind the braking. Each press is released slowly, which is too slow to be predicted.
+    const double travel = sensitivity * 0.95 * valuesPerDistance;
+    for (uint32_t speed = 10; speed <= 60; speed += 5)
+        for (uint32_t scans = 2; scans <= 8; scans++)
+        {
+            // Skip the presses that would travel further than the sensitivity just by braking.
+            const double braking = speed * (scans + 1) / 2.0;
+            if (braking > travel)
+                continue;
+
+            std::vector<uint16_t> trace;
+            double value = 1450;
+            for (uint32_t scan = (travel - braking) / speed; scan > 0; scan--)
+                trace.push_back(value -= speed);
+            for (uint32_t scan = 1; scan <= scans; scan++)
+                trace.push_back(value -= speed * (scans + 1 - scan) / (scans + 1.0));
+            trace.insert(trace.end(), 100, value);
+            while (value < 1450)
+                trace.push_back(value = std::min(value + 1, 1450.0));
+            trace.insert(trace.end(), 100, 1450);
+
+            const Comparison braked = compare(replay(trace));
+            comparison.transitions += braked.transitions;
+            comparison.falseTriggers += braked.falseTriggers;
+        }
+
+    TEST_ASSERT_EQUAL(0, comparison.transitions);
+    TEST_ASSERT_EQUAL(0, comparison.falseTriggers);
+    TEST_ASSERT_EQUAL(predicted, KeyHandler.predictedTransitions);
+}
+
+void test_false_trigger_rate()
+{
+    // Short, fast movements with strong noise, often stopping right around the sensitivity, are the worst case for predictive actuation.
+    // The rate of false triggers stays low, as the key has to have travelled half of the sensitivity already and must not be slowing down.
+    const uint16_t sensitivity = ConfigController.config.heKeys[1].rapidTriggerDownSensitivity;
+    const Comparison comparison = compare(replay(getTrace(5000, sensitivity / 2, sensitivity * 4, 20, 6)));
+    printf("PREDICT short transitions=%lu earlier=%lu scans_earlier=%lu false=%lu\n", (unsigned long)comparison.transitions,
+           (unsigned long)comparison.earlier, (unsigned long)comparison.scansEarlier, (unsigned long)comparison.falseTriggers);
+
+    TEST_ASSERT_GREATER_THAN(1000, comparison.transitions);
+    TEST_ASSERT_GREATER_THAN(0, comparison.earlier);
+    TEST_ASSERT_LESS_THAN(comparison.transitions / 100, comparison.falseTriggers);
+}
+
+int main()
+{
+    // Boot the firmware with rapid trigger enabled on the first two keys, with predictive actuation only on the second one.
+    ConfigController.loadConfig();
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        ConfigController.config.heKeys[i].hidEnabled = true;
+        ConfigController.config.heKeys[i].rapidTrigger = true;
+        Simulator.setAnalogValue(HE_PIN(i), 2040);
+    }
+    ConfigController.config.heKeys[1].predictiveActuation = true;
+
+    KeyHandler.requestConfigSync();
+    ADCSampler.begin();
+    ScanTimer.begin();
+
+    // Calibrate both keys by pressing them down fully once.
+    replay(std::vector<uint16_t>(200, 2040));
+    replay(std::vector<uint16_t>(200, 1150));
+    replay(std::vector<uint16_t>(200, 2040));
+
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_movements_actuate_earlier);
+    RUN_TEST(test_noise_does_not_trigger);
+    RUN_TEST(test_movements_stopping_short);
+    RUN_TEST(test_false_trigger_rate);
+    return UNITY_END();
+}
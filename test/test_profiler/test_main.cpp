@@ -0,0 +1,213 @@
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/profiler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/serial_writer.hpp"
+#include "definitions.hpp"
+
+// Tests the profiler measuring the stages of the key pipeline with the SysTick timer, which the simulator counts down at the clock of
+// the CPU. The scans do not take any simulated time, so the measured cycles are checked with scopes around simulated work instead, while
+// the scans are checked to record every stage once. The "perf" command runs on a thread standing in for the first core, as it waits for
+// the scanning core to take the snapshot of its stages, which the main thread does like the second core by calling Profiler.update().
+#ifndef USE_PROFILER
+#error "The test requires the profiler to be enabled."
+#endif
+static_assert(DIGITAL_KEYS >= 1, "The test requires at least one digital key.");
+
+// The clock of the CPU in cycles per microsecond.
+static constexpr uint32_t cyclesPerMicrosecond = 133;
+
+// The buffer the commands are copied into before being handled, as the serial handler modifies the input in place.
+static char input[SERIAL_INPUT_BUFFER_SIZE];
+
+// Runs the key handler for the specified amount of scans at the configured scan rate.
+static void runScans(uint32_t scans)
+{
+    for (uint32_t i = 0; i < scans; i++)
+    {
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+    }
+}
+
+// Runs the specified function on a thread standing in for the first core, taking the snapshots on this thread like the scanning core.
+static void runOnFirstCore(void (*function)())
+{
+    std::atomic<bool> finished{false};
+    std::thread core([&]
+                     { function(); finished = true; });
+    while (!finished)
+        Profiler.update();
+
+    core.join();
+}
+
+// Handles the "perf" command on the first core, returning the serial output written by it.
+static std::string perf()
+{
+    runOnFirstCore([]
+                   {
+                       strcpy(input, "perf");
+                       SerialHandler.handleSerialInput(input);
+                       SerialWriter.flush(); });
+    return Simulator.readSerialOutput();
+}
+
+// Takes a snapshot of the measurements on the first core.
+static void snapshot()
+{
+    runOnFirstCore([]
+                   { Profiler.snapshot(); });
+}
+
+void setUp()
+{
+    // Start every test with fresh measurements.
+    snapshot();
+}
+
+void tearDown()
+{
+}
+
+void test_scope_measures_cycles()
+{
+    // A scope measures the CPU cycles passed from its construction to its destruction, also if the 24-bit counter wraps around in between.
+    for (uint32_t microseconds : {0, 1, 10, 1000, 100000})
+    {
+        ProfilerScope scope(ProfilerStage::Report);
+        Simulator.advance(microseconds);
+    }
+
+    // Move the counter right before its reload, so the next measurement wraps around.
+    Simulator.advance((Profiler::now() - 100) / cyclesPerMicrosecond);
+    {
+        ProfilerScope scope(ProfilerStage::Report);
+        Simulator.advance(50);
+    }
+
+    snapshot();
+    const LogHistogram &histogram = Profiler.stageSnapshots[(uint8_t)ProfilerStage::Report];
+    TEST_ASSERT_EQUAL_UINT32(6, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.min);
+    TEST_ASSERT_EQUAL_UINT32(100000 * cyclesPerMicrosecond, histogram.max);
+    TEST_ASSERT_TRUE(histogram.sum == (uint64_t)(1 + 10 + 1000 + 100000 + 50) * cyclesPerMicrosecond);
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.buckets[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.buckets[8]);
+}
+
+void test_scans_record_every_stage()
+{
+    // Every scan records every stage of the key pipeline once, and every stage processing the keys one by one once for every key.
+    // The report stage is only recorded for the reports that have actually been sent.
+    const uint32_t reports = KeyHandler.reportScheduler.reportsSent;
+    runScans(100);
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        Simulator.setDigitalLevel(DIGITAL_PIN(0), i % 2);
+        runScans(100);
+    }
+
+    snapshot();
+    for (uint8_t stage = 0; stage < (uint8_t)ProfilerStage::Report; stage++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(600, Profiler.stageSnapshots[stage].count);
+        if (stage < Profiler.perKeyStages)
+            for (uint8_t key = 0; key < HE_KEYS; key++)
+                TEST_ASSERT_EQUAL_UINT32(600, Profiler.keySnapshots[stage][key].count);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(5, KeyHandler.reportScheduler.reportsSent - reports);
+    TEST_ASSERT_EQUAL_UINT32(5, Profiler.stageSnapshots[(uint8_t)ProfilerStage::Report].count);
+}
+
+void test_snapshot_resets_measurements()
+{
+    // A snapshot only covers the measurements since the previous one, so the next snapshot is empty if nothing has been measured since.
+    runScans(10);
+    snapshot();
+    TEST_ASSERT_EQUAL_UINT32(10, Profiler.stageSnapshots[(uint8_t)ProfilerStage::Filter].count);
+    TEST_ASSERT_EQUAL_UINT32(10, Profiler.keySnapshots[(uint8_t)ProfilerStage::Check][HE_KEYS - 1].count);
+
+    snapshot();
+    for (uint8_t stage = 0; stage < (uint8_t)ProfilerStage::Count; stage++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, Profiler.stageSnapshots[stage].count);
+        TEST_ASSERT_EQUAL_UINT32(0, Profiler.stageSnapshots[stage].max);
+    }
+}
+
+void test_snapshot_waits_for_scanning_core()
+{
+    // The snapshot of the stages measured on the scanning core is only taken once that core gets to it, with the first core waiting until then.
+    runScans(10);
+    std::atomic<bool> finished{false};
+    std::thread core([&]
+                     { Profiler.snapshot(); finished = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TEST_ASSERT_FALSE(finished);
+
+    // The measurements recorded on the scanning core while the snapshot is pending are part of it.
+    {
+        ProfilerScope scope(ProfilerStage::Filter);
+    }
+
+    while (!finished)
+        Profiler.update();
+
+    core.join();
+    TEST_ASSERT_EQUAL_UINT32(11, Profiler.stageSnapshots[(uint8_t)ProfilerStage::Filter].count);
+}
+
+void test_perf_output()
+{
+    // The "perf" command outputs one line for every stage and one for every key in the stages processing the keys one by one, with the
+    // counts of the buckets of the histogram up to the last one that is not empty.
+    for (uint32_t microseconds : {0, 0, 1, 2})
+    {
+        ProfilerScope scope(ProfilerStage::Report);
+        Simulator.advance(microseconds);
+    }
+
+    runScans(3);
+    const std::string output = perf();
+    TEST_ASSERT_TRUE(output.find("PERF filter count=3 min=0 max=0 mean=0 hist=3\n") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("PERF check.hkey1 count=3 ") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("PERF report count=4 min=0 max=266 mean=99 hist=2,0,0,0,0,0,0,0,1,1\n") != std::string::npos);
+
+    size_t lines = 0;
+    for (size_t position = output.find("PERF "); position != std::string::npos; position = output.find("PERF ", position + 1))
+        lines++;
+
+    TEST_ASSERT_EQUAL(size_t((uint8_t)ProfilerStage::Count + Profiler.perKeyStages * HE_KEYS), lines);
+}
+
+int main()
+{
+    // Boot the firmware with the first digital key enabled, and start the cycle counter for the profiler like the scanning core does.
+    ConfigController.loadConfig();
+    ConfigController.config.digitalKeys[0].hidEnabled = true;
+    KeyHandler.requestConfigSync();
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+    Profiler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_scope_measures_cycles);
+    RUN_TEST(test_scans_record_every_stage);
+    RUN_TEST(test_snapshot_resets_measurements);
+    RUN_TEST(test_snapshot_waits_for_scanning_core);
+    RUN_TEST(test_perf_output);
+    return UNITY_END();
+}
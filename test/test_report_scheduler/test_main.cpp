@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/hid_usage.hpp"
+#include "helpers/scan_timer.hpp"
+#include "definitions.hpp"
+
+// Tests the scheduling of the HID reports against the USB start-of-frame (SOF) of the simulator, which starts a frame every millisecond.
+// The firmware runs like the main loop, reporting continuously in between the scans, so the time of every report is exact.
+static_assert(DIGITAL_KEYS >= 1, "The test requires at least one digital key.");
+
+// The duration of a USB frame in microseconds.
+static constexpr uint32_t framePeriod = 1000;
+
+// Runs the firmware until the specified simulated time, like the main loop of the first core does.
+static void runUntil(uint64_t time)
+{
+    while (Simulator.getTime() < time)
+    {
+        Simulator.advance(1);
+        KeyHandler.handle();
+    }
+}
+
+// Runs the firmware until the specified time in the next frame, returning the time the frame started at.
+static uint64_t runUntilNextFrame(uint32_t offset)
+{
+    const uint64_t frameStart = (Simulator.getTime() / framePeriod + 1) * framePeriod;
+    runUntil(frameStart + offset);
+    return frameStart;
+}
+
+// Sets the level of the first digital key, pressing it if low.
+static void setDigitalKey(bool pressed)
+{
+    Simulator.setDigitalLevel(DIGITAL_PIN(0), !pressed);
+}
+
+// Returns whether the specified report contains the HID usage of the specified key char.
+static bool containsKey(const Simulator::KeyboardReport &report, char keyChar)
+{
+    return report.contains(HIDUsage::fromKeyChar(keyChar).usage);
+}
+
+void setUp()
+{
+    Simulator.keyboardReports.clear();
+}
+
+void tearDown()
+{
+    // Release all keys and wait until the releases have been reported.
+    setDigitalKey(false);
+    Simulator.setAnalogValue(HE_PIN(0), 2040);
+    Simulator.hidReady = true;
+    runUntil(Simulator.getTime() + DIGITAL_DEBOUNCE_TIME + 20 * framePeriod);
+    TEST_ASSERT_TRUE(KeyHandler.isIdle());
+    TEST_ASSERT_FALSE(KeyHandler.reportScheduler.isPending());
+}
+
+void test_no_reports_without_changes()
+{
+    // Without any changes of the key state, no reports are sent and every frame counts as skipped.
+    const uint32_t skipped = KeyHandler.reportScheduler.reportsSkipped;
+    runUntil(Simulator.getTime() + 100 * framePeriod);
+    TEST_ASSERT_EQUAL(0, Simulator.keyboardReports.size());
+    TEST_ASSERT_UINT32_WITHIN(1, 100, KeyHandler.reportScheduler.reportsSkipped - skipped);
+}
+
+void test_report_sent_before_next_sof()
+{
+    // A change early in the frame is held back until the lead time before the next SOF.
+    const uint64_t frameStart = runUntilNextFrame(300);
+    setDigitalKey(true);
+    runUntil(frameStart + 3 * framePeriod);
+
+    TEST_ASSERT_EQUAL(1, Simulator.keyboardReports.size());
+    TEST_ASSERT_EQUAL_UINT32(frameStart + framePeriod - HID_REPORT_SOF_LEAD, Simulator.keyboardReports[0].time);
+    TEST_ASSERT_TRUE(containsKey(Simulator.keyboardReports[0], ConfigController.config.digitalKeys[0].keyChar));
+}
+
+void test_late_change_sent_in_next_frame()
+{
+    // A change scanned after the lead time before the next SOF is sent right before the SOF following it. This includes changes
+    // only scanned once the next frame has started, which have not missed their frame.
+    const uint64_t frameStart = runUntilNextFrame(framePeriod - HID_REPORT_SOF_LEAD + 1);
+    setDigitalKey(true);
+    runUntil(frameStart + 3 * framePeriod);
+
+    TEST_ASSERT_EQUAL(1, Simulator.keyboardReports.size());
+    TEST_ASSERT_EQUAL_UINT32(frameStart + 2 * framePeriod - HID_REPORT_SOF_LEAD, Simulator.keyboardReports[0].time);
+}
+
+void test_changes_within_frame_coalesced()
+{
+    // Press the Hall Effect key, and the digital key right after its press has been scanned, early enough in the frame
+    // for the press of the digital key to be scanned before the lead time.
+    runUntilNextFrame(0);
+    Simulator.setAnalogValue(HE_PIN(0), 1150);
+    while (!KeyHandler.heKeys[0].pressed)
+        runUntil(Simulator.getTime() + 1);
+    TEST_ASSERT_LESS_THAN(framePeriod - HID_REPORT_SOF_LEAD - 1000000 / ConfigController.config.scanRate, Simulator.getTime() % framePeriod);
+
+    const uint32_t coalesced = KeyHandler.reportScheduler.reportsCoalesced;
+    const uint64_t frameStart = Simulator.getTime() / framePeriod * framePeriod;
+    setDigitalKey(true);
+    runUntil(frameStart + 3 * framePeriod);
+
+    // Both presses are sent in a single report.
+    TEST_ASSERT_EQUAL(1, Simulator.keyboardReports.size());
+    TEST_ASSERT_EQUAL_UINT32(frameStart + framePeriod - HID_REPORT_SOF_LEAD, Simulator.keyboardReports[0].time);
+    TEST_ASSERT_TRUE(containsKey(Simulator.keyboardReports[0], ConfigController.config.heKeys[0].keyChar));
+    TEST_ASSERT_TRUE(containsKey(Simulator.keyboardReports[0], ConfigController.config.digitalKeys[0].keyChar));
+    TEST_ASSERT_EQUAL_UINT32(coalesced + 1, KeyHandler.reportScheduler.reportsCoalesced);
+}
+
+void test_busy_interface_delays_report()
+{
+    // While the HID interface is busy, the report stays pending across the frames instead of being dropped.
+    Simulator.hidReady = false;
+    const uint64_t frameStart = runUntilNextFrame(300);
+    setDigitalKey(true);
+    runUntil(frameStart + 3 * framePeriod + 300);
+    TEST_ASSERT_EQUAL(0, Simulator.keyboardReports.size());
+    TEST_ASSERT_TRUE(KeyHandler.reportScheduler.isPending());
+
+    // Once the interface is ready again, the report has missed its frame and is sent right away.
+    Simulator.hidReady = true;
+    runUntil(Simulator.getTime() + 1);
+    TEST_ASSERT_EQUAL(1, Simulator.keyboardReports.size());
+    TEST_ASSERT_EQUAL_UINT32(frameStart + 3 * framePeriod + 301, Simulator.keyboardReports[0].time);
+    TEST_ASSERT_TRUE(containsKey(Simulator.keyboardReports[0], ConfigController.config.digitalKeys[0].keyChar));
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of the first Hall Effect key and the digital key enabled.
+    ConfigController.loadConfig();
+    ConfigController.config.heKeys[0].hidEnabled = true;
+    ConfigController.config.digitalKeys[0].hidEnabled = true;
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        Simulator.setAnalogValue(HE_PIN(i), 2040);
+
+    KeyHandler.begin();
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+
+    // Calibrate the Hall Effect key by pressing it once, then wait for all reports to be sent.
+    runUntil(50 * framePeriod);
+    Simulator.setAnalogValue(HE_PIN(0), 1150);
+    runUntil(100 * framePeriod);
+    Simulator.setAnalogValue(HE_PIN(0), 2040);
+    runUntil(150 * framePeriod);
+    TEST_ASSERT_TRUE(KeyHandler.heKeys[0].calibrated);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_no_reports_without_changes);
+    RUN_TEST(test_report_sent_before_next_sof);
+    RUN_TEST(test_late_change_sent_in_next_frame);
+    RUN_TEST(test_changes_within_frame_coalesced);
+    RUN_TEST(test_busy_interface_delays_report);
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/scan_scheduler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/serial_writer.hpp"
+#include "definitions.hpp"
+
+// Tests the scheduling of the key scans, both the decisions of the scheduler with the times passed in directly and the scan timer
+// starting the scans from the hardware alarm of the simulator. The scans have to keep a fixed rate without drifting, skip the scans
+// that have been missed instead of catching up on them, and record the statistics of how well the rate is kept.
+
+// The generator for the delays of the scans, seeded with a constant so every run uses the same delays.
+static std::mt19937 generator(42);
+
+// The buffer the commands are copied into before being handled, as the serial handler modifies the input in place.
+static char input[SERIAL_INPUT_BUFFER_SIZE];
+
+// Handles the specified command like the serial reader passes it on, discarding the serial output written by it.
+static void handle(const std::string &command)
+{
+    strcpy(input, command.c_str());
+    SerialHandler.handleSerialInput(input);
+    SerialWriter.flush();
+    Simulator.readSerialOutput();
+}
+
+// Waits for the next scan like the scanning core does, simulating a scan of the specified duration, and returns the time it started at.
+static uint64_t runScan(uint32_t duration)
+{
+    ScanTimer.wait();
+    const uint64_t start = Simulator.getTime();
+    Simulator.advance(duration);
+    ScanTimer.finish();
+    return start;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+    // Go back to the default rate, with the scans being started again right away.
+    ConfigController.config.scanRate = SCAN_RATE;
+    runScan(0);
+    ScanTimer.scheduler.resetStats();
+}
+
+void test_supported_rates()
+{
+    // Only rates within the boundaries that divide a second into whole microseconds are supported.
+    for (uint16_t rate : {1000, 2000, 4000, 5000, 8000, 10000, 12500, 15625})
+        TEST_ASSERT_TRUE(ScanScheduler::isSupportedRate(rate));
+    for (uint16_t rate : {0, 500, 999, 3000, 6000, 7000, 9000, 15000, 16000, 20000})
+        TEST_ASSERT_FALSE(ScanScheduler::isSupportedRate(rate));
+}
+
+void test_rate_command()
+{
+    // The "rate" command only accepts the supported rates, leaving the configuration unchanged otherwise.
+    handle("rate 4000");
+    TEST_ASSERT_EQUAL(4000, ConfigController.config.scanRate);
+    for (const char *rate : {"3000", "999", "20000", "65536", "-8000", "abc", ""})
+    {
+        handle(std::string("rate ") + rate);
+        TEST_ASSERT_EQUAL(4000, ConfigController.config.scanRate);
+    }
+
+    handle("rate 1000");
+    TEST_ASSERT_EQUAL(1000, ConfigController.config.scanRate);
+}
+
+void test_scheduler_does_not_drift()
+{
+    // Scans starting late by less than a period keep being due at exact multiples of the period after the first one, even across the
+    // overflow of the 32-bit microsecond counter, as the due times are advanced from the previous due time instead of the start time.
+    ScanScheduler scheduler;
+    const uint32_t start = UINT32_MAX - 5000000;
+    scheduler.setRate(8000, start);
+    std::uniform_int_distribution<uint32_t> delay(0, 124);
+    uint32_t maxDelay = 0;
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(start + i * 125, scheduler.getNextDue());
+        TEST_ASSERT_FALSE(scheduler.isDue(scheduler.getNextDue() - 1));
+        TEST_ASSERT_TRUE(scheduler.isDue(scheduler.getNextDue()));
+
+        const uint32_t late = delay(generator);
+        maxDelay = std::max(maxDelay, late);
+        const uint32_t now = scheduler.getNextDue() + late;
+        TEST_ASSERT_TRUE(scheduler.isDue(now));
+        scheduler.onScanStart(now);
+        scheduler.onScanEnd(now + late / 2);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(start + 100000 * 125, scheduler.getNextDue());
+    TEST_ASSERT_EQUAL_UINT32(100000, scheduler.scans);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(maxDelay / 2, scheduler.maxDuration);
+    TEST_ASSERT_LESS_OR_EQUAL(maxDelay, scheduler.maxJitter);
+    TEST_ASSERT_GREATER_THAN(100, scheduler.maxJitter);
+}
+
+void test_scheduler_skips_missed_scans()
+{
+    // A scan starting a whole period late or later counts as an overrun, with the next scan being due a period after it started instead
+    // of right away, so the missed scans are skipped. The jitter is the deviation of the time between the scans from the period.
+    ScanScheduler scheduler;
+    scheduler.setRate(1000, 0);
+    scheduler.onScanStart(0);
+    TEST_ASSERT_EQUAL_UINT32(1000, scheduler.getNextDue());
+
+    scheduler.onScanStart(3500);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(4500, scheduler.getNextDue());
+    TEST_ASSERT_EQUAL_UINT32(2500, scheduler.maxJitter);
+
+    // Starting late by exactly a period is an overrun as well, while starting late by one microsecond less is not.
+    scheduler.onScanStart(5500);
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(6500, scheduler.getNextDue());
+    scheduler.onScanStart(7499);
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(7500, scheduler.getNextDue());
+    TEST_ASSERT_EQUAL_UINT32(4, scheduler.scans);
+
+    // Setting the rate again restarts the schedule right away, without measuring the jitter to the previous scan.
+    scheduler.resetStats();
+    scheduler.setRate(2000, 20000);
+    TEST_ASSERT_TRUE(scheduler.isDue(20000));
+    scheduler.onScanStart(20000);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.maxJitter);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(20500, scheduler.getNextDue());
+}
+
+void test_timer_keeps_rate()
+{
+    // The scans started by the alarm start exactly a period apart, no matter how long the scans themselves take.
+    const uint32_t period = 1000000 / ConfigController.config.scanRate;
+    std::uniform_int_distribution<uint32_t> duration(0, period - 1);
+    uint64_t previous = runScan(0);
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        const uint64_t start = runScan(duration(generator));
+        TEST_ASSERT_EQUAL_UINT32(period, start - previous);
+        previous = start;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(10001, ScanTimer.scheduler.scans);
+    TEST_ASSERT_EQUAL_UINT32(0, ScanTimer.scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, ScanTimer.scheduler.maxJitter);
+    TEST_ASSERT_LESS_THAN(period, ScanTimer.scheduler.maxDuration);
+}
+
+void test_timer_skips_overruns()
+{
+    // A scan taking longer than a period starts the next scan right after it, with the one after that a period later again.
+    const uint32_t period = 1000000 / ConfigController.config.scanRate;
+    const uint64_t start = runScan(period * 5 / 2);
+    const uint64_t late = runScan(0);
+    const uint64_t next = runScan(0);
+    TEST_ASSERT_EQUAL_UINT32(period * 5 / 2, late - start);
+    TEST_ASSERT_EQUAL_UINT32(period, next - late);
+    TEST_ASSERT_EQUAL_UINT32(1, ScanTimer.scheduler.overruns);
+    TEST_ASSERT_EQUAL_UINT32(period * 5 / 2, ScanTimer.scheduler.maxDuration);
+    TEST_ASSERT_EQUAL_UINT32(period * 3 / 2, ScanTimer.scheduler.maxJitter);
+
+    // A scan finishing just before the next one is due does not cause an overrun.
+    const uint64_t busy = runScan(period - 1);
+    const uint64_t following = runScan(0);
+    TEST_ASSERT_EQUAL_UINT32(period, following - busy);
+    TEST_ASSERT_EQUAL_UINT32(1, ScanTimer.scheduler.overruns);
+}
+
+void test_timer_applies_rate_change()
+{
+    // A rate set with the "rate" command is applied with the next scan, which starts the new schedule right away.
+    const uint64_t start = runScan(0);
+    handle("rate 2000");
+    uint64_t previous = runScan(0);
+    TEST_ASSERT_EQUAL_UINT32(1000000 / SCAN_RATE, previous - start);
+    TEST_ASSERT_EQUAL(2000, ScanTimer.scheduler.getRate());
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        const uint64_t next = runScan(100);
+        TEST_ASSERT_EQUAL_UINT32(500, next - previous);
+        previous = next;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, ScanTimer.scheduler.overruns);
+}
+
+int main()
+{
+    // Boot the firmware with only the scan timer running, as the scans are simulated.
+    ConfigController.loadConfig();
+    ScanTimer.begin();
+    ScanTimer.scheduler.resetStats();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_supported_rates);
+    RUN_TEST(test_rate_command);
+    RUN_TEST(test_scheduler_does_not_drift);
+    RUN_TEST(test_scheduler_skips_missed_scans);
+    RUN_TEST(test_timer_keeps_rate);
+    RUN_TEST(test_timer_skips_overruns);
+    RUN_TEST(test_timer_applies_rate_change);
+    return UNITY_END();
+}
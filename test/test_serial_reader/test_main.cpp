@@ -0,0 +1,229 @@
+#include <unity.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "helpers/serial_reader.hpp"
+#include "config_protocol.hpp"
+#include "definitions.hpp"
+
+// Tests the incremental serial reader with fragmented and adversarial input, checking that only complete lines and valid frames
+// are passed on and that the amount of work done per call of the serial event stays bounded.
+
+// The reader assembling the serial input, like the one of the main loop.
+static SerialReader serialReader;
+
+// The lines and frame payloads completed by the serial reader.
+static std::vector<std::string> lines;
+static std::vector<std::vector<uint8_t>> frames;
+
+// Feeds the specified bytes into the serial reader, collecting the completed lines and frames.
+static void feed(const std::string &bytes)
+{
+    for (char byte : bytes)
+    {
+        const SerialReader::Input input = serialReader.feed(byte);
+        if (input == SerialReader::Input::Line)
+            lines.push_back(serialReader.getLine());
+        else if (input == SerialReader::Input::Frame)
+            frames.emplace_back(serialReader.getPayload(), serialReader.getPayload() + serialReader.getPayloadLength());
+    }
+}
+
+// Returns the encoded binary frame of the specified payload as a string of bytes.
+static std::string encodeFrame(const std::vector<uint8_t> &payload)
+{
+    const std::vector<uint8_t> frame = ConfigProtocol::encodeFrame(payload);
+    return std::string(frame.begin(), frame.end());
+}
+
+// Reads the available serial input like the serial event of the main loop does, returning the amount of bytes read and inputs completed.
+static std::pair<int, int> serialEvent()
+{
+    int read = 0;
+    int inputs = 0;
+    int available = min(Serial.available(), SERIAL_INPUT_MAX_BYTES_PER_LOOP);
+    while (available-- > 0)
+    {
+        read++;
+        const SerialReader::Input input = serialReader.feed(Serial.read());
+        if (input == SerialReader::Input::None)
+            continue;
+
+        if (input == SerialReader::Input::Line)
+            lines.push_back(serialReader.getLine());
+        inputs++;
+        break;
+    }
+
+    return {read, inputs};
+}
+
+void setUp()
+{
+    // Start every test with a fresh reader, as a discarded line from a previous test would otherwise swallow the first line.
+    serialReader = SerialReader();
+    lines.clear();
+    frames.clear();
+}
+
+void tearDown()
+{
+}
+
+void test_fragmented_lines()
+{
+    // Lines split into random fragments, with both \n and \r\n endings, are assembled exactly as sent.
+    std::mt19937 generator(42);
+    std::vector<std::string> expected;
+    std::string stream;
+    for (uint16_t i = 0; i < 200; i++)
+    {
+        const std::string line = "hkey" + std::to_string(i % 3 + 1) + ".rp " + std::to_string(generator() % 400);
+        expected.push_back(line);
+        stream += line + (i % 2 ? "\r\n" : "\n");
+    }
+
+    for (size_t i = 0; i < stream.size();)
+    {
+        const size_t length = std::min<size_t>(generator() % 8, stream.size() - i);
+        feed(stream.substr(i, length));
+        i += length;
+
+        // Every line is passed on as soon as its newline has been read, but not before.
+        TEST_ASSERT_EQUAL((size_t)std::count(stream.begin(), stream.begin() + i, '\n'), lines.size());
+    }
+
+    TEST_ASSERT_EQUAL(expected.size(), lines.size());
+    for (size_t i = 0; i < expected.size(); i++)
+        TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), lines[i].c_str());
+}
+
+void test_partial_line_is_kept()
+{
+    // A line without its newline is not passed on, but completed once the rest arrives.
+    feed("hkey1.rp 2");
+    TEST_ASSERT_EQUAL(0, lines.size());
+    feed("00");
+    TEST_ASSERT_EQUAL(0, lines.size());
+    feed("\n");
+    TEST_ASSERT_EQUAL(1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("hkey1.rp 200", lines[0].c_str());
+}
+
+void test_overlong_lines_are_discarded()
+{
+    // A line filling the buffer exactly is passed on, while longer lines are discarded as a whole instead of truncated, with the next
+    // line being read normally again.
+    const std::string longest(SERIAL_INPUT_BUFFER_SIZE - 1, 'a');
+    feed(longest + "\n");
+    feed(longest + "b\n");
+    feed(std::string(100000, 'c') + "\n");
+    feed("echo ok\n");
+    TEST_ASSERT_EQUAL(2, lines.size());
+    TEST_ASSERT_EQUAL_STRING(longest.c_str(), lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("echo ok", lines[1].c_str());
+}
+
+void test_binary_frames()
+{
+    // Valid frames are passed on, also when fragmented between lines, while frames with an invalid checksum or a payload exceeding the
+    // buffer are discarded without affecting the following input.
+    const std::vector<uint8_t> payload = {0x11, '\n', 0x00, BINARY_FRAME_MAGIC, '\r'};
+    std::string corrupted = encodeFrame(payload);
+    corrupted[4] ^= 0x01;
+    const std::vector<uint8_t> oversized(SERIAL_INPUT_BUFFER_SIZE + 1, 0x12);
+
+    feed("echo 1\n" + encodeFrame(payload) + corrupted + "echo 2\n" + encodeFrame(oversized) + "echo 3\n");
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_TRUE(frames[0] == payload);
+    TEST_ASSERT_EQUAL(3, lines.size());
+    TEST_ASSERT_EQUAL_STRING("echo 1", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("echo 2", lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("echo 3", lines[2].c_str());
+
+    // The magic byte is only considered at the start of a line.
+    feed(std::string("echo ") + (char)BINARY_FRAME_MAGIC + "\n");
+    TEST_ASSERT_EQUAL(4, lines.size());
+    TEST_ASSERT_TRUE(lines[3] == std::string("echo ") + (char)BINARY_FRAME_MAGIC);
+}
+
+void test_truncated_frame_times_out()
+{
+    // A truncated frame is discarded once no byte has been received for the timeout, instead of swallowing the following input.
+    const std::string frame = encodeFrame({0x11, 0x22, 0x33});
+    feed(frame.substr(0, frame.size() - 1));
+    Simulator.advance((BINARY_FRAME_TIMEOUT - 1) * 1000);
+    feed(frame.substr(frame.size() - 1));
+    TEST_ASSERT_EQUAL(1, frames.size());
+
+    feed(frame.substr(0, frame.size() - 1));
+    Simulator.advance(BINARY_FRAME_TIMEOUT * 1000);
+    feed("echo ok\n");
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("echo ok", lines[0].c_str());
+}
+
+void test_random_bytes()
+{
+    // Random bytes never cause more input to be passed on than was sent, and valid input sent afterwards is read normally.
+    std::mt19937 generator(42);
+    std::string noise;
+    for (uint32_t i = 0; i < 200000; i++)
+        noise += (char)(generator() % 4 ? generator() : (generator() % 2 ? '\n' : BINARY_FRAME_MAGIC));
+
+    feed(noise);
+    for (const std::vector<uint8_t> &frame : frames)
+        TEST_ASSERT_LESS_OR_EQUAL(SERIAL_INPUT_BUFFER_SIZE, frame.size());
+    for (const std::string &line : lines)
+        TEST_ASSERT_LESS_THAN(SERIAL_INPUT_BUFFER_SIZE, line.size());
+
+    lines.clear();
+    Simulator.advance(BINARY_FRAME_TIMEOUT * 1000);
+    feed("\necho ok\n");
+    TEST_ASSERT_EQUAL_STRING("echo ok", lines.back().c_str());
+}
+
+void test_serial_event_is_bounded()
+{
+    // Every call of the serial event reads at most the maximum amount of bytes and handles at most one input, independent of how much
+    // input is waiting, without ever waiting for the rest of a partial line.
+    std::string input;
+    for (uint16_t i = 0; i < 100; i++)
+        input += "echo " + std::to_string(i) + "\n";
+    input += std::string(5000, 'x') + "\necho partial";
+    Simulator.writeSerialInput(input);
+
+    uint32_t calls = 0;
+    while (Serial.available() > 0)
+    {
+        const std::pair<int, int> result = serialEvent();
+        TEST_ASSERT_LESS_OR_EQUAL(SERIAL_INPUT_MAX_BYTES_PER_LOOP, result.first);
+        TEST_ASSERT_LESS_OR_EQUAL(1, result.second);
+        TEST_ASSERT_GREATER_THAN(0, result.first);
+        calls++;
+    }
+
+    TEST_ASSERT_EQUAL(100, lines.size());
+    TEST_ASSERT_EQUAL_STRING("echo 99", lines.back().c_str());
+    TEST_ASSERT_GREATER_OR_EQUAL(100 + 5000 / SERIAL_INPUT_MAX_BYTES_PER_LOOP, calls);
+
+    // With no input available, the serial event returns right away.
+    const std::pair<int, int> result = serialEvent();
+    TEST_ASSERT_EQUAL(0, result.first);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fragmented_lines);
+    RUN_TEST(test_partial_line_is_kept);
+    RUN_TEST(test_overlong_lines_are_discarded);
+    RUN_TEST(test_binary_frames);
+    RUN_TEST(test_truncated_frame_times_out);
+    RUN_TEST(test_random_bytes);
+    RUN_TEST(test_serial_event_is_bounded);
+    return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/serial_writer.hpp"
+#include "frame_parser.hpp"
+#include "definitions.hpp"
+
+// Tests the serial output buffer with a host device reading slowly or not at all, checking that writing never blocks, that messages
+// are either passed on completely or dropped as a whole and that the statistics match.
+
+// Flushes the serial writer until it is empty, returning the written serial output. Checks that no flush passes more bytes to the serial
+// interface than it can take without blocking.
+static std::string drain()
+{
+    std::string output;
+    for (uint32_t i = 0; i < 100000 && SerialWriter.getFreeSpace() < SERIAL_OUTPUT_BUFFER_SIZE; i++)
+    {
+        SerialWriter.flush();
+        const std::string written = Simulator.readSerialOutput();
+        TEST_ASSERT_LESS_OR_EQUAL((size_t)Simulator.serialWriteCapacity, written.size());
+        output += written;
+    }
+
+    TEST_ASSERT_EQUAL(SERIAL_OUTPUT_BUFFER_SIZE, SerialWriter.getFreeSpace());
+    return output;
+}
+
+void setUp()
+{
+    // Start every test with an empty buffer and a host device reading quickly.
+    Simulator.serialWriteCapacity = 4096;
+    drain();
+}
+
+void tearDown()
+{
+}
+
+void test_slow_host_receives_everything()
+{
+    // With a host device reading only a few bytes per flush, the output of the get command arrives unchanged, spread over many flushes.
+    SerialHandler.handleSerialInput((char *)std::string("get").c_str());
+    const std::string expected = drain();
+    TEST_ASSERT_GREATER_THAN(HE_KEYS * 10, std::count(expected.begin(), expected.end(), '\n'));
+
+    Simulator.serialWriteCapacity = 7;
+    SerialHandler.handleSerialInput((char *)std::string("get").c_str());
+    TEST_ASSERT_EQUAL(0, Simulator.readSerialOutput().size());
+    TEST_ASSERT_TRUE(drain() == expected);
+}
+
+void test_stalled_host_drops_whole_messages()
+{
+    // With a host device not reading at all, messages are queued until the buffer is full, after which they are dropped as a whole.
+    // Once the host device reads again, exactly the queued messages arrive, in order and without any partial messages.
+    Simulator.serialWriteCapacity = 0;
+    const uint32_t bytesQueued = SerialWriter.bytesQueued;
+    const uint32_t bytesDropped = SerialWriter.bytesDropped;
+    std::string expected;
+    uint32_t dropped = 0;
+    for (uint16_t i = 0; i < 2000; i++)
+    {
+        const std::string message = "message " + std::to_string(i) + std::string(i % 37, '.');
+        const bool queued = i % 2 ? SerialWriter.println(message.c_str()) : SerialWriter.printf("%s\n", message.c_str());
+        TEST_ASSERT_EQUAL(queued, expected.size() + message.size() + 1 <= SERIAL_OUTPUT_BUFFER_SIZE);
+        if (queued)
+            expected += message + "\n";
+        else
+            dropped += message.size() + 1;
+        SerialWriter.flush();
+    }
+
+    TEST_ASSERT_GREATER_THAN(0, dropped);
+    TEST_ASSERT_EQUAL(expected.size(), SerialWriter.bytesQueued - bytesQueued);
+    TEST_ASSERT_EQUAL(dropped, SerialWriter.bytesDropped - bytesDropped);
+    TEST_ASSERT_GREATER_OR_EQUAL(expected.size(), SerialWriter.maxDepth);
+    TEST_ASSERT_LESS_OR_EQUAL(SERIAL_OUTPUT_BUFFER_SIZE, SerialWriter.maxDepth);
+
+    Simulator.serialWriteCapacity = 64;
+    TEST_ASSERT_TRUE(drain() == expected);
+}
+
+void test_oversized_message_dropped()
+{
+    // A formatted message not fitting into the temporary buffer is dropped as a whole instead of being cut off, while the longest
+    // message that fits, including its newline character, is still queued.
+    const uint32_t bytesQueued = SerialWriter.bytesQueued;
+    const uint32_t bytesDropped = SerialWriter.bytesDropped;
+    const std::string longest(SERIAL_OUTPUT_MAX_MESSAGE_SIZE - 2, 'x');
+    for (const std::string &message : {longest + "y", longest + std::string(300, 'y')})
+        TEST_ASSERT_FALSE(SerialWriter.printf("%s\n", message.c_str()));
+
+    TEST_ASSERT_EQUAL(0, SerialWriter.bytesQueued - bytesQueued);
+    TEST_ASSERT_EQUAL(SERIAL_OUTPUT_MAX_MESSAGE_SIZE + SERIAL_OUTPUT_MAX_MESSAGE_SIZE + 299, SerialWriter.bytesDropped - bytesDropped);
+
+    TEST_ASSERT_TRUE(SerialWriter.printf("%s\n", longest.c_str()));
+    TEST_ASSERT_TRUE(drain() == longest + "\n");
+}
+
+void test_random_writes_wrap_around()
+{
+    // Writes of random sizes, with the host device reading a random amount of bytes per flush, wrap around the end of the buffer many
+    // times. The output is exactly the accepted writes, in order.
+    std::mt19937 generator(42);
+    std::string expected;
+    std::string output;
+    uint32_t rejected = 0;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        std::string data(generator() % 600, '\0');
+        for (char &byte : data)
+            byte = (char)generator();
+
+        if (SerialWriter.write((const uint8_t *)data.data(), data.size()))
+            expected += data;
+        else
+            rejected++;
+
+        Simulator.serialWriteCapacity = generator() % 512;
+        SerialWriter.flush();
+        output += Simulator.readSerialOutput();
+    }
+
+    TEST_ASSERT_GREATER_THAN(0, rejected);
+    output += drain();
+    TEST_ASSERT_TRUE(output == expected);
+}
+
+void test_frames_arrive_complete()
+{
+    // Binary frames written while the host device reads slowly arrive with a valid checksum, with the frames not fitting being dropped
+    // as a whole instead of corrupting the stream.
+    std::mt19937 generator(42);
+    std::vector<std::vector<uint8_t>> expected;
+    FrameParser parser;
+    Simulator.serialWriteCapacity = 16;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        std::vector<uint8_t> payload(generator() % 200);
+        for (uint8_t &byte : payload)
+            byte = (uint8_t)generator();
+
+        if (SerialWriter.writeFrame(payload.data(), payload.size()))
+            expected.push_back(payload);
+
+        SerialWriter.flush();
+        const std::string output = Simulator.readSerialOutput();
+        parser.feed((const uint8_t *)output.data(), output.size());
+    }
+
+    const std::string output = drain();
+    parser.feed((const uint8_t *)output.data(), output.size());
+    TEST_ASSERT_LESS_THAN(5000, expected.size());
+    TEST_ASSERT_EQUAL(0, parser.invalidFrames);
+    TEST_ASSERT_TRUE(parser.payloads == expected);
+}
+
+int main()
+{
+    ConfigController.loadConfig();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_slow_host_receives_everything);
+    RUN_TEST(test_stalled_host_drops_whole_messages);
+    RUN_TEST(test_oversized_message_dropped);
+    RUN_TEST(test_random_writes_wrap_around);
+    RUN_TEST(test_frames_arrive_complete);
+    return UNITY_END();
+}
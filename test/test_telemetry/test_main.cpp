@@ -0,0 +1,171 @@
+#include <unity.h>
+#include <map>
+#include <string>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "handlers/telemetry_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/serial_writer.hpp"
+#include "frame_parser.hpp"
+#include "telemetry_decoder.hpp"
+#include "definitions.hpp"
+
+// Tests the telemetry streamed by the firmware, decoding the serial output with the host-side decoders written against the documented
+// format and comparing the frames with the key states of the scans they were captured on.
+
+// The key states and the pressed states of the keys after a scan.
+struct Snapshot
+{
+    HEKeyStates states;
+    bool pressed[HE_KEYS];
+};
+
+// The snapshots of all scans, by the time of the scan, which is the timestamp of the telemetry frame captured on it.
+static std::map<uint32_t, Snapshot> snapshots;
+
+// Handles the specified serial command.
+static void handleCommand(const char *command)
+{
+    std::string line = command;
+    SerialHandler.handleSerialInput(line.data());
+}
+
+// Runs the specified amount of scans while pressing and releasing the keys, with the output being moved into the serial interface
+// like the main loop of the first core does. The snapshot of every scan is remembered for checking the frames captured on it.
+static void runScans(uint32_t scans)
+{
+    static uint32_t scan = 0;
+    for (uint32_t i = 0; i < scans; i++, scan++)
+    {
+        for (uint8_t key = 0; key < HE_KEYS; key++)
+            Simulator.setAnalogValue(HE_PIN(key), (scan / (50 + 20 * key)) % 2 ? 1150 : 2040);
+
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+
+        Snapshot &snapshot = snapshots[micros()];
+        snapshot.states = KeyHandler.heKeyStates;
+        for (uint8_t key = 0; key < HE_KEYS; key++)
+            snapshot.pressed[key] = KeyHandler.heKeys[key].pressed;
+
+        TelemetryHandler.flush();
+        SerialWriter.flush();
+    }
+}
+
+// Parses the serial output and decodes all telemetry frames in it.
+static std::vector<TelemetryDecoder::Frame> readFrames()
+{
+    const std::string output = Simulator.readSerialOutput();
+    FrameParser parser;
+    parser.feed((const uint8_t *)output.data(), output.size());
+    TEST_ASSERT_EQUAL(0, parser.invalidFrames);
+
+    std::vector<TelemetryDecoder::Frame> frames(parser.payloads.size());
+    for (size_t i = 0; i < frames.size(); i++)
+        TEST_ASSERT_TRUE(TelemetryDecoder::decode(parser.payloads[i], frames[i]));
+
+    return frames;
+}
+
+// Checks the specified frame against the key states of the scan it was captured on.
+static void assertFrame(const TelemetryDecoder::Frame &frame)
+{
+    TEST_ASSERT_TRUE(snapshots.count(frame.timestamp));
+    const Snapshot &snapshot = snapshots[frame.timestamp];
+    const HEKeyStates &states = snapshot.states;
+    TEST_ASSERT_EQUAL(HE_KEYS, frame.keys.size());
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT16(states.adcValues[i], frame.keys[i].adcValue);
+        TEST_ASSERT_EQUAL_UINT16(states.rawValues[i], frame.keys[i].rawValue);
+        TEST_ASSERT_EQUAL_UINT16(states.distances[i], frame.keys[i].distance);
+        TEST_ASSERT_EQUAL_UINT16(states.rapidTriggerPeaks[i], frame.keys[i].rapidTriggerPeak);
+        TEST_ASSERT_EQUAL(snapshot.pressed[i], frame.keys[i].pressed);
+        TEST_ASSERT_EQUAL(states.inRapidTriggerZone[i], frame.keys[i].inRapidTriggerZone);
+    }
+}
+
+void setUp()
+{
+    snapshots.clear();
+    Simulator.readSerialOutput();
+}
+
+void tearDown()
+{
+}
+
+void test_frames_match_key_states()
+{
+    // Stream every 4th scan while the keys are moving.
+    handleCommand("stream 4");
+    runScans(4000);
+    handleCommand("stream 0");
+    runScans(100);
+
+    const std::vector<TelemetryDecoder::Frame> frames = readFrames();
+    TEST_ASSERT_EQUAL(1000, frames.size());
+    TEST_ASSERT_EQUAL_UINT32(0, TelemetryHandler.framesDropped);
+
+    // The frames are consecutive, captured on every 4th scan, and contain the states of the scans they were captured on,
+    // with the keys being pressed and released.
+    const uint32_t scanPeriod = 1000000 / ConfigController.config.scanRate;
+    uint32_t presses = 0;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(frames[0].sequence + i, frames[i].sequence);
+        TEST_ASSERT_EQUAL_UINT32(frames[0].timestamp + i * 4 * scanPeriod, frames[i].timestamp);
+        assertFrame(frames[i]);
+        presses += frames[i].keys[0].pressed;
+    }
+
+    TEST_ASSERT_GREATER_THAN(0, presses);
+    TEST_ASSERT_LESS_THAN(frames.size(), presses);
+}
+
+void test_slow_host_drops_frames()
+{
+    // Stream every scan to a host device reading slower than the frames are captured, which drops the frames not fitting into the queue.
+    Simulator.serialWriteCapacity = 8;
+    const uint32_t dropped = TelemetryHandler.framesDropped;
+    handleCommand("stream 1");
+    runScans(2000);
+    handleCommand("stream 0");
+    Simulator.serialWriteCapacity = 4096;
+    runScans(200);
+
+    // The dropped frames show up as gaps in the sequence numbers, while the frames sent are still intact.
+    const std::vector<TelemetryDecoder::Frame> frames = readFrames();
+    TEST_ASSERT_GREATER_THAN(0, frames.size());
+    uint32_t gaps = 0;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        if (i > 0)
+            gaps += frames[i].sequence - frames[i - 1].sequence - 1;
+        assertFrame(frames[i]);
+    }
+
+    // Every scan has been captured, with the frames not sent being counted as dropped.
+    TEST_ASSERT_GREATER_THAN(0, gaps);
+    TEST_ASSERT_EQUAL_UINT32(2000, frames.size() + TelemetryHandler.framesDropped - dropped);
+}
+
+int main()
+{
+    // Boot the firmware with the HID output of all Hall Effect keys enabled.
+    ConfigController.loadConfig();
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        ConfigController.config.heKeys[i].hidEnabled = true;
+
+    ADCSampler.begin();
+    ScanTimer.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_match_key_states);
+    RUN_TEST(test_slow_host_drops_frames);
+    return UNITY_END();
+}
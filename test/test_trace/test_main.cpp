@@ -0,0 +1,119 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "handlers/trace_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/serial_writer.hpp"
+#include "frame_parser.hpp"
+#include "trace_decoder.hpp"
+#include "definitions.hpp"
+
+// Tests recording a trace of the sensor values and dumping it, decoding the dump with the host-side decoders written against the
+// documented format. The trace is recorded for longer than the buffer holds, so the oldest blocks have been overwritten.
+#ifndef USE_TRACE
+#error "The test requires the trace to be enabled."
+#endif
+
+// The sensor values set before every scan, in the order of the scans.
+static std::vector<std::vector<uint16_t>> scannedValues;
+
+// Returns the sensor value of the specified key in the specified scan, changing by varying amounts between the scans.
+static uint16_t getValue(uint8_t key, uint32_t scan)
+{
+    return 1500 + (scan * (7 + key * 3)) % 400 + (scan % 97 == 0 ? 600 : 0);
+}
+
+// Handles the specified serial command.
+static void handleCommand(const char *command)
+{
+    std::string line = command;
+    SerialHandler.handleSerialInput(line.data());
+}
+
+// Runs the specified amount of scans, like the main loop of the first core does. The sensor values are set right after every scan,
+// which guarantees that the frame read by the next scan has been sampled completely after that, as it takes less than a scan period.
+static void runScans(uint32_t scans, bool record)
+{
+    for (uint32_t i = 0; i < scans; i++)
+    {
+        if (record)
+        {
+            std::vector<uint16_t> values(HE_KEYS);
+            for (uint8_t key = 0; key < HE_KEYS; key++)
+                values[key] = getValue(key, scannedValues.size());
+
+            for (uint8_t key = 0; key < HE_KEYS; key++)
+                Simulator.setAnalogValue(HE_PIN(key), values[key]);
+            scannedValues.push_back(values);
+        }
+
+        Simulator.advance(1000000 / ConfigController.config.scanRate);
+        KeyHandler.handle();
+        TraceHandler.flush();
+        SerialWriter.flush();
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_dump_decodes_to_recorded_values()
+{
+    // Record a trace exceeding the buffer, then dump it.
+    handleCommand("trace start");
+    runScans(TRACE_BUFFER_SIZE / HE_KEYS, true);
+    handleCommand("trace dump");
+    runScans(100, false);
+
+    // Parse the dump and decode the blocks.
+    const std::string output = Simulator.readSerialOutput();
+    FrameParser parser;
+    parser.feed((const uint8_t *)output.data(), output.size());
+    TEST_ASSERT_EQUAL(0, parser.invalidFrames);
+    TEST_ASSERT_EQUAL(TRACE_BUFFER_SIZE / TRACE_BLOCK_SIZE, parser.payloads.size());
+
+    TraceDecoder decoder;
+    for (const std::vector<uint8_t> &payload : parser.payloads)
+        TEST_ASSERT_TRUE(decoder.addBlock(payload));
+
+    std::vector<TraceDecoder::Frame> frames;
+    TEST_ASSERT_TRUE(decoder.decode(frames));
+    TEST_ASSERT_EQUAL(HE_KEYS, decoder.keyCount);
+
+    // The trace holds the most recent scans without gaps. The oldest ones have been overwritten, but the trace still covers
+    // most of the buffer.
+    TEST_ASSERT_GREATER_THAN(scannedValues.size() / 4, frames.size());
+    TEST_ASSERT_LESS_THAN(scannedValues.size(), frames.size());
+    const size_t first = scannedValues.size() - frames.size();
+    for (size_t i = 0; i < frames.size(); i++)
+        for (uint8_t key = 0; key < HE_KEYS; key++)
+            TEST_ASSERT_EQUAL_UINT16(scannedValues[first + i][key], frames[i].values[key]);
+
+    // The frames are timestamped with the time the sampler completed them, which is less than a scan period apart from the scan.
+    const uint32_t period = 1000000 / ConfigController.config.scanRate;
+    for (size_t i = 1; i < frames.size(); i++)
+        TEST_ASSERT_UINT32_WITHIN(period / 2, period, frames[i].timestamp - frames[i - 1].timestamp);
+}
+
+int main()
+{
+    // Boot the firmware and let the sampler complete its first frames.
+    ConfigController.loadConfig();
+    ADCSampler.begin();
+    ScanTimer.begin();
+    runScans(10, false);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_dump_decodes_to_recorded_values);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Keyboard.h>
+#include "config/configuration_controller.hpp"
+#include "handlers/key_handler.hpp"
+#include "handlers/serial_handler.hpp"
+#include "helpers/adc_sampler.hpp"
+#include "helpers/digital_sampler.hpp"
+#include "helpers/scan_timer.hpp"
+#include "helpers/serial_writer.hpp"
+#include "frame_parser.hpp"
+#include "trace_decoder.hpp"
+#include "definitions.hpp"
+
+// Replays a trace dumped by the firmware with "trace dump" through the key pipeline on the host, printing the resulting key presses
+// and releases and their latencies. The trace file is the raw serial output captured while dumping, from which the trace blocks are
+// extracted. The sensor values of the trace are fed into the simulated ADC at the time they were recorded at, while the firmware scans
+// the keys at the configured scan rate, so the same trace always results in the same events and can be compared across firmware revisions.
+//
+// Usage: program <trace file> [serial commands...]
+// The serial commands are applied before replaying, e.g. "hkey1.rt 1" to replay the trace with rapid trigger enabled. The HID output of
+// all Hall Effect keys is enabled by default. The keys start uncalibrated like after flashing, being calibrated by the presses in the trace.
+
+// Runs the firmware until the specified simulated time, like the main loop of the first core does.
+static void runUntil(uint64_t time)
+{
+    while (Simulator.getTime() < time)
+    {
+        Simulator.advance(1);
+        KeyHandler.handle();
+        SerialWriter.flush();
+    }
+}
+
+// Returns the name of the key with the specified HID usage, or nullptr if no key has it.
+static const char *getKeyName(uint8_t usage)
+{
+    static char name[8];
+    for (const HEKey &key : KeyHandler.heKeys)
+        if (key.usage == usage)
+        {
+            snprintf(name, sizeof(name), "hkey%d", key.index + 1);
+            return name;
+        }
+
+    for (const DigitalKey &key : KeyHandler.digitalKeys)
+        if (key.usage == usage)
+        {
+            snprintf(name, sizeof(name), "dkey%d", key.index + 1);
+            return name;
+        }
+
+    return nullptr;
+}
+
+// Collects the pressed usages of the specified keyboard report into the bitmap, with the modifiers being the usages 0xE0 to 0xE7.
+static void getUsages(const Simulator::KeyboardReport &report, bool (&usages)[256])
+{
+    memset(usages, 0, sizeof(usages));
+    for (uint8_t key : report.keys)
+        if (key >= 4)
+            usages[key] = true;
+
+    for (uint8_t bit = 0; bit < 8; bit++)
+        if (report.modifiers & (1 << bit))
+            usages[0xE0 + bit] = true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace file> [serial commands...]\n", argv[0]);
+        return 1;
+    }
+
+    // Read the captured serial output and extract the trace blocks from it.
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file)
+    {
+        fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    FrameParser parser;
+    parser.feed(data.data(), data.size());
+
+    TraceDecoder decoder;
+    for (const std::vector<uint8_t> &payload : parser.payloads)
+        decoder.addBlock(payload);
+
+    std::vector<TraceDecoder::Frame> frames;
+    if (!decoder.decode(frames) || frames.empty())
+    {
+        fprintf(stderr, "The file does not contain a complete trace (%u invalid frames)\n", parser.invalidFrames);
+        return 1;
+    }
+
+    if (decoder.keyCount != HE_KEYS)
+    {
+        fprintf(stderr, "The trace contains %d Hall Effect keys, but the replay is built for %d\n", decoder.keyCount, HE_KEYS);
+        return 1;
+    }
+
+    // Boot the firmware like the setup of both cores does, with the sensors reading the first values of the trace.
+    EEPROM.begin(1024);
+    ConfigController.loadConfig();
+    Keyboard.begin();
+    Keyboard.setAutoReport(false);
+    for (uint8_t i = 0; i < HE_KEYS; i++)
+        Simulator.setAnalogValue(HE_PIN(i), frames[0].values[i]);
+    ADCSampler.begin();
+    DigitalSampler.begin();
+    ScanTimer.begin();
+
+    // Enable the HID output of all Hall Effect keys and apply the specified serial commands, printing their output.
+    for (HEKeyConfig &config : ConfigController.config.heKeys)
+        config.hidEnabled = true;
+    KeyHandler.requestConfigSync();
+
+    for (int i = 2; i < argc; i++)
+    {
+        char line[SERIAL_INPUT_BUFFER_SIZE];
+        snprintf(line, sizeof(line), "%s", argv[i]);
+        SerialHandler.handleSerialInput(line);
+    }
+
+    SerialWriter.flush();
+    fputs(Simulator.readSerialOutput().c_str(), stdout);
+
+    // Feed the values of every frame into the simulated ADC at the time they were recorded at, relative to the start of the replay,
+    // and run the firmware in between. The events are printed with the time of the trace they were reported at.
+    const uint64_t start = Simulator.getTime();
+    const uint32_t traceStart = frames[0].timestamp;
+    size_t reports = 0;
+    bool previousUsages[256] = {};
+    const auto printEvents = [&]()
+    {
+        for (; reports < Simulator.keyboardReports.size(); reports++)
+        {
+            const Simulator::KeyboardReport &report = Simulator.keyboardReports[reports];
+            bool usages[256];
+            getUsages(report, usages);
+            for (uint16_t usage = 0; usage < 256; usage++)
+            {
+                const char *name = getKeyName(usage);
+                if (usages[usage] != previousUsages[usage] && name)
+                    printf("EVENT %lu %s %s\n", (unsigned long)(traceStart + (report.time - start)), name, usages[usage] ? "press" : "release");
+            }
+
+            memcpy(previousUsages, usages, sizeof(usages));
+        }
+    };
+
+    for (const TraceDecoder::Frame &frame : frames)
+    {
+        runUntil(start + (uint32_t)(frame.timestamp - traceStart));
+        printEvents();
+        for (uint8_t i = 0; i < HE_KEYS; i++)
+            Simulator.setAnalogValue(HE_PIN(i), frame.values[i]);
+    }
+
+    // Run the firmware a bit longer, so the transitions caused by the last frames are reported as well.
+    runUntil(Simulator.getTime() + 100000);
+    printEvents();
+
+    // Print the latencies from sampling the values to sending the reports, measured by the firmware.
+    char command[] = "latency";
+    SerialHandler.handleSerialInput(command);
+    SerialWriter.flush();
+    fputs(Simulator.readSerialOutput().c_str(), stdout);
+    printf("FRAMES %lu DURATION %lu\n", (unsigned long)frames.size(), (unsigned long)(frames.back().timestamp - traceStart));
+    return 0;
+}